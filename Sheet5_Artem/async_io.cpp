@@ -0,0 +1,267 @@
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#if __has_include(<linux/io_uring.h>)
+#   include <linux/io_uring.h>
+#   define TASK_3_HAS_IO_URING 1
+#else
+#   define TASK_3_HAS_IO_URING 0
+#endif
+
+#include "header/async_io.h"
+
+#if TASK_3_HAS_IO_URING
+// Reads and writes arrived in a later kernel than io_uring itself (5.6), older kernels fail them with -EINVAL.
+// Kernels without IORING_REGISTER_PROBE are older than that as well.
+static bool supports_read_write(int ring_fd)
+{
+    unsigned const n_ops = 256;
+    std::vector<char> memory(sizeof(io_uring_probe) + n_ops * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, n_ops) < 0)
+        return false;
+
+    for (unsigned op : {IORING_OP_READ, IORING_OP_WRITE})
+    {
+        if (op > probe->last_op || op >= probe->ops_len || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+            return false;
+    }
+
+    return true;
+}
+#endif
+
+AsyncIo::AsyncIo(unsigned queue_depth)
+    : ring_fd(-1), sq_ring(MAP_FAILED), cq_ring(MAP_FAILED), sqes(MAP_FAILED), sq_ring_size(0), cq_ring_size(0),
+    sqes_size(0), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr), sq_array(nullptr), cq_head(nullptr),
+    cq_tail(nullptr), cq_mask(nullptr), cqes(nullptr), sq_entries(0), queued(0), in_flight(0)
+{
+#if TASK_3_HAS_IO_URING
+    if (queue_depth == 0)
+        return;
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // fails if the kernel is too old or io_uring is disabled, requests are executed synchronously then
+    int fd = (int) syscall(__NR_io_uring_setup, queue_depth, &params);
+
+    if (fd < 0)
+        return;
+
+    if (!supports_read_write(fd))
+    {
+        close(fd);
+        return;
+    }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+    // newer kernels map both rings at once
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    if (single_mmap)
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    sqes = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        if (sqes != MAP_FAILED)
+            munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && !single_mmap)
+            munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED)
+            munmap(sq_ring, sq_ring_size);
+
+        sq_ring = cq_ring = sqes = MAP_FAILED;
+        close(fd);
+        return;
+    }
+
+    char* sq = static_cast<char*>(sq_ring);
+    char* cq = static_cast<char*>(cq_ring);
+
+    sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+
+    sq_entries = params.sq_entries;
+    ring_fd = fd;
+#endif
+}
+
+AsyncIo::~AsyncIo()
+{
+    if (!is_available())
+        return;
+
+    // buffers of running requests must stay valid, so finish them first
+    collect(completions.size() + in_flight);
+
+    munmap(sqes, sqes_size);
+
+    if (cq_ring != sq_ring)
+        munmap(cq_ring, cq_ring_size);
+
+    munmap(sq_ring, sq_ring_size);
+    close(ring_fd);
+}
+
+bool AsyncIo::is_available()
+{
+    return ring_fd >= 0;
+}
+
+bool AsyncIo::queue_read(int fd, void* buffer, unsigned length, uint64_t offset, uint64_t tag)
+{
+    return queue(false, fd, buffer, length, offset, tag);
+}
+
+bool AsyncIo::queue_write(int fd, void const* buffer, unsigned length, uint64_t offset, uint64_t tag)
+{
+    return queue(true, fd, buffer, length, offset, tag);
+}
+
+bool AsyncIo::submit()
+{
+#if TASK_3_HAS_IO_URING
+    while (is_available() && queued > 0)
+    {
+        int n_submitted = (int) syscall(__NR_io_uring_enter, ring_fd, queued, 0, 0, nullptr, 0);
+
+        if (n_submitted < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            // the completion queue is full, make room before submitting again
+            if ((errno == EAGAIN || errno == EBUSY) && in_flight > queued)
+            {
+                collect(completions.size() + 1);
+                continue;
+            }
+
+            return false;
+        }
+
+        queued -= n_submitted;
+    }
+#endif
+
+    return true;
+}
+
+std::vector<AsyncIo::Completion> AsyncIo::wait(unsigned min_completions)
+{
+    collect(min_completions);
+
+    std::vector<Completion> finished(completions.begin(), completions.end());
+    completions.clear();
+    return finished;
+}
+
+unsigned AsyncIo::get_in_flight()
+{
+    return in_flight;
+}
+
+void AsyncIo::collect(unsigned min_completions)
+{
+#if TASK_3_HAS_IO_URING
+    if (is_available())
+    {
+        submit();
+        reap();
+
+        while (completions.size() < min_completions && in_flight > queued)
+        {
+            unsigned n_missing = std::min<unsigned>(min_completions - completions.size(), in_flight - queued);
+            int result = (int) syscall(__NR_io_uring_enter, ring_fd, 0, n_missing, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+            if (result < 0 && errno != EINTR)
+                break;
+
+            reap();
+        }
+    }
+#endif
+}
+
+bool AsyncIo::queue(bool write, int fd, void const* buffer, unsigned length, uint64_t offset, uint64_t tag)
+{
+    // execute synchronously without io_uring
+    if (!is_available())
+    {
+        ssize_t result = write ? pwrite(fd, buffer, length, (off_t) offset) : pread(fd, const_cast<void*>(buffer), length, (off_t) offset);
+        completions.push_back({tag, result < 0 ? -errno : (int) result});
+        return true;
+    }
+
+#if TASK_3_HAS_IO_URING
+    // make room in the submission queue
+    if (queued == sq_entries && !submit())
+        return false;
+
+    // limit running requests to the ring size, so that completions cannot overflow
+    if (in_flight >= sq_entries)
+        collect(completions.size() + in_flight - sq_entries + 1);
+
+    // only this thread produces entries, the kernel consumes them
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes) + index;
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = tag;
+
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    queued++;
+    in_flight++;
+#endif
+
+    return true;
+}
+
+void AsyncIo::reap()
+{
+#if TASK_3_HAS_IO_URING
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail)
+    {
+        io_uring_cqe* cqe = static_cast<io_uring_cqe*>(cqes) + (head & *cq_mask);
+        completions.push_back({cqe->user_data, cqe->res});
+        in_flight--;
+        head++;
+    }
+
+    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+#endif
+}
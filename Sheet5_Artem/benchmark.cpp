@@ -0,0 +1,932 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <thread>
+
+#include "header/filesystem.h"
+#include "header/identifiers.h"
+#include "header/record.h"
+#include "header/record_hash.h"
+#include "header/schema.h"
+#include "header/storage_manager.h"
+#include "header/log_manager.h"
+#include "header/block.h"
+#include "header/pax_block.h"
+#include "header/replacement_policy.h"
+#include "header/buffer_manager.h"
+#include "header/bptree.h"
+#include "header/execution.h"
+
+// Memory of the buffer pool, the number of frames depends on the page size
+static int const BUFFER_BYTES = 4 * 1024 * 1024;
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmark_page_sizes()
+{
+    std::cout << "[i] Benchmarking page sizes." << std::endl;
+
+    int n_records = 100000;
+    int n_keys = 5000;
+
+    for (int page_size : {4096, 16384, 65536})
+    {
+        std::string directory = Block::BLOCK_DIR + "benchmark_" + std::to_string(page_size) + "/";
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, page_size);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(BUFFER_BYTES / page_size, storage));
+
+        // load table
+        auto start = std::chrono::steady_clock::now();
+        std::vector<PageId> block_ids;
+        std::shared_ptr<Block> block = nullptr;
+
+        for (int i = 0; i < n_records; i++)
+        {
+            std::vector<Record::Attribute> attributes = {(int) i, (std::string) "Benchmark", (bool) (i % 2 == 0)};
+
+            if (block == nullptr || block->add_record(attributes) == nullptr)
+            {
+                if (block != nullptr)
+                    buffer->unfix_block(block->get_block_id());
+
+                block = buffer->fix_block(buffer->create_new_block());
+                block_ids.push_back(block->get_block_id());
+                block->add_record(attributes);
+            }
+        }
+
+        buffer->unfix_block(block->get_block_id());
+        double load_ms = elapsed_ms(start);
+
+        // scan table
+        start = std::chrono::steady_clock::now();
+        Table table(buffer, block_ids);
+        int n_scanned = 0;
+
+        table.open();
+
+        while (table.next() != nullptr)
+            n_scanned++;
+
+        table.close();
+        double scan_ms = elapsed_ms(start);
+
+        // build index on shuffled keys
+        std::vector<int> keys;
+
+        for (int i = 0; i < n_keys; i++)
+            keys.push_back(i);
+
+        std::mt19937 gen(1379);
+        std::shuffle(keys.begin(), keys.end(), gen);
+
+        BPTree bptree(buffer, buffer->create_new_block());
+
+        for (int key : keys)
+            bptree.insert_record(key, Block::create_record_id(INVALID_PAGE_ID, key));
+
+        // point lookups
+        std::shuffle(keys.begin(), keys.end(), gen);
+        start = std::chrono::steady_clock::now();
+        int n_found = 0;
+
+        for (int key : keys)
+            n_found += bptree.search_record(key).has_value();
+
+        double lookup_ms = elapsed_ms(start);
+
+        std::cout << "    page size " << page_size
+                  << ": " << block_ids.size() << " blocks"
+                  << ", fanout " << BPTreeNode::get_max_values(page_size)
+                  << ", load " << load_ms << " ms"
+                  << ", scan " << n_scanned << " records in " << scan_ms << " ms"
+                  << ", " << n_found << " lookups in " << lookup_ms << " ms" << std::endl;
+    }
+}
+
+static void benchmark_mapped_scan()
+{
+    std::cout << "[i] Benchmarking buffered and mapped scans." << std::endl;
+
+    int n_records = 100000;
+    std::string directory = Block::BLOCK_DIR + "benchmark_mapped/";
+    std::vector<PageId> block_ids;
+
+    // load table
+    {
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(BUFFER_BYTES / Block::BLOCK_SIZE, storage));
+        std::shared_ptr<Block> block = nullptr;
+
+        for (int i = 0; i < n_records; i++)
+        {
+            std::vector<Record::Attribute> attributes = {(int) i, (std::string) "Benchmark", (bool) (i % 2 == 0)};
+
+            if (block == nullptr || block->add_record(attributes) == nullptr)
+            {
+                if (block != nullptr)
+                    buffer->unfix_block(block->get_block_id());
+
+                block = buffer->fix_block(buffer->create_new_block());
+                block_ids.push_back(block->get_block_id());
+                block->add_record(attributes);
+            }
+        }
+
+        buffer->unfix_block(block->get_block_id());
+        buffer->flush();
+    }
+
+    for (StorageManager::Mode mode : {StorageManager::Mode::BUFFERED, StorageManager::Mode::MAPPED})
+    {
+        // open and scan the table
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, mode);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(BUFFER_BYTES / Block::BLOCK_SIZE, storage));
+
+        Table table(buffer, block_ids);
+        int n_scanned = 0;
+
+        table.open();
+
+        while (table.next() != nullptr)
+            n_scanned++;
+
+        table.close();
+
+        std::cout << "    " << (mode == StorageManager::Mode::MAPPED ? "mapped" : "buffered")
+                  << ": " << n_scanned << " records in " << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_pax_scan()
+{
+    std::cout << "[i] Benchmarking selections on slotted and PAX blocks." << std::endl;
+
+    int n_records = 100000;
+    std::vector<std::string> attribute_types = {"int", "string", "bool"};
+
+    // keep both tables in memory, so that only the page layout is compared
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR + "benchmark_pax/", Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(4000, storage));
+
+    for (bool pax : {false, true})
+    {
+        std::vector<PageId> block_ids;
+        std::shared_ptr<Block> block = nullptr;
+        std::shared_ptr<PaxBlock> pax_block = nullptr;
+
+        for (int i = 0; i < n_records; i++)
+        {
+            std::vector<Record::Attribute> attributes = {(int) i, (std::string) "Benchmark record", (bool) (i % 2 == 0)};
+            bool added = block != nullptr && (pax ? pax_block->add_record(attributes) != INVALID_RECORD_ID : block->add_record(attributes) != nullptr);
+
+            if (!added)
+            {
+                if (block != nullptr)
+                    buffer->unfix_block(block->get_block_id());
+
+                block = buffer->fix_block(buffer->create_new_block());
+                block_ids.push_back(block->get_block_id());
+
+                if (pax)
+                {
+                    pax_block = PaxBlock::create(block, attribute_types);
+                    pax_block->add_record(attributes);
+                } else
+                    block->add_record(attributes);
+            }
+        }
+
+        buffer->unfix_block(block->get_block_id());
+
+        // select one percent of the records on a single column
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<Table> table = std::make_shared<Table>(Table(buffer, block_ids));
+        Selection selection(buffer, table, 1, "int", (int) (n_records / 100), "<");
+        int n_selected = 0;
+
+        selection.open();
+
+        while (selection.next() != nullptr)
+            n_selected++;
+
+        selection.close();
+
+        std::cout << "    " << (pax ? "PAX" : "slotted") << ": " << block_ids.size() << " blocks, "
+                  << n_selected << " records selected in " << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_commit()
+{
+    std::cout << "[i] Benchmarking commits with flushed pages and with the write-ahead log." << std::endl;
+
+    int n_commits = 1000;
+    int n_changes = 10;
+
+    for (bool logged : {false, true})
+    {
+        std::string directory = Block::BLOCK_DIR + (logged ? "benchmark_logged/" : "benchmark_flushed/");
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<LogManager> log = logged ? std::make_shared<LogManager>(directory) : nullptr;
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BUFFER_BYTES / Block::BLOCK_SIZE, storage, log);
+
+        // every commit changes records spread over a few blocks
+        std::vector<PageId> block_ids;
+
+        for (int i = 0; i < n_changes; i++)
+            block_ids.push_back(buffer->create_new_block());
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < n_commits; i++)
+        {
+            for (int j = 0; j < n_changes; j++)
+            {
+                std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(j));
+                std::shared_ptr<Record> record = block->add_record({(int) i, (std::string) "Benchmark"});
+                block->delete_record(record->get_record_id());
+                buffer->unfix_block(block_ids.at(j));
+            }
+
+            buffer->commit();
+        }
+
+        std::cout << "    " << (logged ? "logged" : "flushed") << ": " << n_commits << " commits in "
+                  << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_recovery()
+{
+    std::cout << "[i] Benchmarking recovery with different checkpoint intervals." << std::endl;
+
+    int n_records = 50000;
+    int n_cached_blocks = 16;
+
+    for (int checkpoint_interval : {0, 20000, 5000, 1000})
+    {
+        std::string directory = Block::BLOCK_DIR + "benchmark_recovery_" + std::to_string(checkpoint_interval) + "/";
+
+        // load a table, commit often and crash without writing the cached blocks
+        {
+            std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+            std::shared_ptr<LogManager> log = std::make_shared<LogManager>(directory);
+            std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_cached_blocks, storage, log);
+            std::shared_ptr<Block> block = nullptr;
+
+            for (int i = 0; i < n_records; i++)
+            {
+                std::vector<Record::Attribute> attributes = {(int) i, (std::string) "Benchmark"};
+
+                if (block == nullptr || block->add_record(attributes) == nullptr)
+                {
+                    if (block != nullptr)
+                        buffer->unfix_block(block->get_block_id());
+
+                    block = buffer->fix_block(buffer->create_new_block());
+                    block->add_record(attributes);
+                }
+
+                if (i % 100 == 99)
+                    buffer->commit();
+
+                if (checkpoint_interval > 0 && i % checkpoint_interval == checkpoint_interval - 1)
+                    buffer->checkpoint();
+            }
+
+            buffer->unfix_block(block->get_block_id());
+            buffer->commit();
+        }
+
+        // restart
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory);
+        std::shared_ptr<LogManager> log = std::make_shared<LogManager>(directory);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_cached_blocks, storage, log);
+
+        std::cout << "    checkpoint interval " << (checkpoint_interval > 0 ? std::to_string(checkpoint_interval) : "none")
+                  << ": " << buffer->get_recovered_records() << " log records recovered in " << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_bulk_insert()
+{
+    std::cout << "[i] Benchmarking record-at-a-time and bulk inserts." << std::endl;
+
+    int n_records = 200000;
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int i = 0; i < n_records; i++)
+        tuples.push_back({(int) i, (std::string) "Benchmark", (bool) (i % 2 == 0)});
+
+    for (bool bulk : {false, true})
+    {
+        std::string directory = Block::BLOCK_DIR + (bulk ? "benchmark_bulk/" : "benchmark_single/");
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BUFFER_BYTES / Block::BLOCK_SIZE, storage);
+        std::vector<PageId> block_ids;
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (bulk)
+        {
+            TableAppender appender(buffer);
+            appender.append(tuples);
+            appender.close();
+            block_ids = appender.get_block_ids();
+        } else
+        {
+            // fix the last block for every tuple
+            block_ids.push_back(buffer->create_new_block());
+
+            for (std::vector<Record::Attribute> const& tuple : tuples)
+            {
+                std::shared_ptr<Block> block = buffer->fix_block(block_ids.back());
+
+                if (block->add_record(tuple) == nullptr)
+                {
+                    buffer->unfix_block(block_ids.back());
+                    block_ids.push_back(buffer->create_new_block());
+                    block = buffer->fix_block(block_ids.back());
+                    block->add_record(tuple);
+                }
+
+                buffer->unfix_block(block_ids.back());
+            }
+        }
+
+        std::cout << "    " << (bulk ? "bulk" : "single") << ": " << n_records << " records into " << block_ids.size()
+                  << " blocks in " << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_schema()
+{
+    std::cout << "[i] Benchmarking scans of records and of tuples encoded with a schema." << std::endl;
+
+    int n_records = 100000;
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int i = 0; i < n_records; i++)
+        tuples.push_back({(int) i, (bool) (i % 2 == 0)});
+
+    for (bool encoded : {false, true})
+    {
+        std::string directory = Block::BLOCK_DIR + (encoded ? "benchmark_tuples/" : "benchmark_records/");
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BUFFER_BYTES / Block::BLOCK_SIZE, storage);
+        std::shared_ptr<Schema> schema = encoded ? std::make_shared<Schema>(std::vector<std::string>{"int", "bool"}) : nullptr;
+
+        TableAppender appender(buffer, schema);
+        appender.append(tuples);
+        appender.close();
+
+        // select every 100th tuple
+        auto start = std::chrono::steady_clock::now();
+        Table table(buffer, appender.get_block_ids(), schema);
+        table.push_filter(1, "int", (int) (n_records - n_records / 100), ">=");
+        int n_selected = 0;
+
+        table.open();
+
+        while (table.next() != nullptr)
+            n_selected++;
+
+        table.close();
+
+        std::cout << "    " << (encoded ? "tuples" : "records") << ": " << appender.get_block_ids().size() << " blocks, "
+                  << n_selected << " selected in " << elapsed_ms(start) << " ms" << std::endl;
+    }
+}
+
+static void benchmark_hash()
+{
+    std::cout << "[i] Benchmarking record hashes with a copied string and in place." << std::endl;
+
+    int n_records = 200000;
+    std::vector<std::shared_ptr<Record>> records;
+
+    for (int i = 0; i < n_records; i++)
+        records.push_back(std::make_shared<Record>(Record(i, {(int) i, (std::string) "Customer " + std::to_string(i % 1000), (bool) (i % 2 == 0)})));
+
+    // the old hash copied the attributes into a string
+    auto start = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+
+    for (std::shared_ptr<Record> const& record : records)
+    {
+        char const* data = static_cast<char const*>(record->get_data().get());
+        int start_position = record->get_view().get_attribute_bytes(1).data() - data;
+        checksum += std::hash<std::string>{}(std::string(data + start_position, data + record->get_size()));
+    }
+
+    std::cout << "    copied string: " << elapsed_ms(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+
+    for (std::shared_ptr<Record> const& record : records)
+        checksum += RecordHash::hash_record(record->get_view());
+
+    std::cout << "    in place: " << elapsed_ms(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> hashes;
+
+    // hash the string column in batches, like a hash join would
+    for (int i = 0; i < n_records; i += 1000)
+    {
+        std::vector<std::shared_ptr<Record>> batch(records.begin() + i, records.begin() + std::min(i + 1000, n_records));
+        RecordHash::hash_batch(batch, {2}, hashes);
+        checksum += hashes.back();
+    }
+
+    std::cout << "    batches of one column: " << elapsed_ms(start) << " ms (checksum " << checksum % 1000 << ")" << std::endl;
+}
+
+static void benchmark_buffer_pool()
+{
+    std::cout << "[i] Benchmarking fix and unfix with growing buffer pools." << std::endl;
+
+    int n_operations = 1000000;
+
+    for (int n_frames : {1024, 8192, 32768})
+    {
+        std::string directory = Block::BLOCK_DIR + "benchmark_pool_" + std::to_string(n_frames) + "/";
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+
+        // fill the pool with empty blocks, which are never written
+        std::vector<PageId> block_ids;
+
+        for (int i = 0; i < n_frames; i++)
+        {
+            block_ids.push_back(buffer->create_new_block());
+            buffer->fix_block(block_ids.back());
+            buffer->unfix_block(block_ids.back());
+        }
+
+        // hits: every unfix appends the block to the unfixed blocks
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> distribution(0, n_frames - 1);
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < n_operations; i++)
+        {
+            PageId block_id = block_ids.at(distribution(random));
+            buffer->fix_block(block_id);
+            buffer->unfix_block(block_id);
+        }
+
+        double hit_ms = elapsed_ms(start);
+
+        // misses: every fix evicts the least recently unfixed block
+        start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < n_frames; i++)
+        {
+            PageId block_id = buffer->create_new_block();
+            buffer->fix_block(block_id);
+            buffer->unfix_block(block_id);
+        }
+
+        std::cout << "    " << n_frames << " frames: " << hit_ms * 1e6 / n_operations << " ns per fix and unfix, "
+                  << elapsed_ms(start) * 1e6 / n_frames << " ns per evicting fix" << std::endl;
+    }
+}
+
+static void benchmark_read_ahead()
+{
+    std::cout << "[i] Benchmarking cold table scans with direct I/O, block by block and with read-ahead." << std::endl;
+
+    int n_frames = 256;
+    int n_records = 200000;
+
+    std::string directory = Block::BLOCK_DIR + "benchmark_read_ahead/";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE, StorageManager::Mode::DIRECT);
+    std::vector<PageId> block_ids;
+
+    {
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+        std::vector<std::vector<Record::Attribute>> tuples;
+
+        for (int i = 0; i < n_records; i++)
+            tuples.push_back({(int) i, (std::string) "Read-ahead", (bool) (i % 2 == 0)});
+
+        TableAppender appender(buffer);
+        appender.append(tuples);
+        appender.close();
+
+        block_ids = appender.get_block_ids();
+        buffer->flush();
+    }
+
+    // every block is read when it is fixed
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+    auto start = std::chrono::steady_clock::now();
+    int n_read = 0;
+
+    for (PageId block_id : block_ids)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(block_id);
+
+        for (int slot = 0; slot < block->get_slot_count(); slot++)
+        {
+            std::optional<RecordView> view = block->get_record_view(Block::create_record_id(block_id, slot));
+
+            if (view.has_value() && view->materialize() != nullptr)
+                n_read++;
+        }
+
+        buffer->unfix_block(block_id);
+    }
+
+    double fix_ms = elapsed_ms(start);
+
+    // the table prefetches the next blocks of the scan
+    buffer = std::make_shared<BufferManager>(n_frames, storage);
+    Table table(buffer, block_ids);
+    start = std::chrono::steady_clock::now();
+
+    table.open();
+
+    while (table.next() != nullptr)
+        n_read++;
+
+    table.close();
+
+    std::cout << "    " << block_ids.size() << " blocks (" << n_read / 2 << " records): " << fix_ms
+              << " ms block by block, " << elapsed_ms(start) << " ms with read-ahead" << std::endl;
+}
+
+static void benchmark_scan_rings()
+{
+    std::cout << "[i] Benchmarking lookups of hot blocks between table scans with direct I/O, with and without a ring." << std::endl;
+
+    int n_frames = 512;
+    int n_records = 200000;
+    int n_hot_blocks = 256;
+    int n_rounds = 5;
+    int n_lookups = 20000;
+
+    std::string directory = Block::BLOCK_DIR + "benchmark_scan_rings/";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE, StorageManager::Mode::DIRECT);
+    std::vector<PageId> table_block_ids;
+    std::vector<PageId> hot_block_ids;
+
+    {
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+        std::vector<std::vector<Record::Attribute>> tuples;
+
+        for (int i = 0; i < n_records; i++)
+            tuples.push_back({(int) i, (std::string) "Scan ring", (bool) (i % 2 == 0)});
+
+        TableAppender appender(buffer);
+        appender.append(tuples);
+        appender.close();
+        table_block_ids = appender.get_block_ids();
+
+        for (int i = 0; i < n_hot_blocks; i++)
+        {
+            hot_block_ids.push_back(buffer->create_new_block());
+            buffer->fix_block(hot_block_ids.back())->add_record({(int) i, (std::string) "Hot", (bool) true});
+            buffer->unfix_block(hot_block_ids.back());
+        }
+
+        buffer->flush();
+    }
+
+    for (bool use_ring : {false, true})
+    {
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution(0, n_hot_blocks - 1);
+        double scan_ms = 0;
+        double lookup_ms = 0;
+        int n_cached = 0;
+
+        // the hot blocks are cached before the first scan
+        for (PageId block_id : hot_block_ids)
+        {
+            buffer->fix_block(block_id);
+            buffer->unfix_block(block_id);
+        }
+
+        for (int round = 0; round < n_rounds; round++)
+        {
+            std::shared_ptr<BufferManager::Ring> ring = use_ring ? buffer->create_ring() : nullptr;
+            auto start = std::chrono::steady_clock::now();
+
+            for (PageId block_id : table_block_ids)
+            {
+                buffer->fix_block(block_id, ring);
+                buffer->unfix_block(block_id);
+            }
+
+            scan_ms += elapsed_ms(start);
+
+            for (PageId block_id : hot_block_ids)
+                n_cached += buffer->is_cached(block_id);
+
+            start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < n_lookups; i++)
+            {
+                PageId block_id = hot_block_ids.at(distribution(generator));
+                buffer->fix_block(block_id);
+                buffer->unfix_block(block_id);
+            }
+
+            lookup_ms += elapsed_ms(start);
+        }
+
+        std::cout << "    " << (use_ring ? "ring:    " : "no ring: ") << scan_ms / n_rounds << " ms per scan of "
+                  << table_block_ids.size() << " blocks, " << lookup_ms / n_rounds << " ms per " << n_lookups
+                  << " hot lookups, " << n_cached / n_rounds << " of " << n_hot_blocks
+                  << " hot blocks cached after a scan" << std::endl;
+    }
+}
+
+static void benchmark_buffer_statistics()
+{
+    std::cout << "[i] Benchmarking the I/O share of cold and warm table scans with direct I/O, from the buffer statistics." << std::endl;
+
+    // the table takes less than a quarter of the frames, so that it stays cached
+    int n_frames = 8192;
+    int n_records = 100000;
+
+    std::string directory = Block::BLOCK_DIR + "benchmark_statistics/";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE, StorageManager::Mode::DIRECT);
+    std::vector<PageId> block_ids;
+
+    {
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+        std::vector<std::vector<Record::Attribute>> tuples;
+
+        for (int i = 0; i < n_records; i++)
+            tuples.push_back({(int) i, (std::string) "Statistics", (bool) (i % 2 == 0)});
+
+        TableAppender appender(buffer);
+        appender.append(tuples);
+        appender.close();
+
+        block_ids = appender.get_block_ids();
+        buffer->flush();
+    }
+
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+
+    for (std::string scan : {"cold", "warm"})
+    {
+        // the scan is attributed to its own statistics
+        BufferManager::Statistics statistics = BufferManager::Statistics();
+        Table table(buffer, block_ids);
+        auto start = std::chrono::steady_clock::now();
+
+        {
+            BufferManager::StatisticsScope scope(statistics);
+            table.open();
+
+            while (table.next() != nullptr);
+
+            table.close();
+        }
+
+        double scan_ms = elapsed_ms(start);
+        BufferManager::Statistics::Counters total = statistics.get_total();
+
+        std::cout << "    " << scan << ": " << scan_ms << " ms, " << total.hits << " hits, " << total.misses
+                  << " misses, " << statistics.get_average_read_us() << " us per read, "
+                  << statistics.read_time_ns / 1e4 / scan_ms << " % of the time reading" << std::endl;
+    }
+}
+
+static void benchmark_concurrent_fixes()
+{
+    std::cout << "[i] Benchmarking fix and unfix from parallel threads (" << std::thread::hardware_concurrency() << " cores)." << std::endl;
+
+    int n_frames = 8192;
+    int n_operations = 1000000;
+
+    std::string directory = Block::BLOCK_DIR + "benchmark_concurrent/";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage);
+
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < n_frames; i++)
+    {
+        block_ids.push_back(buffer->create_new_block());
+        buffer->fix_block(block_ids.back());
+        buffer->unfix_block(block_ids.back());
+    }
+
+    // unfixed blocks go through the replacement policy, blocks that stay fixed elsewhere (e.g. an index root) only count
+    for (bool pinned : {false, true})
+    {
+        if (pinned)
+        {
+            for (PageId block_id : block_ids)
+                buffer->fix_block(block_id);
+        }
+
+        std::cout << "    " << (pinned ? "fixed blocks:" : "unfixed blocks:");
+
+        for (int n_threads : {1, 2, 4, 8})
+        {
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < n_threads; i++)
+            {
+                threads.emplace_back([&buffer, &block_ids, n_operations, n_threads, i]() {
+                    std::mt19937 random(i);
+                    std::uniform_int_distribution<int> distribution(0, block_ids.size() - 1);
+
+                    for (int j = 0; j < n_operations / n_threads; j++)
+                    {
+                        PageId block_id = block_ids.at(distribution(random));
+                        buffer->fix_block(block_id);
+                        buffer->unfix_block(block_id);
+                    }
+                });
+            }
+
+            for (std::thread& thread : threads)
+                thread.join();
+
+            std::cout << " " << n_threads << " threads " << elapsed_ms(start) * 1e6 / n_operations << " ns";
+        }
+
+        std::cout << " per fix and unfix" << std::endl;
+    }
+
+    for (PageId block_id : block_ids)
+        buffer->unfix_block(block_id);
+}
+
+static void benchmark_replacement_policies()
+{
+    std::cout << "[i] Benchmarking replacement policies on a recorded trace of index lookups and table scans." << std::endl;
+
+    int n_records = 50000;
+    int n_keys = 200000;
+    int n_rounds = 5;
+    int n_lookups = 20000;
+
+    std::string directory = Block::BLOCK_DIR + "benchmark_policies/";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BUFFER_BYTES / Block::BLOCK_SIZE, storage);
+
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int i = 0; i < n_records; i++)
+        tuples.push_back({(int) i, (std::string) "Replacement", (bool) (i % 2 == 0)});
+
+    TableAppender appender(buffer);
+    appender.append(tuples);
+    appender.close();
+
+    std::vector<int> keys;
+
+    for (int i = 0; i < n_keys; i++)
+        keys.push_back(i);
+
+    std::mt19937 gen(1379);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    BPTree bptree(buffer, buffer->create_new_block());
+
+    for (int key : keys)
+        bptree.insert_record(key, Block::create_record_id(INVALID_PAGE_ID, key));
+
+    // record the workload: index lookups, then a full scan of the table
+    buffer->start_trace();
+    std::uniform_int_distribution<int> distribution(0, n_keys - 1);
+
+    for (int round = 0; round < n_rounds; round++)
+    {
+        for (int i = 0; i < n_lookups; i++)
+            bptree.search_record(distribution(gen));
+
+        Table table(buffer, appender.get_block_ids());
+        table.open();
+
+        while (table.next() != nullptr);
+
+        table.close();
+    }
+
+    std::vector<ReplacementPolicy::TraceEntry> trace = buffer->stop_trace();
+    std::cout << "    " << trace.size() << " trace entries, " << appender.get_block_ids().size() << " table blocks" << std::endl;
+
+    std::vector<ReplacementPolicy::Type> types = {ReplacementPolicy::Type::LRU, ReplacementPolicy::Type::CLOCK,
+        ReplacementPolicy::Type::TWO_QUEUE, ReplacementPolicy::Type::LRU_K, ReplacementPolicy::Type::ARC};
+
+    for (int n_frames : {64, 256, 1024})
+    {
+        std::cout << "    " << n_frames << " frames:";
+
+        for (ReplacementPolicy::Type type : types)
+        {
+            auto start = std::chrono::steady_clock::now();
+            ReplacementPolicy::SimulationResult result = ReplacementPolicy::simulate(type, n_frames, trace);
+            std::cout << " " << ReplacementPolicy::get_name(type) << " " << result.get_hit_ratio() * 100 << "% ("
+                      << result.misses << " misses, " << elapsed_ms(start) << " ms)";
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+static void benchmark_background_writer()
+{
+    std::cout << "[i] Benchmarking reads that evict dirty blocks, with and without the background writer." << std::endl;
+
+    int n_frames = 1024;
+
+    for (bool writer : {false, true})
+    {
+        std::string directory = Block::BLOCK_DIR + (writer ? "benchmark_writer/" : "benchmark_no_writer/");
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, Block::BLOCK_SIZE);
+        std::shared_ptr<LogManager> log = std::make_shared<LogManager>(directory);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(n_frames, storage, log);
+
+        // blocks that are read later, then a pool of blocks that were changed after the last commit
+        std::vector<PageId> read_block_ids;
+
+        for (int i = 0; i < n_frames; i++)
+        {
+            read_block_ids.push_back(buffer->create_new_block());
+            buffer->fix_block(read_block_ids.back())->add_record({(int) i, (std::string) "Read", (bool) true});
+            buffer->unfix_block(read_block_ids.back());
+        }
+
+        buffer->flush();
+
+        for (int i = 0; i < n_frames; i++)
+        {
+            PageId block_id = buffer->create_new_block();
+            buffer->fix_block(block_id)->add_record({(int) i, (std::string) "Dirty", (bool) false});
+            buffer->unfix_block(block_id);
+        }
+
+        if (writer)
+        {
+            buffer->start_writer(0.1, std::chrono::milliseconds(10));
+
+            while (buffer->get_written_block_count() < n_frames * 0.9)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // the read-only query evicts the changed blocks
+        auto start = std::chrono::steady_clock::now();
+
+        for (PageId block_id : read_block_ids)
+        {
+            buffer->fix_block(block_id);
+            buffer->unfix_block(block_id);
+        }
+
+        double read_ms = elapsed_ms(start);
+        buffer->stop_writer();
+
+        std::cout << "    " << (writer ? "writer: " : "no writer: ") << read_ms * 1e3 / n_frames << " us per read, "
+                  << buffer->get_written_block_count() << " blocks written in the background" << std::endl;
+    }
+}
+
+int main() {
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    benchmark_page_sizes();
+    benchmark_mapped_scan();
+    benchmark_pax_scan();
+    benchmark_read_ahead();
+    benchmark_bulk_insert();
+    benchmark_schema();
+    benchmark_hash();
+    benchmark_buffer_pool();
+    benchmark_concurrent_fixes();
+    benchmark_replacement_policies();
+    benchmark_scan_rings();
+    benchmark_buffer_statistics();
+    benchmark_commit();
+    benchmark_background_writer();
+    benchmark_recovery();
+
+    // delete existing block path
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    return 0;
+}
@@ -3,218 +3,504 @@
 #include <iostream>
 #include <cstring>
 #include <vector>
-#include <iomanip>
-#include <sstream>
-#include <fstream>
+#include <algorithm>
 
-#include "header/filesystem.h"
+#include "header/identifiers.h"
 #include "header/record.h"
+#include "header/storage_manager.h"
+#include "header/log_manager.h"
 #include "header/block.h"
 
 std::string const Block::BLOCK_DIR = "data/";
 
-Block::Block(std::string const& block_id) {
-    // enforce length constraint
-    if (block_id.size() != BLOCK_ID_SIZE) {
-        throw std::invalid_argument("block_id must be exactly 5 bytes long.");
-    }
+Block::Block(std::shared_ptr<StorageManager> const& storage, PageId block_id)
+    : Block(storage, block_id, load_data(storage, block_id)) {}
 
-    // try to read existing data
-    data = load_data(block_id);
+Block::Block(std::shared_ptr<StorageManager> const& storage, PageId block_id, std::shared_ptr<void> const& page)
+    : storage(storage), data(page)
+{
+    // derive the slot capacity from the page size
+    block_size = storage->get_page_size();
+    max_records = get_max_records(block_size);
+    dictionary_offset = BITMAP_OFFSET + max_records / 8;
     dirty = false;
+    recovery_lsn = 0;
+
+    // pages of read-only databases may point into mapped memory
+    read_only = storage->is_read_only();
 
     // reserve data for new block
     if (!data) {
         // Allocate memory block
-        char *buffer = new char[Block::BLOCK_SIZE];
-
-        // add block id as first entry
-        std::memcpy(buffer, block_id.c_str(), BLOCK_ID_SIZE);
-
-        // set block dictionary to invalid offsets
-        for (int i = 0; i < MAX_RECORDS; i++) {
-            int val = -1;
-            std::memcpy(buffer + BLOCK_ID_SIZE + i * sizeof(int), &val, sizeof(int));
-        }
-
-        data = std::shared_ptr<void>(buffer, [](void *ptr) { delete[] static_cast<char *>(ptr); });
-        dirty = true;
+        data = storage->allocate_page();
+        char *buffer = static_cast<char *>(data.get());
+
+        // initialize header, the dictionary is empty and the whole block is free
+        Header* header = get_header();
+        header->magic = BLOCK_MAGIC;
+        header->n_records = 0;
+        header->block_id = block_id;
+        header->lsn = 0;
+        header->n_slots = 0;
+        header->free_start = dictionary_offset;
+        header->free_end = block_size;
+        header->fragmented = 0;
+
+        // mark all slots as free
+        std::memset(buffer + BITMAP_OFFSET, 0, max_records / 8);
+        dirty = !read_only;
     }
 }
 
-std::string Block::get_block_id() {
-    char *ptr = static_cast<char *>(data.get());
-    return std::string(ptr, ptr + BLOCK_ID_SIZE);
+PageId Block::get_block_id() {
+    return get_header()->block_id;
 }
 
-std::shared_ptr<Record> Block::get_record(std::string const& record_id)
+std::shared_ptr<Record> Block::get_record(RecordId record_id)
 {
-    // enforce length constraint
-    if (record_id.size() != Record::RECORD_ID_SIZE) {
-        throw std::invalid_argument("record_id must be exactly 10 bytes long.");
-    }
+    std::optional<RecordView> view = get_record_view(record_id);
+
+    if (!view.has_value())
+        return nullptr;
+
+    // copy record data
+    return view->materialize();
+}
 
+std::optional<RecordView> Block::get_record_view(RecordId record_id)
+{
     // get directory offset
-    std::string block_id = get_block_id(record_id);
+    PageId block_id = get_block_id(record_id);
     int offset_index = get_block_dictionary_offset(record_id);
 
     // enforce correct block id
     if (block_id != get_block_id()) {
-        return nullptr;
+        return std::nullopt;
     }
 
-    // get record position in block
-    int offset_val = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + BLOCK_ID_SIZE + offset_index * sizeof(int));
+    // check for invalid or deleted records, forwarding stubs contain no record
+    if (!is_slot_used(offset_index) || get_slot(offset_index)->flags == SLOT_FORWARDED)
+        return std::nullopt;
 
-    // check for invalid or deleted records
-    if (offset_val < 0)
+    // point to record data
+    return RecordView(static_cast<char*>(data.get()) + get_slot(offset_index)->offset);
+}
+
+std::shared_ptr<Record> Block::add_record(std::vector<Record::Attribute> const &attributes) {
+    if (read_only)
         return nullptr;
 
-    // extract record data
-    int record_size = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + offset_val);
+    // retrieve first free slot
+    int offset_index = find_free_slot();
 
-    char* buffer = new char[record_size];
-    std::memcpy(buffer, static_cast<char *>(data.get()) + offset_val, record_size);
+    // could not find free slot
+    if (offset_index == -1)
+        return nullptr;
+
+    RecordId record_id = create_record_id(get_block_id(), offset_index);
+    std::shared_ptr<Record> record = std::make_shared<Record>(Record(record_id, attributes));
+
+    // empty space is not large enough
+    if (!insert_data(offset_index, record->get_data().get(), record->get_size(), SLOT_NORMAL))
+        return nullptr;
+
+    log_change(LogManager::Type::INSERT, offset_index, record->get_data().get(), record->get_size(), {});
 
-    // create record object
-    std::shared_ptr<void> record_data = std::shared_ptr<void>(buffer, [](void* ptr) { delete[] static_cast<char*>(ptr); });
-    return std::make_shared<Record>(Record(record_data));
+    return record;
 }
 
-std::shared_ptr<Record> Block::add_record(std::vector<Record::Attribute> const &attributes) {
-    // retrieve first invalid offset
-    int offset_index = -1;
+std::vector<RecordId> Block::add_records(std::vector<std::vector<Record::Attribute>> const& tuples, size_t first)
+{
+    return add_encoded(tuples, first, nullptr);
+}
+
+std::optional<RecordId> Block::add_tuple(Schema const& schema, std::vector<Record::Attribute> const& attributes)
+{
+    std::vector<RecordId> record_ids = add_encoded({attributes}, 0, &schema);
+
+    if (record_ids.empty())
+        return std::nullopt;
+
+    return record_ids.front();
+}
+
+std::vector<RecordId> Block::add_tuples(Schema const& schema, std::vector<std::vector<Record::Attribute>> const& tuples, size_t first)
+{
+    return add_encoded(tuples, first, &schema);
+}
 
-    for (int i = 0; i < MAX_RECORDS; i++) {
-        int offset_val = *reinterpret_cast<int *>(static_cast<char *>(data.get()) + BLOCK_ID_SIZE + i * sizeof(int));
+std::optional<TupleView> Block::get_tuple_view(Schema const& schema, RecordId record_id)
+{
+    int offset_index = get_block_dictionary_offset(record_id);
+
+    if (get_block_id(record_id) != get_block_id() || !is_slot_used(offset_index) || get_slot(offset_index)->flags != SLOT_NORMAL)
+        return std::nullopt;
+
+    Slot* slot = get_slot(offset_index);
+    return TupleView(schema, static_cast<char*>(data.get()) + slot->offset, slot->length, record_id);
+}
+
+std::vector<RecordId> Block::add_encoded(std::vector<std::vector<Record::Attribute>> const& tuples, size_t first, Schema const* schema)
+{
+    std::vector<RecordId> record_ids;
+
+    if (read_only)
+        return record_ids;
+
+    Header* header = get_header();
+    char* page = static_cast<char*>(data.get());
+    int offset_index = find_free_slot();
+
+    for (size_t i = first; i < tuples.size() && offset_index != -1; i++)
+    {
+        uint32_t record_size = schema ? schema->get_encoded_size(tuples.at(i)) : Record::get_encoded_size(tuples.at(i));
+
+        // the dictionary grows if a slot after the last used one is taken
+        uint32_t n_slots = std::max<uint32_t>(header->n_slots, offset_index + 1);
+        uint32_t free_start = dictionary_offset + n_slots * sizeof(Slot);
 
-        if (offset_val == -1) {
-            offset_index = i;
+        if (record_size > UINT16_MAX || !reserve_space(free_start, record_size))
             break;
-        }
+
+        header->free_end -= record_size;
+        header->n_slots = n_slots;
+        header->free_start = free_start;
+        header->n_records++;
+
+        Slot* slot = get_slot(offset_index);
+        slot->offset = header->free_end;
+        slot->length = record_size;
+        slot->flags = SLOT_NORMAL;
+        set_slot_used(offset_index, true);
+
+        // encode the record in place instead of copying it from its own buffer
+        RecordId record_id = create_record_id(get_block_id(), offset_index);
+
+        if (schema)
+            schema->encode(page + slot->offset, tuples.at(i));
+        else
+            Record::encode(page + slot->offset, record_id, tuples.at(i));
+
+        log_change(LogManager::Type::INSERT, offset_index, page + slot->offset, record_size, {});
+
+        record_ids.push_back(record_id);
+        offset_index = find_free_slot(offset_index + 1);
     }
 
-    // could not find empty space
+    if (!record_ids.empty())
+        dirty = true;
+
+    return record_ids;
+}
+
+std::optional<RecordId> Block::add_record_copy(RecordView const& view)
+{
+    if (read_only)
+        return std::nullopt;
+
+    // retrieve first free slot
+    int offset_index = find_free_slot();
+
     if (offset_index == -1)
-        return nullptr;
+        return std::nullopt;
 
-    // find start position to write record
-    int offset_val = BLOCK_ID_SIZE + MAX_RECORDS * sizeof(int);
+    // replace the record id of the copy
+    char const* record_data = static_cast<char const*>(view.get_data());
+    std::vector<char> copy(record_data, record_data + view.get_size());
+    RecordId record_id = create_record_id(get_block_id(), offset_index);
+    std::memcpy(copy.data() + (view.get_attribute_bytes(0).data() - record_data), &record_id, Record::RECORD_ID_SIZE);
 
-    if (offset_index > 0) {
-        // get position from last valid record
-        int prev_offset_val = *reinterpret_cast<int *>(static_cast<char *>(data.get()) + BLOCK_ID_SIZE +
-                                                (offset_index - 1) * sizeof(int));
+    if (!insert_data(offset_index, copy.data(), copy.size(), SLOT_NORMAL))
+        return std::nullopt;
 
-        // read last record id
-        int prev_record_offset_val = *reinterpret_cast<int *>(static_cast<char *>(data.get()) + prev_offset_val + sizeof(int));
-        char *ptr = static_cast<char *>(data.get()) + prev_offset_val + prev_record_offset_val;
-        std::string last_record_id = std::string(ptr, ptr + Record::RECORD_ID_SIZE);
+    log_change(LogManager::Type::INSERT, offset_index, copy.data(), copy.size(), {});
 
-        // set offset_val for new record
-        std::shared_ptr<Record> last_record = get_record(last_record_id);
-        int last_record_size = last_record->get_size();
-        offset_val = prev_offset_val + last_record_size;
-    }
+    return record_id;
+}
 
-    std::string record_id = create_record_id(get_block_id(), offset_index);
-    std::shared_ptr<Record> record = std::make_shared<Record>(Record(record_id, attributes));
+std::optional<RecordId> Block::add_relocated_record(std::shared_ptr<Record> const& record)
+{
+    if (read_only)
+        return std::nullopt;
 
-    // empty space is not large enough
-    if (offset_val + record->get_size() >= BLOCK_SIZE)
-        return nullptr;
+    // retrieve first free slot
+    int offset_index = find_free_slot();
 
-    // write record to block (and its offset to the directory)
-    std::memcpy(static_cast<char *>(data.get()) + BLOCK_ID_SIZE + offset_index * sizeof(int), &offset_val, sizeof(int));
-    std::memcpy(static_cast<char *>(data.get()) + offset_val, static_cast<char *>(record->get_data().get()), record->get_size());
-    dirty = true;
+    if (offset_index == -1)
+        return std::nullopt;
 
-    return record;
+    // the record keeps its own (home) record id, only the location is new
+    if (!insert_data(offset_index, record->get_data().get(), record->get_size(), SLOT_RELOCATED))
+        return std::nullopt;
+
+    log_change(LogManager::Type::INSERT_RELOCATED, offset_index, record->get_data().get(), record->get_size(), {});
+
+    return create_record_id(get_block_id(), offset_index);
 }
 
 bool Block::update_record(std::shared_ptr<Record> const& record)
+{
+    return update_record(record, record->get_record_id());
+}
+
+bool Block::update_record(std::shared_ptr<Record> const& record, RecordId location)
 {
     // get directory offset
-    std::string block_id = get_block_id();
-    int offset_index = get_block_dictionary_offset(record->get_record_id());
+    PageId block_id = get_block_id(location);
+    int offset_index = get_block_dictionary_offset(location);
 
     // enforce correct block id
-    if (block_id != get_block_id()) {
+    if (block_id != get_block_id() || read_only) {
         return false;
     }
 
-    // get record position in block
-    int offset_val = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + BLOCK_ID_SIZE + offset_index * sizeof(int));
+    // check for invalid or deleted records, forwarded records are updated at their new location
+    if (!is_slot_used(offset_index) || get_slot(offset_index)->flags == SLOT_FORWARDED)
+        return false;
 
-    // get ext record position in block
-    int next_offset_val = BLOCK_SIZE;
+    std::vector<char> undo_image = get_slot_image(offset_index);
 
-    if (offset_index+1 < MAX_RECORDS)
-    {
-        int next_entry = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + BLOCK_ID_SIZE + (offset_index+1) * sizeof(int));
+    if (!replace_data(offset_index, record->get_data().get(), record->get_size()))
+        return false;
+
+    log_change(LogManager::Type::UPDATE, offset_index, record->get_data().get(), record->get_size(), undo_image);
+    return true;
+}
+
+bool Block::delete_record(RecordId record_id)
+{
+    // get directory offset
+    PageId block_id = get_block_id(record_id);
+    int offset_index = get_block_dictionary_offset(record_id);
 
-        if (next_entry >= 0)
-            next_offset_val = next_entry;
+    // enforce correct block id
+    if (block_id != get_block_id() || read_only) {
+        return false;
     }
 
     // check for invalid or deleted records
-    if (offset_val < 0)
+    if (!is_slot_used(offset_index))
         return false;
 
-    // read available record space
-    int record_space = next_offset_val - offset_val;
+    std::vector<char> undo_image = get_slot_image(offset_index);
+    free_slot(offset_index);
+    log_change(LogManager::Type::DELETE, offset_index, nullptr, 0, undo_image);
 
-    // only allow smaller / equal size updates
-    if (record->get_size() > record_space)
+    return true;
+}
+
+std::optional<RecordId> Block::get_forward(RecordId record_id)
+{
+    int offset_index = get_block_dictionary_offset(record_id);
+
+    if (get_block_id(record_id) != get_block_id() || !is_slot_used(offset_index))
+        return std::nullopt;
+
+    Slot* slot = get_slot(offset_index);
+
+    if (slot->flags != SLOT_FORWARDED)
+        return std::nullopt;
+
+    RecordId target_id;
+    std::memcpy(&target_id, static_cast<char*>(data.get()) + slot->offset, sizeof(RecordId));
+    return target_id;
+}
+
+bool Block::set_forward(RecordId record_id, RecordId target_id)
+{
+    int offset_index = get_block_dictionary_offset(record_id);
+
+    if (get_block_id(record_id) != get_block_id() || !is_slot_used(offset_index) || read_only)
         return false;
 
-    // overwrite old data with zeros
-    std::stringstream ss;
-    ss << std::setw(record_space) << std::setfill('0');
-    std::memcpy(static_cast<char *>(data.get()) + offset_val, ss.str().c_str(), record_space);
+    Slot* slot = get_slot(offset_index);
 
-    // write updated record data
-    std::memcpy(static_cast<char *>(data.get()) + offset_val, static_cast<char *>(record->get_data().get()), record->get_size());
+    // relocated records are never forwarded again, their home slot is changed instead
+    if (slot->flags == SLOT_RELOCATED)
+        return false;
+
+    std::vector<char> undo_image = get_slot_image(offset_index);
+
+    // the target record id always fits into the space of the old record
+    get_header()->fragmented += slot->length - sizeof(RecordId);
+    slot->length = sizeof(RecordId);
+    slot->flags = SLOT_FORWARDED;
+    std::memcpy(static_cast<char*>(data.get()) + slot->offset, &target_id, sizeof(RecordId));
+    log_change(LogManager::Type::FORWARD, offset_index, &target_id, sizeof(RecordId), undo_image);
 
     dirty = true;
     return true;
 }
 
-bool Block::delete_record(std::string const& record_id)
+bool Block::is_relocated(RecordId record_id)
 {
-    // enforce length constraint
-    if (record_id.size() != Record::RECORD_ID_SIZE) {
-        throw std::invalid_argument("record_id must be exactly 10 bytes long.");
+    int offset_index = get_block_dictionary_offset(record_id);
+
+    if (get_block_id(record_id) != get_block_id() || !is_slot_used(offset_index))
+        return false;
+
+    return get_slot(offset_index)->flags == SLOT_RELOCATED;
+}
+
+bool Block::redo(LogManager::LogRecord const& log_record)
+{
+    // the page already contains the change if it was written after it
+    if (read_only || !is_slotted() || log_record.page_id != get_block_id() || log_record.lsn <= get_page_lsn())
+        return false;
+
+    int offset_index = log_record.slot;
+    bool success = true;
+
+    if (log_record.type == LogManager::Type::DELETE)
+    {
+        if (is_slot_used(offset_index))
+            free_slot(offset_index);
+    } else if (log_record.type == LogManager::Type::UPDATE)
+    {
+        success = is_slot_used(offset_index) && replace_data(offset_index, log_record.data.data(), log_record.data.size());
+    } else if (log_record.type == LogManager::Type::INSERT || log_record.type == LogManager::Type::INSERT_RELOCATED ||
+               log_record.type == LogManager::Type::FORWARD)
+    {
+        success = put_slot(offset_index, log_record.data.data(), log_record.data.size(), get_slot_flags(log_record.type));
+    } else
+    {
+        return false;
     }
 
-    // get directory offset
-    std::string block_id = get_block_id();
-    int offset_index = get_block_dictionary_offset(record_id);
+    // the page is changed up to this log record, but not written yet
+    get_header()->lsn = log_record.lsn;
 
-    // enforce correct block id
-    if (block_id != get_block_id()) {
+    if (recovery_lsn == 0)
+        recovery_lsn = log_record.lsn;
+
+    dirty = true;
+    return success;
+}
+
+bool Block::undo(LogManager::LogRecord const& log_record)
+{
+    if (read_only || !is_slotted() || log_record.page_id != get_block_id())
+        return false;
+
+    if (log_record.type != LogManager::Type::INSERT && log_record.type != LogManager::Type::INSERT_RELOCATED &&
+        log_record.type != LogManager::Type::UPDATE && log_record.type != LogManager::Type::DELETE &&
+        log_record.type != LogManager::Type::FORWARD)
         return false;
+
+    // the undo is logged like any other change, so it is redone (or undone again) after a crash
+    int offset_index = log_record.slot;
+    std::vector<char> undo_image = get_slot_image(offset_index);
+
+    // the slot was free before the change
+    if (log_record.undo_data.empty())
+    {
+        if (!is_slot_used(offset_index))
+            return true;
+
+        free_slot(offset_index);
+        log_change(LogManager::Type::DELETE, offset_index, nullptr, 0, undo_image);
+        return true;
     }
 
-    // get record position in block
-    int offset_val = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + BLOCK_ID_SIZE + offset_index * sizeof(int));
+    // restore the old record with its slot flags
+    uint16_t flags;
+    std::memcpy(&flags, log_record.undo_data.data(), sizeof(uint16_t));
+    char const* record_data = log_record.undo_data.data() + sizeof(uint16_t);
+    uint32_t record_size = log_record.undo_data.size() - sizeof(uint16_t);
 
-    // check for invalid or deleted records
-    if (offset_val < 0)
+    if (!put_slot(offset_index, record_data, record_size, flags))
         return false;
 
-    int record_size = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + offset_val);
+    log_change(get_log_type(flags), offset_index, record_data, record_size, undo_image);
+    return true;
+}
+
+void Block::compact()
+{
+    if (read_only || !is_slotted())
+        return;
 
-    // delete record dictionary entry and data
-    int val = -2;
-    std::memcpy(static_cast<char *>(data.get()) + BLOCK_ID_SIZE + offset_index * sizeof(int), &val, sizeof(int));
+    Header* header = get_header();
+    std::vector<Slot*> slots;
 
-    std::stringstream ss;
-    ss << std::setw(record_size) << std::setfill('0');
-    std::memcpy(static_cast<char *>(data.get()) + offset_val, ss.str().c_str(), record_size);
+    for (uint32_t i = 0; i < header->n_slots; i++)
+    {
+        if (is_slot_used(i) && get_slot(i)->length > 0)
+            slots.push_back(get_slot(i));
+    }
+
+    // slide records towards the block end, starting with the last one
+    std::sort(slots.begin(), slots.end(), [](Slot* a, Slot* b) { return a->offset > b->offset; });
+
+    uint32_t end = block_size;
+
+    for (Slot* slot : slots)
+    {
+        end -= slot->length;
+
+        if (end != slot->offset)
+            std::memmove(static_cast<char*>(data.get()) + end, static_cast<char*>(data.get()) + slot->offset, slot->length);
+
+        slot->offset = end;
+    }
 
+    header->free_end = end;
+    header->fragmented = 0;
     dirty = true;
-    return true;
+}
+
+int Block::get_slot_count()
+{
+    return get_header()->n_slots;
+}
+
+int Block::find_used_slot(int start)
+{
+    int n_slots = get_slot_count();
+
+    if (!is_slotted() || start < 0 || start >= n_slots)
+        return -1;
+
+    uint8_t const* bitmap = static_cast<uint8_t*>(data.get()) + BITMAP_OFFSET;
+
+    for (int i = start / 64; i * 64 < n_slots; i++)
+    {
+        uint64_t word;
+        std::memcpy(&word, bitmap + i * sizeof(uint64_t), sizeof(uint64_t));
+
+        // slots before the start count as empty
+        if (i == start / 64)
+            word &= ~((uint64_t(1) << (start % 64)) - 1);
+
+        if (word != 0)
+        {
+            int slot = i * 64 + __builtin_ctzll(word);
+            return slot < n_slots ? slot : -1;
+        }
+    }
+
+    return -1;
+}
+
+int Block::get_record_count()
+{
+    return get_header()->n_records;
+}
+
+int Block::get_free_space()
+{
+    Header* header = get_header();
+    return header->free_end - header->free_start;
+}
+
+int Block::get_block_size()
+{
+    return block_size;
+}
+
+int Block::get_max_records()
+{
+    return max_records;
 }
 
 bool Block::is_dirty()
@@ -222,93 +508,345 @@ bool Block::is_dirty()
     return dirty;
 }
 
+void Block::set_dirty()
+{
+    dirty = true;
+}
+
+std::shared_ptr<void> Block::get_data()
+{
+    return data;
+}
+
+bool Block::is_read_only()
+{
+    return read_only;
+}
+
+void Block::set_log(std::shared_ptr<LogManager> const& log)
+{
+    this->log = log;
+}
+
+uint64_t Block::get_page_lsn()
+{
+    return get_header()->lsn;
+}
+
+uint64_t Block::get_recovery_lsn()
+{
+    return recovery_lsn;
+}
+
 bool Block::write_data()
 {
-    std::ofstream file(BLOCK_DIR + get_block_id(), std::ios::binary | std::ios::out);
+    // write-ahead rule: the log records of all changes reach the disk before the page
+    if (log && !log->flush(get_page_lsn()))
+        return false;
 
-    if (!file.is_open())
+    if (!storage->write_page(get_block_id(), data.get()))
         return false;
 
-    char* buffer = static_cast<char*>(data.get());
-    file.write(buffer, BLOCK_SIZE);
+    dirty = false;
+    recovery_lsn = 0;
+    return true;
+}
+
+std::shared_ptr<void> Block::copy_data_for_write()
+{
+    std::shared_ptr<void> buffer = storage->allocate_page();
+    std::memcpy(buffer.get(), data.get(), block_size);
 
-    file.close();
     dirty = false;
+    recovery_lsn = 0;
+    return buffer;
+}
+
+void Block::restore_dirty(uint64_t recovery_lsn)
+{
+    dirty = true;
+
+    // changes after the copy may have started a later recovery LSN
+    if (recovery_lsn != 0 && (this->recovery_lsn == 0 || recovery_lsn < this->recovery_lsn))
+        this->recovery_lsn = recovery_lsn;
+}
+
+std::shared_ptr<void> Block::load_data(std::shared_ptr<StorageManager> const& storage, PageId block_id)
+{
+    // Allocate memory and read the page into it
+    std::shared_ptr<void> buffer = storage->allocate_page();
+
+    // Handle missing page
+    if (!storage->read_page(block_id, buffer.get()))
+        return nullptr;
+
+    return buffer;
+}
+
+RecordId Block::create_record_id(PageId block_id, int offset)
+{
+    return (block_id << SLOT_BITS) | static_cast<RecordId>(offset);
+}
+
+PageId Block::get_block_id(RecordId record_id)
+{
+    return record_id >> SLOT_BITS;
+}
+
+int Block::get_block_dictionary_offset(RecordId record_id)
+{
+    return static_cast<int>(record_id & ((RecordId(1) << SLOT_BITS) - 1));
+}
+
+int Block::get_max_records(int block_size)
+{
+    // enough slots to fill the block with the smallest records, in whole bitmap words
+    int max_records = block_size / MIN_RECORD_SPACE / 64 * 64;
+    return std::min(max_records, 1 << SLOT_BITS);
+}
+
+int Block::get_usable_space(int block_size)
+{
+    return block_size - BITMAP_OFFSET - get_max_records(block_size) / 8;
+}
+
+bool Block::insert_data(int offset_index, void const* record_data, uint32_t record_size, uint16_t flags)
+{
+    Header* header = get_header();
+
+    // record lengths are stored with 16 bits
+    if (record_size > UINT16_MAX)
+        return false;
+
+    // the dictionary grows if a slot after the last used one is taken
+    uint32_t n_slots = std::max<uint32_t>(header->n_slots, offset_index + 1);
+    uint32_t free_start = dictionary_offset + n_slots * sizeof(Slot);
+
+    if (!reserve_space(free_start, record_size))
+        return false;
+
+    // write record to the end of the free space (and its position to the directory)
+    header->free_end -= record_size;
+    header->n_slots = n_slots;
+    header->free_start = free_start;
+    header->n_records++;
+
+    Slot* slot = get_slot(offset_index);
+    slot->offset = header->free_end;
+    slot->length = record_size;
+    slot->flags = flags;
+    set_slot_used(offset_index, true);
+
+    std::memcpy(static_cast<char *>(data.get()) + slot->offset, record_data, record_size);
+    dirty = true;
 
     return true;
 }
 
-std::shared_ptr<void> Block::load_data(std::string const& block_id)
+bool Block::reserve_space(uint32_t free_start, uint32_t size)
 {
-    // Create block directory (if needed)
-    if (!std::filesystem::exists(BLOCK_DIR)) {
-        if (!std::filesystem::create_directory(BLOCK_DIR)) {
-            std::cerr << "Failed to create block directory." << std::endl;
-        }
+    Header* header = get_header();
+
+    if (free_start + size <= header->free_end)
+        return true;
+
+    // not enough space, even when the block is compacted
+    if (free_start + size > header->free_end + header->fragmented)
+        return false;
+
+    compact();
+    return true;
+}
+
+bool Block::put_slot(int offset_index, void const* record_data, uint32_t record_size, uint16_t flags)
+{
+    if (!is_slot_used(offset_index))
+        return insert_data(offset_index, record_data, record_size, flags);
+
+    if (!replace_data(offset_index, record_data, record_size))
+        return false;
+
+    get_slot(offset_index)->flags = flags;
+    return true;
+}
+
+bool Block::replace_data(int offset_index, void const* record_data, uint32_t record_size)
+{
+    Header* header = get_header();
+    Slot* slot = get_slot(offset_index);
+
+    if (record_size <= slot->length)
+    {
+        // update in place, compaction reclaims the remaining bytes
+        header->fragmented += slot->length - record_size;
+        slot->length = record_size;
+    } else
+    {
+        // the record grows, check that it fits once its old space is free
+        if (record_size > UINT16_MAX || header->free_start + record_size > header->free_end + header->fragmented + slot->length)
+            return false;
+
+        // release the old space
+        if (slot->offset == header->free_end)
+            header->free_end += slot->length;
+        else
+            header->fragmented += slot->length;
+
+        slot->length = 0;
+
+        // move the record to the free space (compacting the block if needed)
+        reserve_space(header->free_start, record_size);
+        header->free_end -= record_size;
+        slot->offset = header->free_end;
+        slot->length = record_size;
     }
 
-    // open file handle
-    std::ifstream file(BLOCK_DIR + block_id, std::ios::binary | std::ios::in);
+    // write updated record data
+    std::memcpy(static_cast<char *>(data.get()) + slot->offset, record_data, record_size);
 
-    if (!file.is_open())
-        return nullptr;
+    dirty = true;
+    return true;
+}
 
-    // Allocate memory and read the file into it
-    char* buffer = new char[BLOCK_SIZE];
-    file.read(buffer, BLOCK_SIZE);
+void Block::free_slot(int offset_index)
+{
+    Header* header = get_header();
+    Slot* slot = get_slot(offset_index);
 
-    // Handle partial read (error)
-    if (!file) {
-        delete[] buffer;
-        file.close();
-        return nullptr;
+    // reclaim the record space directly if it borders the free space, otherwise on compaction
+    if (slot->offset == header->free_end)
+        header->free_end += slot->length;
+    else
+        header->fragmented += slot->length;
+
+    // free the slot for reuse
+    set_slot_used(offset_index, false);
+    header->n_records--;
+
+    // the whole record area is free again once the block is empty
+    if (header->n_records == 0)
+    {
+        header->free_end = block_size;
+        header->fragmented = 0;
     }
 
-    file.close();
-    return std::shared_ptr<void>(buffer, [](void* ptr) { delete[] static_cast<char*>(ptr); });
+    // shrink the dictionary to the last used slot
+    while (header->n_slots > 0 && !is_slot_used(header->n_slots - 1))
+        header->n_slots--;
+
+    header->free_start = dictionary_offset + header->n_slots * sizeof(Slot);
+    dirty = true;
 }
 
-std::string Block::create_block_id(int offset)
+std::vector<char> Block::get_slot_image(int offset_index)
 {
-    // create new record
-    std::stringstream ss;
-    ss << std::setw(5) << std::setfill('0') << offset;
-    std::string block_id = ss.str();
+    std::vector<char> image;
 
-    if (block_id.size() > Block::BLOCK_ID_SIZE)
-        throw std::runtime_error("Block id can at most have 5 bytes.");
+    if (!log || !is_slot_used(offset_index))
+        return image;
 
-    return block_id;
+    // slot flags followed by the record data
+    Slot* slot = get_slot(offset_index);
+    image.resize(sizeof(uint16_t) + slot->length);
+    std::memcpy(image.data(), &slot->flags, sizeof(uint16_t));
+    std::memcpy(image.data() + sizeof(uint16_t), static_cast<char*>(data.get()) + slot->offset, slot->length);
+
+    return image;
 }
 
-std::string Block::create_record_id(std::string const& block_id, int offset)
+void Block::log_change(LogManager::Type type, int offset_index, void const* change_data, uint32_t size,
+                       std::vector<char> const& undo_image)
 {
-    // create new record offset
-    std::stringstream ss;
-    ss << std::setw(5) << std::setfill('0') << offset;
-    std::string record_offset = ss.str();
+    if (!log)
+        return;
+
+    uint64_t lsn = log->append(type, get_block_id(), offset_index, change_data, size, undo_image.data(), undo_image.size());
+    get_header()->lsn = lsn;
 
-    // create new record
-    return block_id + record_offset;
+    // first change since the page was written, recovery has to start here for this page
+    if (recovery_lsn == 0)
+        recovery_lsn = lsn;
 }
 
-std::string Block::get_block_id(std::string const& record_id)
+uint16_t Block::get_slot_flags(LogManager::Type type)
 {
-    if (record_id.size() != Record::RECORD_ID_SIZE) {
-        throw std::invalid_argument("record_id must be exactly 10 bytes long.");
-    }
-    return record_id.substr(0, 5);
+    if (type == LogManager::Type::INSERT_RELOCATED)
+        return SLOT_RELOCATED;
+    else if (type == LogManager::Type::FORWARD)
+        return SLOT_FORWARDED;
+
+    return SLOT_NORMAL;
+}
+
+LogManager::Type Block::get_log_type(uint16_t flags)
+{
+    if (flags == SLOT_RELOCATED)
+        return LogManager::Type::INSERT_RELOCATED;
+    else if (flags == SLOT_FORWARDED)
+        return LogManager::Type::FORWARD;
+
+    return LogManager::Type::INSERT;
+}
+
+Block::Header* Block::get_header()
+{
+    return static_cast<Header*>(data.get());
+}
+
+bool Block::is_slotted()
+{
+    return get_header()->magic == BLOCK_MAGIC;
 }
 
-int Block::get_block_dictionary_offset(std::string const& record_id)
+Block::Slot* Block::get_slot(int offset_index)
 {
-    std::string record_offset = record_id.substr(5, 5);
+    return reinterpret_cast<Slot*>(static_cast<char*>(data.get()) + dictionary_offset) + offset_index;
+}
+
+bool Block::is_slot_used(int offset_index)
+{
+    if (!is_slotted() || offset_index < 0 || offset_index >= (int) get_header()->n_slots)
+        return false;
+
+    uint8_t const* bitmap = static_cast<uint8_t*>(data.get()) + BITMAP_OFFSET;
+    return (bitmap[offset_index / 8] >> (offset_index % 8)) & 1;
+}
 
-    std::stringstream ss;
-    ss << record_offset;
+void Block::set_slot_used(int offset_index, bool used)
+{
+    uint8_t* bitmap = static_cast<uint8_t*>(data.get()) + BITMAP_OFFSET;
 
-    int dictionary_offset;
-    ss >> dictionary_offset;
+    if (used)
+        bitmap[offset_index / 8] |= (1 << (offset_index % 8));
+    else
+        bitmap[offset_index / 8] &= ~(1 << (offset_index % 8));
+}
+
+int Block::find_free_slot()
+{
+    return find_free_slot(0);
+}
+
+int Block::find_free_slot(int start)
+{
+    if (!is_slotted())
+        return -1;
+
+    uint8_t const* bitmap = static_cast<uint8_t*>(data.get()) + BITMAP_OFFSET;
+
+    // check 64 slots at once
+    for (int i = start / 64; i < max_records / 64; i++)
+    {
+        uint64_t word;
+        std::memcpy(&word, bitmap + i * sizeof(uint64_t), sizeof(uint64_t));
+
+        // slots before the start count as used
+        if (i == start / 64)
+            word |= (uint64_t(1) << (start % 64)) - 1;
+
+        if (word != UINT64_MAX)
+            return i * 64 + __builtin_ctzll(~word);
+    }
 
-    return dictionary_offset;
+    return -1;
 }
@@ -3,30 +3,36 @@
 #include <cassert>
 #include <optional>
 #include <vector>
+#include <algorithm>
 
+#include "header/identifiers.h"
 #include "header/record.h"
 #include "header/block.h"
 #include "header/buffer_manager.h"
 #include "header/bptree.h"
 
 
-BPTreeNode::BPTreeNode(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& node_id)
-: buffer_manager(buffer_manager), block_id(node_id) {}
+BPTreeNode::BPTreeNode(std::shared_ptr<BufferManager> const& buffer_manager, PageId node_id)
+: buffer_manager(buffer_manager), block_id(node_id), max_values(get_max_values(buffer_manager->get_block_size()))
+{
+    // nodes of trees that were created before a restart are marked when they are used
+    buffer_manager->set_page_type(node_id, BufferManager::PageType::INDEX);
+}
 
-std::string BPTreeNode::get_node_id()
+PageId BPTreeNode::get_node_id()
 {
     return block_id;
 }
 
-std::string BPTreeNode::get_parent_id()
+PageId BPTreeNode::get_parent_id()
 {
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
     // get parent id
-    std::string parent_id = block->get_record(Block::create_record_id(block_id, 0))->get_string_attribute(1);
+    PageId parent_id = block->get_record_view(Block::create_record_id(block_id, PARENT_SLOT))->get_id_attribute(1);
 
     buffer_manager->unfix_block(block_id);
     return parent_id;
@@ -37,10 +43,10 @@ bool BPTreeNode::is_leaf()
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
     // get leaf information
-    bool leaf = block->get_record(Block::create_record_id(block_id, 1))->get_boolean_attribute(1);
+    bool leaf = block->get_record_view(Block::create_record_id(block_id, LEAF_SLOT))->get_boolean_attribute(1);
 
     buffer_manager->unfix_block(block_id);
     return leaf;
@@ -51,48 +57,48 @@ std::vector<int> BPTreeNode::get_values()
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
     // get number of values
-    int n_values = block->get_record(Block::create_record_id(block_id, 2))->get_integer_attribute(1);
+    int n_values = block->get_record_view(Block::create_record_id(block_id, N_VALUES_SLOT))->get_integer_attribute(1);
     std::vector<int> values;
 
     // get values
     for (int i = 0; i < n_values; i++)
-        values.push_back(block->get_record(Block::create_record_id(block_id, 3 + i))->get_integer_attribute(1));
+        values.push_back(block->get_record_view(Block::create_record_id(block_id, VALUES_SLOT + i))->get_integer_attribute(1));
 
     buffer_manager->unfix_block(block_id);
     return values;
 }
 
-std::vector<std::string> BPTreeNode::get_children_ids()
+std::vector<uint64_t> BPTreeNode::get_children_ids()
 {
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
     // get number of children
-    int n_children = block->get_record(Block::create_record_id(block_id, 32))->get_integer_attribute(1);
-    std::vector<std::string> children;
+    int n_children = block->get_record_view(Block::create_record_id(block_id, get_n_children_slot()))->get_integer_attribute(1);
+    std::vector<uint64_t> children;
 
     // get children
     for (int i = 0; i < n_children; i++)
-        children.push_back(block->get_record(Block::create_record_id(block_id, 33 + i))->get_string_attribute(1));
+        children.push_back(block->get_record_view(Block::create_record_id(block_id, get_children_slot() + i))->get_id_attribute(1));
 
     buffer_manager->unfix_block(block_id);
     return children;
 }
 
-bool BPTreeNode::change_parent_id(std::string parent_id)
+bool BPTreeNode::change_parent_id(PageId parent_id)
 {
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
     // change n_values
-    std::shared_ptr<Record> record = std::make_shared<Record>(Record(Block::create_record_id(block_id, 0), {(std::string) parent_id}));
+    std::shared_ptr<Record> record = std::make_shared<Record>(Record(Block::create_record_id(block_id, PARENT_SLOT), {(uint64_t) parent_id}));
 
     if (!block->update_record(record))
         return false;
@@ -106,21 +112,21 @@ bool BPTreeNode::change_values(std::vector<int> const& values)
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
-    if (values.size() > BPTreeNode::MAX_VALUES)
-        throw std::invalid_argument("Cannot have more index block values than " + std::to_string(BPTreeNode::MAX_VALUES));
+    if ((int) values.size() > max_values)
+        throw std::invalid_argument("Cannot have more index block values than " + std::to_string(max_values));
 
     // enforce order
     for (int i = 1; i < values.size(); i++)
     {
         if (values.at(i) < values.at(i-1))
-            throw std::invalid_argument("Cannot have unsorted values in index block: " + block_id);
+            throw std::invalid_argument("Cannot have unsorted values in index block: " + std::to_string(block_id));
     }
 
     // change number of values
     std::shared_ptr<Record> record = std::make_shared<Record>(
-            Record(Block::create_record_id(block_id, 2), {(int) values.size()}));
+            Record(Block::create_record_id(block_id, N_VALUES_SLOT), {(int) values.size()}));
 
     if (!block->update_record(record))
         return false;
@@ -128,7 +134,7 @@ bool BPTreeNode::change_values(std::vector<int> const& values)
     // change values
     for (int i = 0; i < values.size(); i++)
     {
-        std::string record_id = Block::create_record_id(block_id, 3 + i);
+        RecordId record_id = Block::create_record_id(block_id, VALUES_SLOT + i);
         std::shared_ptr<Record> record = std::make_shared<Record>(Record(record_id, {(int) values.at(i)}));
 
         if (!block->update_record(record))
@@ -139,19 +145,19 @@ bool BPTreeNode::change_values(std::vector<int> const& values)
     return true;
 }
 
-bool BPTreeNode::change_children_ids(std::vector<std::string> const& children_ids)
+bool BPTreeNode::change_children_ids(std::vector<uint64_t> const& children_ids)
 {
     std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + block_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(block_id));
 
-    if (children_ids.size() > BPTreeNode::MAX_CHILDREN)
-        throw std::invalid_argument("Cannot have more index block children than " + std::to_string(BPTreeNode::MAX_CHILDREN));
+    if ((int) children_ids.size() > get_max_children())
+        throw std::invalid_argument("Cannot have more index block children than " + std::to_string(get_max_children()));
 
     // change number of children
     std::shared_ptr<Record> record = std::make_shared<Record>(
-            Record(Block::create_record_id(block_id, 32), {(int) children_ids.size()}));
+            Record(Block::create_record_id(block_id, get_n_children_slot()), {(int) children_ids.size()}));
 
     if (!block->update_record(record))
         return false;
@@ -159,8 +165,8 @@ bool BPTreeNode::change_children_ids(std::vector<std::string> const& children_id
     // change children
     for (int i = 0; i < children_ids.size(); i++)
     {
-        std::string record_id = Block::create_record_id(block_id, 33 + i);
-        std::shared_ptr<Record> record = std::make_shared<Record>(Record(record_id, {(std::string) children_ids.at(i)}));
+        RecordId record_id = Block::create_record_id(block_id, get_children_slot() + i);
+        std::shared_ptr<Record> record = std::make_shared<Record>(Record(record_id, {(uint64_t) children_ids.at(i)}));
 
         if (!block->update_record(record))
             return false;
@@ -170,84 +176,118 @@ bool BPTreeNode::change_children_ids(std::vector<std::string> const& children_id
     return true;
 }
 
-std::shared_ptr<BPTreeNode> BPTreeNode::create_node(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& node_id, std::string parent_id, bool leaf)
+int BPTreeNode::get_max_values()
+{
+    return max_values;
+}
+
+int BPTreeNode::get_max_children()
+{
+    return max_values + 1;
+}
+
+int BPTreeNode::get_max_values(int block_size)
+{
+    // space of each record including its slot
+    static int const id_space = Record(0, {(uint64_t) 0}).get_size() + Block::SLOT_SIZE;
+    static int const int_space = Record(0, {(int) 0}).get_size() + Block::SLOT_SIZE;
+    static int const bool_space = Record(0, {(bool) false}).get_size() + Block::SLOT_SIZE;
+
+    // parent id, leaf flag, both counters and the child after the last value
+    int fixed_space = 2 * id_space + bool_space + 2 * int_space;
+    int max_values = (Block::get_usable_space(block_size) - fixed_space) / (int_space + id_space);
+
+    // each value and child also needs its own slot
+    max_values = std::min(max_values, (Block::get_max_records(block_size) - VALUES_SLOT - 2) / 2);
+
+    // splits only divide an odd number of values into equally sized halves
+    return max_values % 2 == 0 ? max_values - 1 : max_values;
+}
+
+int BPTreeNode::get_n_children_slot()
+{
+    return VALUES_SLOT + max_values;
+}
+
+int BPTreeNode::get_children_slot()
 {
+    return VALUES_SLOT + max_values + 1;
+}
+
+std::shared_ptr<BPTreeNode> BPTreeNode::create_node(std::shared_ptr<BufferManager> const& buffer_manager, PageId node_id, PageId parent_id, bool leaf)
+{
+    buffer_manager->set_page_type(node_id, BufferManager::PageType::INDEX);
+
     std::shared_ptr<Block> block = buffer_manager->fix_block(node_id);
 
     if (block == nullptr)
-        throw std::invalid_argument("Cannot load index block: " + node_id);
+        throw std::invalid_argument("Cannot load index block: " + std::to_string(node_id));
 
     if (!block->is_dirty())
-        throw std::invalid_argument("Index block already exists: " + node_id);
+        throw std::invalid_argument("Index block already exists: " + std::to_string(node_id));
 
-    int n_records = Block::MAX_RECORDS;
+    int max_values = get_max_values(buffer_manager->get_block_size());
 
     // add parent id
-    std::shared_ptr<Record> r = block->add_record({(std::string) parent_id});
-    n_records -= 1;
+    std::shared_ptr<Record> r = block->add_record({(uint64_t) parent_id});
 
     if (r == nullptr)
-        throw std::invalid_argument("Cannot add parent id in " + node_id);
+        throw std::invalid_argument("Cannot add parent id in " + std::to_string(node_id));
 
     // add leaf flag
     r = block->add_record({(bool) leaf});
-    n_records -= 1;
 
     if (r == nullptr)
-        throw std::invalid_argument("Cannot add leaf flag in " + node_id);
+        throw std::invalid_argument("Cannot add leaf flag in " + std::to_string(node_id));
 
     // add amount of valid values
     r = block->add_record({(int) 0});
-    n_records -= 1;
 
     if (r == nullptr)
-        throw std::invalid_argument("Cannot add number of values in " + node_id);
+        throw std::invalid_argument("Cannot add number of values in " + std::to_string(node_id));
 
     // add dummy values
-    for (int i = 0; i < (n_records - 1)/2 - 1; i++)
+    for (int i = 0; i < max_values; i++)
     {
         r = block->add_record({(int) -1});
 
         if (r == nullptr)
-            throw std::invalid_argument("Cannot add dummy values in " + node_id);
+            throw std::invalid_argument("Cannot add dummy values in " + std::to_string(node_id));
     }
 
-    n_records -= (n_records - 1)/2 - 1;
-
     // add amount of valid pointers
     r = block->add_record({(int) 0});
-    n_records -= 1;
 
     if (r == nullptr)
-        throw std::invalid_argument("Cannot add number of pointers in " + node_id);
+        throw std::invalid_argument("Cannot add number of pointers in " + std::to_string(node_id));
 
     // add dummy pointers
-    for (int i = 0; i < n_records; i++)
+    for (int i = 0; i < max_values + 1; i++)
     {
         // create dummy pointer
-        r = block->add_record({ std::string(Record::RECORD_ID_SIZE, '0') });
+        r = block->add_record({(uint64_t) INVALID_RECORD_ID});
 
         if (r == nullptr)
-            throw std::invalid_argument("Cannot add dummy pointers in " + node_id);
+            throw std::invalid_argument("Cannot add dummy pointers in " + std::to_string(node_id));
     }
 
     buffer_manager->unfix_block(block->get_block_id());
     return std::make_shared<BPTreeNode>(buffer_manager, node_id);
 }
 
-std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_record(int attribute, std::string const& record_id)
+std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_record(int attribute, RecordId record_id)
 {
     assert(is_leaf());
 
     std::vector<int> values = get_values();
-    std::vector<std::string> children_ids = get_children_ids();
+    std::vector<uint64_t> children_ids = get_children_ids();
 
     // find correct position to insert new attribute
     auto it = std::lower_bound(values.begin(), values.end(), attribute);
 
     // handle duplicates correctly
     if (it != values.end() && *it == attribute)
-        throw std::invalid_argument("Found duplicates in index block: " + block_id);
+        throw std::invalid_argument("Found duplicates in index block: " + std::to_string(block_id));
 
     // insert attribute and children_id at correct position
     size_t insert_pos = it - values.begin();
@@ -255,7 +295,7 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_re
     children_ids.insert(children_ids.begin() + insert_pos, record_id);
 
     // check if block is over-full
-    if (values.size() <= BPTreeNode::MAX_VALUES)
+    if ((int) values.size() <= max_values)
     {
         assert(change_values(values) && change_children_ids(children_ids));
         return std::nullopt;
@@ -267,7 +307,7 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_re
     );
 
     std::vector<int> new_values = new_node->get_values();
-    std::vector<std::string> new_children_ids = new_node->get_children_ids();
+    std::vector<uint64_t> new_children_ids = new_node->get_children_ids();
 
     // split values and children_ids
     size_t middle_index = values.size() / 2;
@@ -290,12 +330,12 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_re
     return {{new_node, median}};
 }
 
-std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_value(int attribute, std::string const& left_children_id, std::string const& right_children_id)
+std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_value(int attribute, PageId left_children_id, PageId right_children_id)
 {
     assert(!is_leaf());
 
     std::vector<int> values = get_values();
-    std::vector<std::string> children_ids = get_children_ids();
+    std::vector<uint64_t> children_ids = get_children_ids();
 
     int n_values = values.size();
 
@@ -314,7 +354,7 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_va
     children_ids.insert(children_ids.begin() + insert_pos + 1, right_children_id);
 
     // check if block is over-full
-    if (values.size() <= BPTreeNode::MAX_VALUES)
+    if ((int) values.size() <= max_values)
     {
         assert(change_values(values) && change_children_ids(children_ids));
         return std::nullopt;
@@ -332,7 +372,7 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_va
 
     // create new vectors for the new node
     std::vector<int> new_values(values.begin() + middle_index + 1, values.end());
-    std::vector<std::string> new_children_ids(children_ids.begin() + middle_index + 1, children_ids.end());
+    std::vector<uint64_t> new_children_ids(children_ids.begin() + middle_index + 1, children_ids.end());
 
     // Erase the values and children_ids from the original node after the median
     values.resize(middle_index);
@@ -343,28 +383,28 @@ std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> BPTreeNode::insert_va
     assert(new_node->change_values(new_values) && new_node->change_children_ids(new_children_ids));
 
     // set parent ids for new node's children
-    for (std::string children_id : new_node->get_children_ids())
+    for (PageId children_id : new_node->get_children_ids())
         assert(std::make_shared<BPTreeNode>(buffer_manager, children_id)->change_parent_id(new_node->get_node_id()));
 
     return {{new_node, median}};
 }
 
 
-BPTree::BPTree(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& root_node_id)
+BPTree::BPTree(std::shared_ptr<BufferManager> const& buffer_manager, PageId root_node_id)
 : buffer_manager(buffer_manager), root_node_id(root_node_id)
 {
     if (!buffer_manager->block_exists(root_node_id))
         BPTreeNode::create_node(buffer_manager, root_node_id, NO_PARENT, true);
 }
 
-std::optional<std::string> BPTree::search_record(int attribute)
+std::optional<RecordId> BPTree::search_record(int attribute)
 {
     // find correct leaf node
     std::shared_ptr<BPTreeNode> leaf_node = find_leaf_node(attribute);
 
     std::vector<int> values = leaf_node->get_values();
     // children IDs are record IDs in leaf nodes
-    std::vector<std::string> record_ids = leaf_node->get_children_ids();
+    std::vector<uint64_t> record_ids = leaf_node->get_children_ids();
 
     // search for attribute
     for (int i = 0; i < values.size(); i++)
@@ -377,7 +417,7 @@ std::optional<std::string> BPTree::search_record(int attribute)
     return std::nullopt;
 }
 
-bool BPTree::insert_record(int attribute, std::string const& record_id)
+bool BPTree::insert_record(int attribute, RecordId record_id)
 {
     // find correct leaf node
     std::shared_ptr<BPTreeNode> leaf_node = find_leaf_node(attribute);
@@ -408,7 +448,7 @@ bool BPTree::insert_record(int attribute, std::string const& record_id)
         // check if current is root
         if (current->get_parent_id() == NO_PARENT) {
             // create new root
-            std::string new_root_id = buffer_manager->create_new_block();
+            PageId new_root_id = buffer_manager->create_new_block();
             std::shared_ptr<BPTreeNode> new_root = BPTreeNode::create_node(buffer_manager, new_root_id, NO_PARENT, false);
 
             // change parent ids
@@ -455,7 +495,7 @@ bool BPTree::insert_record(int attribute, std::string const& record_id)
     return true;
 }
 
-std::string BPTree::get_root_node_id()
+PageId BPTree::get_root_node_id()
 {
     return root_node_id;
 }
@@ -469,9 +509,9 @@ std::shared_ptr<BPTreeNode> BPTree::find_leaf_node(int attribute)
     while (!current_node->is_leaf())
     {
         std::vector<int> values = current_node->get_values();
-        std::vector<std::string> children_ids = current_node->get_children_ids();
+        std::vector<uint64_t> children_ids = current_node->get_children_ids();
 
-        std::string next_node_id;
+        PageId next_node_id;
 
         // check values and traverse
         for (size_t i = 0; i < values.size(); ++i)
@@ -500,13 +540,13 @@ std::shared_ptr<BPTreeNode> BPTree::find_leaf_node(int attribute)
 bool BPTree::erase()
 {
     // Start at root node
-    std::list<std::string> nodes = {root_node_id};
+    std::list<PageId> nodes = {root_node_id};
 
     // navigate down the tree and erase nodes
     while (!nodes.empty())
     {
         // get current node
-        std::string current_node_id = nodes.front();
+        PageId current_node_id = nodes.front();
         nodes.pop_front();
 
         // add children to list
@@ -514,7 +554,7 @@ bool BPTree::erase()
 
         if (!current_node->is_leaf())
         {
-            std::vector<std::string> children = current_node->get_children_ids();
+            std::vector<uint64_t> children = current_node->get_children_ids();
             nodes.insert(nodes.end(), children.begin(), children.end());
         }
 
@@ -3,154 +3,1567 @@
 #include <list>
 #include <unordered_map>
 #include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstring>
 
-#include "header/filesystem.h"
+#include "header/identifiers.h"
 #include "header/record.h"
 #include "header/block.h"
+#include "header/storage_manager.h"
+#include "header/log_manager.h"
 #include "header/buffer_manager.h"
 
- std::string const BufferManager::BLOCK_ID = "bfmgr";
+BufferManager::BufferManager(int n_blocks)
+    : BufferManager(n_blocks, std::make_shared<StorageManager>(Block::BLOCK_DIR)) {}
 
-BufferManager::BufferManager(int n_blocks) : n_blocks(n_blocks)
+BufferManager::BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage)
+    : BufferManager(n_blocks, storage, nullptr) {}
+
+BufferManager::BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage, std::shared_ptr<LogManager> const& log)
+    : BufferManager(n_blocks, storage, log, ReplacementPolicy::Type::LRU) {}
+
+BufferManager::BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage, std::shared_ptr<LogManager> const& log,
+                             ReplacementPolicy::Type policy)
+    : n_blocks(n_blocks), storage(storage), log(log), recovering(false), n_recovered_records(0),
+      sync(std::make_unique<Synchronization>()), n_frames(0), dirty_ratio(1), max_dirty_age(0), policy(ReplacementPolicy::create(policy, n_blocks)), next_block_id(BLOCK_ID + 1), reserved_block_id(BLOCK_ID), free_blocks_changed(false), overflow_block_id(INVALID_PAGE_ID)
 {
-    if (block_exists(BLOCK_ID))
+    if (log && storage->is_read_only())
+        throw std::invalid_argument("Cannot log changes of a read-only database.");
+
+    // bring the pages to the state of the log before they are used
+    if (log)
+        recover();
+
+    if (storage->is_read_only())
         return;
 
-    std::shared_ptr<Block> block = fix_block(BLOCK_ID);
+    if (!block_exists(BLOCK_ID))
+    {
+        std::shared_ptr<Block> block = fix_block(BLOCK_ID);
 
-    if (block == nullptr)
-        throw std::invalid_argument("Cannot load buffer manager block: " + BLOCK_ID);
+        if (block == nullptr)
+            throw std::invalid_argument("Cannot load buffer manager block: " + std::to_string(BLOCK_ID));
 
-    // add amount of created blocks
-    std::shared_ptr<Record> r = block->add_record({(int) 0});
+        // add id of the last created block
+        std::shared_ptr<Record> r = block->add_record({(uint64_t) BLOCK_ID});
 
-    if (r == nullptr)
-        throw std::invalid_argument("Cannot add number of created blocks in " + BLOCK_ID);
+        if (r == nullptr)
+            throw std::invalid_argument("Cannot add last block id in " + std::to_string(BLOCK_ID));
 
-    unfix_block(BLOCK_ID);
+        unfix_block(BLOCK_ID);
+
+        // the meta block must survive the undo of a recovery
+        if (log)
+            log->commit();
+    }
+
+    load_free_blocks();
+}
+
+BufferManager::~BufferManager()
+{
+    // moved buffer managers have no thread
+    if (sync)
+        stop_writer();
+}
+
+std::atomic<uint64_t> BufferManager::Ring::next_ring_id(1);
+
+BufferManager::Ring::Ring(int n_frames) : n_frames(n_frames), ring_id(next_ring_id++)
+{
+    if (n_frames < 1)
+        throw std::invalid_argument("A ring needs at least one frame.");
+}
+
+std::shared_ptr<BufferManager::Ring> BufferManager::create_ring()
+{
+    return std::make_shared<Ring>(std::max(1, std::min(MAX_RING_FRAMES, n_blocks / 4)));
+}
+
+std::shared_ptr<Block> BufferManager::fix_block(PageId block_id)
+{
+    return fix_block(block_id, nullptr);
+}
+
+std::shared_ptr<Block> BufferManager::fix_block(PageId block_id, std::shared_ptr<Ring> const& ring)
+{
+    // Read-only databases hand out views of the mapped pages, the kernel manages residency
+    if (storage->is_read_only())
+        return fix_mapped_block(block_id);
+
+    if (sync->tracing)
+        add_trace_entry(ReplacementPolicy::TraceEntry::Access::FIX, block_id);
+
+    while (true)
+    {
+        // Check if the block is already in cache
+        std::shared_ptr<Frame> frame = nullptr;
+
+        {
+            Shard& shard = get_shard(block_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.frames.find(block_id);
+
+            if (it != shard.frames.end())
+            {
+                count_fix(shard, it->second->page_type, true);
+
+                // Increase the reference count of a fixed block
+                if (it->second->loaded && add_fix(*it->second))
+                    return it->second->block;
+
+                frame = it->second;
+            }
+        }
+
+        if (frame == nullptr)
+        {
+            frame = load_frame(block_id, ring.get());
+
+            if (frame != nullptr)
+                return frame->block;
+
+            // another thread is loading the block
+            continue;
+        }
+
+        if (!pin_frame(block_id, frame, ring.get()))
+            continue;
+
+        if (frame->loaded)
+            return frame->block;
+
+        // wait until the block is read, if the read failed the block is loaded again
+        std::shared_lock<std::shared_mutex> latch(frame->latch);
+
+        if (frame->block != nullptr)
+            return frame->block;
+    }
 }
 
-std::shared_ptr<Block> BufferManager::fix_block(std::string const& block_id)
+std::shared_ptr<BufferManager::Frame> BufferManager::load_frame(PageId block_id, Ring* ring)
 {
-    // Check if the block is already in cache
-    auto it = cache.find(block_id);
+    // the frame is latched until its block is read, so that other threads wait for the read instead of reading it again
+    std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+    std::unique_lock<std::shared_mutex> latch(frame->latch);
+
+    {
+        Shard& shard = get_shard(block_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (!shard.frames.emplace(block_id, frame).second)
+            return nullptr;
+
+        auto type = shard.page_types.find(block_id);
 
-    if (it != cache.end()) {
-        // Increase the reference count
-        it->second.reference_count++;
+        if (type != shard.page_types.end())
+            frame->page_type = type->second;
 
-        // Note that in 'least recently unfixed' strategy, we do not move the block in the LRU list here
-        return it->second.block;
+        count_fix(shard, frame->page_type, false);
     }
 
-    // If cache is full and no block can be evicted, return nullptr
-    if (cache.size() >= n_blocks && unfixed_blocks.empty()) {
-        throw std::runtime_error("Cannot fix block. Cache is already full.");
+    while (true) {
+        std::unique_lock<std::mutex> lock(sync->policy);
+
+        // A full ring replaces its own block, other blocks are evicted by the replacement policy if necessary
+        PageId block_id_to_evict = ring ? recycle_ring_block(*ring) : INVALID_PAGE_ID;
+
+        if (block_id_to_evict == INVALID_PAGE_ID && n_frames >= n_blocks) {
+            block_id_to_evict = policy->evict(block_id);
+
+            // If cache is full and no block can be evicted, the waiting threads try again
+            if (block_id_to_evict == INVALID_PAGE_ID) {
+                remove_frame(block_id);
+                throw std::runtime_error("Cannot fix block. Cache is already full.");
+            }
+        }
+
+        // a dirty block that was used while it was written stays, another one is evicted instead
+        try {
+            if (block_id_to_evict != INVALID_PAGE_ID && !evict_frame(block_id_to_evict, lock))
+                continue;
+        } catch (...) {
+            remove_frame(block_id);
+            throw;
+        }
+
+        // the block is fixed by this thread
+        n_frames++;
+        policy->on_load(block_id);
+
+        if (ring) {
+            frame->ring_id = ring->ring_id;
+            ring->block_ids.push_back(block_id);
+        }
+
+        break;
     }
 
-    // Evict the least recently unfixed block if necessary
-    if (cache.size() >= n_blocks) {
-        // Get the ID of the least recently unfixed block
-        std::string block_id_to_evict = unfixed_blocks.front();
-        unfixed_blocks.pop_front();
+    // Load the block into cache, prefetched blocks only wait for their read
+    std::shared_ptr<Block> block = nullptr;
+
+    try {
+        std::shared_ptr<void> page = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(sync->prefetch);
+            auto prefetch = prefetched.find(block_id);
 
-        // Evict the block and write to disk if it's dirty
-        std::shared_ptr<Block> block_to_evict = cache[block_id_to_evict].block;
-        if (block_to_evict && block_to_evict->is_dirty()) {
-            block_to_evict->write_data();
+            if (prefetch != prefetched.end()) {
+                page = prefetch->second;
+                prefetched.erase(prefetch);
+            }
         }
 
-        // Remove from the cache
-        cache.erase(block_id_to_evict);
+        auto start = std::chrono::steady_clock::now();
+
+        if (page != nullptr) {
+            bool exists = storage->wait_page(block_id);
+            block = std::make_shared<Block>(storage, block_id, exists ? page : nullptr);
+        } else {
+            // the block may have been evicted while the writer writes it
+            wait_for_write(block_id);
+            block = std::make_shared<Block>(storage, block_id);
+        }
+
+        count_read(std::chrono::steady_clock::now() - start);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(sync->policy);
+        policy->on_erase(block_id);
+        remove_frame(block_id);
+        n_frames--;
+        throw;
+    }
+
+    if (log)
+        block->set_log(log);
+
+    frame->block = block;
+    frame->loaded = true;
+    return frame;
+}
+
+bool BufferManager::evict_frame(PageId block_id, std::unique_lock<std::mutex>& policy_lock)
+{
+    // the latch of the frame is released after the frame left the page table
+    std::shared_ptr<Frame> frame = nullptr;
+
+    {
+        Shard& shard = get_shard(block_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        frame = shard.frames.at(block_id);
+    }
+
+    std::shared_ptr<Block> block = frame->block;
+
+    // clean blocks leave right away, a new fix of the block reads the page again
+    if (block == nullptr || !block->is_dirty()) {
+        count_eviction(frame->page_type);
+        remove_frame(block_id);
+        n_frames--;
+        return true;
+    }
+
+    // Flushes and checkpoints wait for the write of the block, a block they use is not evicted now
+    std::unique_lock<std::shared_mutex> latch(frame->latch, std::try_to_lock);
+
+    if (!latch.owns_lock()) {
+        policy->on_eviction_cancelled(block_id);
+        policy_lock.unlock();
+        std::this_thread::yield();
+        policy_lock.lock();
+        return false;
+    }
+
+    // The block stays in the page table until it is written, so that a new fix of the block does not read the old
+    // page. Its fix keeps it there, other threads may fix it in the meantime.
+    frame->reference_count = 1;
+    frame->evicting = true;
+    PageType page_type = frame->page_type;
+    uint64_t page_lsn = block->get_page_lsn();
+    uint64_t recovery_lsn = block->get_recovery_lsn();
+
+    if (!block->is_slotted())
+        sync->unlogged_writes = true;
+
+    std::shared_ptr<void> page = block->copy_data_for_write();
+    policy_lock.unlock();
+
+    // the writer is behind
+    sync->writer_wakeup.notify_one();
+
+    // write-ahead rule, and an older copy of the writer goes first
+    auto start = std::chrono::steady_clock::now();
+    bool written = !log || log->flush(page_lsn);
+    wait_for_write(block_id);
+
+    // the storage keeps the copy until it is written
+    if (written) {
+        written = storage->write_page_async(block_id, page);
+        storage->submit_pages();
+        written = storage->wait_page(block_id) && written;
+    }
+
+    if (written)
+        count_write({page_type}, std::chrono::steady_clock::now() - start);
+    else
+        block->restore_dirty(recovery_lsn);
+
+    policy_lock.lock();
+    frame->evicting = false;
+    sync->eviction_done.notify_all();
+
+    int pinned = 1;
+    bool unfixed = written && frame->reference_count.compare_exchange_strong(pinned, 0);
+
+    if (unfixed && !block->is_dirty()) {
+        count_eviction(page_type);
+        remove_frame(block_id);
+        n_frames--;
+        return true;
+    }
+
+    // the block stays cached: it was fixed or changed in the meantime, or it could not be written. Fixes while it
+    // was written were not reported to the policy.
+    policy->on_eviction_cancelled(block_id);
+
+    if (!unfixed && --frame->reference_count > 0)
+        policy->on_fix(block_id);
+
+    // a block that cannot be written stays dirty in the cache, the fix fails like with a full cache
+    if (!written)
+        throw std::runtime_error("Cannot write evicted block: " + std::to_string(block_id));
+
+    return false;
+}
+
+void BufferManager::wait_for_write(PageId block_id)
+{
+    std::unique_lock<std::mutex> lock(sync->write_state);
+    sync->write_done.wait(lock, [&] { return sync->pages_in_write.count(block_id) == 0; });
+}
+
+PageId BufferManager::recycle_ring_block(Ring& ring)
+{
+    if (ring.block_ids.size() < ring.n_frames)
+        return INVALID_PAGE_ID;
+
+    PageId block_id = ring.block_ids.front();
+    ring.block_ids.pop_front();
+
+    // the block may have been erased, evicted and loaded again, or be used by others now
+    Frame* frame = find_frame(block_id);
+
+    if (frame == nullptr || frame->ring_id != ring.ring_id || frame->reference_count > 0)
+        return INVALID_PAGE_ID;
+
+    policy->on_erase(block_id);
+    return block_id;
+}
+
+bool BufferManager::add_fix(Frame& frame)
+{
+    int reference_count = frame.reference_count.load();
+
+    while (reference_count > 0)
+    {
+        if (frame.reference_count.compare_exchange_weak(reference_count, reference_count + 1))
+            return true;
+    }
+
+    return false;
+}
+
+bool BufferManager::pin_frame(PageId block_id, std::shared_ptr<Frame> const& frame, Ring* ring)
+{
+    // further fixes of a fixed block only count
+    if (add_fix(*frame))
+        return true;
+
+    // fixed blocks cannot be evicted
+    std::lock_guard<std::mutex> lock(sync->policy);
+
+    if (frame->evicted)
+        return false;
+
+    if (frame->reference_count++ == 0)
+        policy->on_fix(block_id);
+
+    // a block that is used without the ring is no longer replaced by it
+    if (ring == nullptr || frame->ring_id != ring->ring_id)
+        frame->ring_id = 0;
+
+    return true;
+}
+
+std::shared_ptr<Block> BufferManager::remove_frame(PageId block_id)
+{
+    Shard& shard = get_shard(block_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.frames.find(block_id);
+    std::shared_ptr<Frame> frame = it->second;
+
+    frame->evicted = true;
+    shard.frames.erase(it);
+
+    return frame->block;
+}
+
+BufferManager::Shard& BufferManager::get_shard(PageId block_id)
+{
+    // consecutive blocks of a scan go to different shards
+    return sync->shards[block_id % N_SHARDS];
+}
+
+BufferManager::Frame* BufferManager::find_frame(PageId block_id)
+{
+    Shard& shard = get_shard(block_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.frames.find(block_id);
+    return it != shard.frames.end() ? it->second.get() : nullptr;
+}
+
+std::vector<std::pair<PageId, std::shared_ptr<BufferManager::Frame>>> BufferManager::get_frames()
+{
+    std::vector<std::pair<PageId, std::shared_ptr<Frame>>> frames;
+
+    for (Shard& shard : sync->shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (auto& [block_id, frame] : shard.frames)
+            frames.emplace_back(block_id, frame);
+    }
+
+    return frames;
+}
+
+void BufferManager::count_fix(Shard& shard, PageType type, bool hit)
+{
+    Statistics::Counters& counters = shard.counters[(int) type];
+    (hit ? counters.hits : counters.misses)++;
+
+    if (scope_statistics)
+    {
+        Statistics::Counters& scope_counters = scope_statistics->counters[(int) type];
+        (hit ? scope_counters.hits : scope_counters.misses)++;
+    }
+}
+
+void BufferManager::count_eviction(PageType type)
+{
+    {
+        std::lock_guard<std::mutex> lock(sync->statistics);
+        sync->io_statistics.counters[(int) type].evictions++;
+    }
+
+    if (scope_statistics)
+        scope_statistics->counters[(int) type].evictions++;
+}
+
+void BufferManager::count_read(std::chrono::steady_clock::duration time)
+{
+    uint64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+
+    {
+        std::lock_guard<std::mutex> lock(sync->statistics);
+        sync->io_statistics.n_reads++;
+        sync->io_statistics.read_time_ns += time_ns;
+    }
+
+    if (scope_statistics)
+    {
+        scope_statistics->n_reads++;
+        scope_statistics->read_time_ns += time_ns;
+    }
+}
+
+void BufferManager::count_write(std::vector<PageType> const& types, std::chrono::steady_clock::duration time)
+{
+    uint64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+
+    {
+        std::lock_guard<std::mutex> lock(sync->statistics);
+        sync->io_statistics.n_writes++;
+        sync->io_statistics.write_time_ns += time_ns;
+
+        for (PageType type : types)
+            sync->io_statistics.counters[(int) type].dirty_writes++;
+    }
+
+    if (scope_statistics)
+    {
+        scope_statistics->n_writes++;
+        scope_statistics->write_time_ns += time_ns;
+
+        for (PageType type : types)
+            scope_statistics->counters[(int) type].dirty_writes++;
+    }
+}
+
+void BufferManager::add_trace_entry(ReplacementPolicy::TraceEntry::Access access, PageId block_id)
+{
+    std::lock_guard<std::mutex> lock(sync->trace);
+
+    if (sync->tracing)
+        trace.push_back({access, block_id});
+}
+
+int BufferManager::prefetch_blocks(std::vector<PageId> const& block_ids)
+{
+    // mapped pages are read by the kernel on access
+    if (storage->is_read_only())
+        return block_ids.size();
+
+    std::lock_guard<std::mutex> lock(sync->prefetch);
+    size_t index = 0;
+
+    for (; index < block_ids.size(); index++)
+    {
+        PageId block_id = block_ids.at(index);
+
+        if (find_frame(block_id) != nullptr || prefetched.find(block_id) != prefetched.end())
+            continue;
+
+        // prefetched pages do not take cache frames, but are limited to the same number
+        if ((int) prefetched.size() >= n_blocks)
+            break;
+
+        // the block may have been evicted while the writer writes it
+        wait_for_write(block_id);
+        std::shared_ptr<void> page = storage->allocate_page();
+
+        if (storage->read_page_async(block_id, page))
+            prefetched[block_id] = page;
+    }
+
+    // start all reads at once
+    storage->submit_pages();
+    return index;
+}
+
+bool BufferManager::prefetch_block(PageId block_id)
+{
+    return prefetch_blocks({block_id}) == 1;
+}
+
+int BufferManager::cancel_prefetches(std::vector<PageId> const& block_ids)
+{
+    std::lock_guard<std::mutex> lock(sync->prefetch);
+    int n_cancelled = 0;
+
+    for (PageId block_id : block_ids)
+    {
+        if (prefetched.erase(block_id) == 0)
+            continue;
+
+        // the page is freed after its read
+        storage->cancel_page(block_id);
+        n_cancelled++;
     }
 
-    // Load the block into cache
-    std::shared_ptr<Block> block = std::make_shared<Block>(block_id);
-    // Set reference count to 1
-    cache[block_id] = {block, 1};
+    return n_cancelled;
+}
 
-    // Do not add to unfixed_blocks list because it's being fixed for the first time
-    return block;
+int BufferManager::get_prefetched_block_count()
+{
+    std::lock_guard<std::mutex> lock(sync->prefetch);
+    return prefetched.size();
 }
 
-bool BufferManager::unfix_block(std::string const& block_id)
+bool BufferManager::unfix_block(PageId block_id)
 {
-    auto it = cache.find(block_id);
+    // mapped blocks are not counted
+    if (storage->is_read_only())
+        return true;
 
-    if (it == cache.end())
+    Frame* frame = find_frame(block_id);
+
+    if (frame == nullptr)
         throw std::invalid_argument("Cannot unfix block that is not in cache.");
 
-    if (it->second.reference_count == 0)
-        throw std::invalid_argument("Cannot unfix a block without fixes.");
+    if (sync->tracing)
+        add_trace_entry(ReplacementPolicy::TraceEntry::Access::UNFIX, block_id);
+
+    // Decrease the reference count, other fixes keep the block
+    int reference_count = frame->reference_count.load();
+
+    while (reference_count > 1)
+    {
+        if (frame->reference_count.compare_exchange_weak(reference_count, reference_count - 1))
+            return true;
+    }
 
-    // Decrease the reference count
-    it->second.reference_count--;
+    // the last fix keeps the frame until the reference count is 0
+    std::lock_guard<std::mutex> lock(sync->policy);
+
+    if (frame->reference_count == 0)
+        throw std::invalid_argument("Cannot unfix a block without fixes.");
 
-    // If the reference count is zero, add to the list of unfixed blocks
-    if (it->second.reference_count == 0 && std::find(unfixed_blocks.begin(), unfixed_blocks.end(), block_id) == unfixed_blocks.end()) {
-        unfixed_blocks.push_back(block_id);
+    // If the reference count is zero, the block may be evicted
+    if (--frame->reference_count == 0) {
+        policy->on_unfix(block_id);
     }
 
     return true;
 }
 
-bool BufferManager::block_exists(const std::string &block_id)
+void BufferManager::latch_block(PageId block_id, bool exclusive)
 {
-    // Check if the block exists in cache
-    auto it = cache.find(block_id);
+    // mapped blocks do not change
+    if (storage->is_read_only())
+        return;
+
+    Frame* frame = find_frame(block_id);
+
+    if (frame == nullptr || frame->reference_count == 0)
+        throw std::invalid_argument("Cannot latch block that is not fixed.");
+
+    if (exclusive)
+        frame->latch.lock();
+    else
+        frame->latch.lock_shared();
+}
+
+void BufferManager::unlatch_block(PageId block_id, bool exclusive)
+{
+    if (storage->is_read_only())
+        return;
+
+    Frame* frame = find_frame(block_id);
+
+    if (frame == nullptr)
+        throw std::invalid_argument("Cannot unlatch block that is not in cache.");
+
+    if (exclusive)
+        frame->latch.unlock();
+    else
+        frame->latch.unlock_shared();
+}
 
-    if (it != cache.end())
+bool BufferManager::block_exists(PageId block_id)
+{
+    // Check if the block exists in cache
+    if (find_frame(block_id) != nullptr)
         return true;
 
-    // Otherwise, check if it exists on disk
-    return std::filesystem::exists(Block::BLOCK_DIR + block_id);
+    // Otherwise, check if it exists on disk (a new block may have been evicted while the writer writes it)
+    wait_for_write(block_id);
+    return storage->page_exists(block_id);
 }
 
-std::string BufferManager::create_new_block()
+bool BufferManager::is_cached(PageId block_id)
 {
-    std::shared_ptr<Block> block = fix_block(BLOCK_ID);
+    return find_frame(block_id) != nullptr;
+}
 
-    if (block == nullptr)
-        throw std::runtime_error("Cannot load buffer manager block: " + BLOCK_ID);
+PageId BufferManager::create_new_block()
+{
+    if (storage->is_read_only())
+        throw std::runtime_error("Cannot create block in read-only database.");
 
-    // get number of existing blocks
-    int n_blocks = block->get_record(Block::create_record_id(BLOCK_ID, 0))->get_integer_attribute(1);
+    std::lock_guard<std::mutex> lock(sync->allocation);
 
-    // increment and save new amount
-    std::shared_ptr<Record> record = std::make_shared<Record>(Record(Block::create_record_id(BLOCK_ID, 0), {(int) ++n_blocks}));
+    // reuse erased blocks first, the saved free list may contain blocks that were reused before a crash
+    while (!free_blocks.empty())
+    {
+        PageId block_id = free_blocks.back();
+        free_blocks.pop_back();
+        free_blocks_changed = true;
 
-    if (!block->update_record(record))
-        throw std::runtime_error("Cannot save amount of blocks in: " + BLOCK_ID);
+        if (!block_exists(block_id))
+            return block_id;
+    }
 
-    unfix_block(BLOCK_ID);
-    return Block::create_block_id(n_blocks);
+    return reserve_block_id();
 }
 
-bool BufferManager::erase_block(std::string const& block_id)
+bool BufferManager::erase_block(PageId block_id)
 {
+    if (storage->is_read_only())
+        throw std::runtime_error("Cannot erase block in read-only database.");
+
+    if (block_id == BLOCK_ID)
+        throw std::invalid_argument("Cannot erase buffer manager block: " + std::to_string(BLOCK_ID));
+
     // Check if the block is in cache
-    auto it = cache.find(block_id);
+    bool cached = false;
+
+    {
+        std::unique_lock<std::mutex> lock(sync->policy);
+        Frame* frame = find_frame(block_id);
+
+        // an eviction that writes the block holds a fix, the block leaves the cache or is unfixed afterwards
+        while (frame != nullptr && frame->evicting && frame->reference_count == 1)
+        {
+            sync->eviction_done.wait(lock);
+            frame = find_frame(block_id);
+        }
+
+        if (frame != nullptr)
+        {
+            if (frame->reference_count > 0)
+                throw std::runtime_error("Cannot delete fixed block.");
 
-    if (it != cache.end())
+            // Remove from the cache (no need to write it back)
+            policy->on_erase(block_id);
+            remove_frame(block_id);
+            n_frames--;
+            cached = true;
+
+            if (sync->tracing)
+                add_trace_entry(ReplacementPolicy::TraceEntry::Access::ERASE, block_id);
+        }
+    }
+
+    // the id may be handed out for another kind of block
     {
-        if (it->second.reference_count > 0)
-            throw std::runtime_error("Cannot delete fixed block.");
+        Shard& shard = get_shard(block_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.page_types.erase(block_id);
+    }
+
+    // Drop a running read of the block
+    {
+        std::lock_guard<std::mutex> lock(sync->prefetch);
+
+        if (prefetched.erase(block_id) > 0)
+            storage->cancel_page(block_id);
+    }
+
+    std::lock_guard<std::mutex> lock(sync->allocation);
 
-        // Write block if new/dirty
-        if (it->second.block->is_dirty())
-            it->second.block->write_data();
+    if (block_id == overflow_block_id)
+        overflow_block_id = INVALID_PAGE_ID;
 
-        // Remove from the cache
-        cache.erase(block_id);
+    // the erase is not buffered, so its log record has to be durable first (redone erases are logged already)
+    if (log && !recovering && !log->flush(log->append(LogManager::Type::ERASE_BLOCK, block_id, 0, nullptr, 0)))
+        return false;
 
-        // Check if the block is in unfixed list
-        auto it = std::find(unfixed_blocks.begin(), unfixed_blocks.end(), block_id);
+    // delete the block, after a write of the writer that would bring it back
+    wait_for_write(block_id);
+    bool erased = storage->erase_page(block_id) || cached;
 
-        // Remove from the unfixed list
-        if (it != unfixed_blocks.end())
-            unfixed_blocks.erase(it);
+    // hand out the id again (recovery loads the free list afterwards)
+    if (erased && !recovering)
+    {
+        free_blocks.push_back(block_id);
+        free_blocks_changed = true;
     }
 
-    // delete the block
-    return std::remove((Block::BLOCK_DIR + block_id).c_str()) == 0;
-}
\ No newline at end of file
+    return erased;
+}
+
+bool BufferManager::flush()
+{
+    // blocks the background writer marked as written are synced as well
+    std::lock_guard<std::mutex> writer_lock(sync->writer);
+    bool success = true;
+
+    // give back the reserved ids that were not handed out, a crash only loses the ids of one batch
+    {
+        std::lock_guard<std::mutex> lock(sync->allocation);
+        success = save_free_blocks() && (storage->is_read_only() || next_block_id > reserved_block_id ||
+                                         save_last_block_id(next_block_id - 1));
+    }
+
+    // written changes are committed, so that recovery does not undo them
+    if (log)
+        log->commit();
+
+    // the shared latch waits for threads that change the block
+    for (auto& [block_id, frame] : get_frames())
+    {
+        std::shared_lock<std::shared_mutex> latch(frame->latch);
+
+        if (frame->block == nullptr || !frame->block->is_dirty())
+            continue;
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (frame->block->write_data())
+            count_write({frame->page_type}, std::chrono::steady_clock::now() - start);
+        else
+            success = false;
+    }
+
+    return storage->sync() && success;
+}
+
+bool BufferManager::commit()
+{
+    if (!log)
+        return flush();
+
+    bool success = true;
+
+    {
+        std::lock_guard<std::mutex> lock(sync->allocation);
+        success = save_free_blocks();
+    }
+
+    log->commit();
+
+    // pages whose changes are not logged are made durable themselves
+    for (auto& [block_id, frame] : get_frames())
+    {
+        std::shared_lock<std::shared_mutex> latch(frame->latch);
+
+        if (frame->block == nullptr || frame->block->is_slotted() || !frame->block->is_dirty())
+            continue;
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (frame->block->write_data()) {
+            count_write({frame->page_type}, std::chrono::steady_clock::now() - start);
+            sync->unlogged_writes = true;
+        } else {
+            success = false;
+        }
+    }
+
+    // also the ones that evictions and the writer wrote, after the writes of the writer finished
+    if (sync->unlogged_writes.exchange(false))
+    {
+        std::lock_guard<std::mutex> writer_lock(sync->writer);
+        success = storage->sync() && success;
+    }
+
+    return success;
+}
+
+uint64_t BufferManager::checkpoint()
+{
+    if (!log)
+        throw std::runtime_error("Cannot checkpoint without a log.");
+
+    // the background writer marks blocks as written before it writes them, its writes have to be synced as well
+    std::lock_guard<std::mutex> writer_lock(sync->writer);
+
+    // the erased ids since the last commit are kept by recovery
+    {
+        std::lock_guard<std::mutex> lock(sync->allocation);
+
+        if (!save_free_blocks())
+            throw std::runtime_error("Cannot save free blocks for checkpoint.");
+    }
+
+    // changes before this LSN are either in the written pages or in the dirty page table, recovery redoes all later ones
+    uint64_t begin_lsn = log->get_end_lsn();
+
+    // dirty page table: page id and LSN of its first change that is not written yet
+    std::vector<uint64_t> data = {begin_lsn};
+
+    for (auto& [block_id, frame] : get_frames())
+    {
+        std::shared_lock<std::shared_mutex> latch(frame->latch);
+
+        if (frame->block != nullptr && frame->block->get_recovery_lsn() != 0)
+        {
+            data.push_back(block_id);
+            data.push_back(frame->block->get_recovery_lsn());
+        }
+    }
+
+    // pages that were clean in the scan have to be durable before the checkpoint record is, dirty pages stay in the cache
+    if (!storage->sync())
+        throw std::runtime_error("Cannot sync pages for checkpoint.");
+
+    return log->checkpoint(data.data(), data.size() * sizeof(uint64_t));
+}
+
+int BufferManager::get_free_block_count()
+{
+    std::lock_guard<std::mutex> lock(sync->allocation);
+    return free_blocks.size();
+}
+
+int BufferManager::get_recovered_records()
+{
+    return n_recovered_records;
+}
+
+int BufferManager::get_block_size()
+{
+    return storage->get_page_size();
+}
+
+int BufferManager::get_frame_count()
+{
+    return n_blocks;
+}
+
+void BufferManager::set_page_type(PageId block_id, PageType type)
+{
+    Shard& shard = get_shard(block_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (type == PageType::TABLE)
+        shard.page_types.erase(block_id);
+    else
+        shard.page_types[block_id] = type;
+
+    auto it = shard.frames.find(block_id);
+
+    if (it != shard.frames.end())
+        it->second->page_type = type;
+}
+
+BufferManager::Statistics BufferManager::get_statistics()
+{
+    Statistics statistics;
+
+    {
+        std::lock_guard<std::mutex> lock(sync->statistics);
+        statistics = sync->io_statistics;
+    }
+
+    for (Shard& shard : sync->shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (int type = 0; type < N_PAGE_TYPES; type++)
+        {
+            statistics.counters[type].hits += shard.counters[type].hits;
+            statistics.counters[type].misses += shard.counters[type].misses;
+        }
+
+        for (auto& [block_id, frame] : shard.frames)
+        {
+            statistics.n_cached_frames++;
+
+            if (frame->reference_count > 0)
+                statistics.n_pinned_frames++;
+        }
+    }
+
+    return statistics;
+}
+
+void BufferManager::reset_statistics()
+{
+    {
+        std::lock_guard<std::mutex> lock(sync->statistics);
+        sync->io_statistics = Statistics();
+    }
+
+    for (Shard& shard : sync->shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (Statistics::Counters& counters : shard.counters)
+            counters = Statistics::Counters();
+    }
+}
+
+BufferManager::Statistics::Counters const& BufferManager::Statistics::get_counters(PageType type) const
+{
+    return counters[(int) type];
+}
+
+BufferManager::Statistics::Counters BufferManager::Statistics::get_total() const
+{
+    Counters total = Counters();
+
+    for (Counters const& type_counters : counters)
+    {
+        total.hits += type_counters.hits;
+        total.misses += type_counters.misses;
+        total.evictions += type_counters.evictions;
+        total.dirty_writes += type_counters.dirty_writes;
+    }
+
+    return total;
+}
+
+double BufferManager::Statistics::get_hit_ratio() const
+{
+    Counters total = get_total();
+    uint64_t n_fixes = total.hits + total.misses;
+    return n_fixes > 0 ? (double) total.hits / n_fixes : 0;
+}
+
+double BufferManager::Statistics::get_average_read_us() const
+{
+    return n_reads > 0 ? read_time_ns / 1000.0 / n_reads : 0;
+}
+
+double BufferManager::Statistics::get_average_write_us() const
+{
+    return n_writes > 0 ? write_time_ns / 1000.0 / n_writes : 0;
+}
+
+thread_local BufferManager::Statistics* BufferManager::scope_statistics = nullptr;
+
+BufferManager::StatisticsScope::StatisticsScope(Statistics& statistics) : previous(scope_statistics)
+{
+    scope_statistics = &statistics;
+}
+
+BufferManager::StatisticsScope::~StatisticsScope()
+{
+    scope_statistics = previous;
+}
+
+void BufferManager::start_writer(double dirty_ratio, std::chrono::milliseconds max_age)
+{
+    if (storage->is_read_only())
+        throw std::runtime_error("Cannot write blocks of a read-only database.");
+
+    if (dirty_ratio < 0 || dirty_ratio > 1)
+        throw std::invalid_argument("Dirty ratio must be between 0 and 1: " + std::to_string(dirty_ratio));
+
+    stop_writer();
+
+    this->dirty_ratio = dirty_ratio;
+    this->max_dirty_age = max_age;
+
+    sync->writer_stopped = false;
+    sync->writer_thread = std::thread(&BufferManager::run_writer, this);
+}
+
+void BufferManager::stop_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock(sync->writer_state);
+        sync->writer_stopped = true;
+    }
+
+    sync->writer_wakeup.notify_one();
+
+    if (sync->writer_thread.joinable())
+        sync->writer_thread.join();
+}
+
+uint64_t BufferManager::get_written_block_count()
+{
+    return sync->n_written_blocks;
+}
+
+void BufferManager::run_writer()
+{
+    std::unordered_map<PageId, std::chrono::steady_clock::time_point> dirty_since;
+    std::unique_lock<std::mutex> lock(sync->writer_state);
+
+    while (!sync->writer_stopped)
+    {
+        sync->writer_wakeup.wait_for(lock, WRITER_INTERVAL);
+
+        if (sync->writer_stopped)
+            break;
+
+        lock.unlock();
+        write_dirty_blocks(dirty_since);
+        lock.lock();
+    }
+}
+
+void BufferManager::write_dirty_blocks(std::unordered_map<PageId, std::chrono::steady_clock::time_point>& dirty_since)
+{
+    std::lock_guard<std::mutex> writer_lock(sync->writer);
+    auto now = std::chrono::steady_clock::now();
+
+    // dirty blocks without fixes, they do not change while the policy mutex is held
+    std::vector<std::pair<std::chrono::steady_clock::time_point, PageId>> candidates;
+    uint64_t page_lsn = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(sync->policy);
+        std::unordered_map<PageId, std::chrono::steady_clock::time_point> still_dirty;
+
+        for (auto& [block_id, frame] : get_frames())
+        {
+            if (!frame->loaded || frame->reference_count > 0 || !frame->block->is_dirty())
+                continue;
+
+            auto it = dirty_since.find(block_id);
+            std::chrono::steady_clock::time_point since = it != dirty_since.end() ? it->second : now;
+
+            still_dirty[block_id] = since;
+            candidates.emplace_back(since, block_id);
+            page_lsn = std::max(page_lsn, frame->block->get_page_lsn());
+        }
+
+        dirty_since.swap(still_dirty);
+    }
+
+    // the oldest blocks above the ratio and all old blocks
+    std::sort(candidates.begin(), candidates.end());
+    size_t max_dirty = (size_t) (dirty_ratio * n_blocks);
+    size_t n_chosen = candidates.size() > max_dirty ? candidates.size() - max_dirty / 2 : 0;
+
+    while (n_chosen < candidates.size() && now - candidates.at(n_chosen).first >= max_dirty_age)
+        n_chosen++;
+
+    if (n_chosen == 0)
+        return;
+
+    std::vector<PageId> block_ids;
+
+    for (size_t i = 0; i < n_chosen; i++)
+        block_ids.push_back(candidates.at(i).second);
+
+    std::sort(block_ids.begin(), block_ids.end());
+
+    // write-ahead rule, once for all blocks
+    if (log && !log->flush(page_lsn))
+        return;
+
+    std::unique_lock<std::mutex> policy_lock(sync->policy);
+    std::vector<std::pair<PageId, std::shared_ptr<void>>> pages;
+    std::vector<PageType> page_types;
+
+    for (PageId block_id : block_ids)
+    {
+        // the block may have been fixed, changed or evicted in the meantime
+        Frame* frame = find_frame(block_id);
+
+        if (frame == nullptr || frame->reference_count > 0 || !frame->block->is_dirty() ||
+            (log && frame->block->get_page_lsn() >= log->get_flushed_lsn()))
+            continue;
+
+        if (!frame->block->is_slotted())
+            sync->unlogged_writes = true;
+
+        pages.emplace_back(block_id, frame->block->copy_data_for_write());
+        page_types.push_back(frame->page_type);
+        dirty_since.erase(block_id);
+    }
+
+    // the blocks are clean now, they may be evicted and read again (or written by evictions) after the write
+    {
+        std::lock_guard<std::mutex> lock(sync->write_state);
+
+        for (auto& [block_id, page] : pages)
+            sync->pages_in_write.insert(block_id);
+    }
+
+    policy_lock.unlock();
+
+    // neighbouring pages with one write
+    for (size_t first = 0; first < pages.size();)
+    {
+        std::vector<void const*> buffers = {pages.at(first).second.get()};
+        size_t next = first + 1;
+
+        while (next < pages.size() && pages.at(next).first == pages.at(next - 1).first + 1)
+            buffers.push_back(pages.at(next++).second.get());
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (storage->write_pages(pages.at(first).first, buffers)) {
+            count_write(std::vector<PageType>(page_types.begin() + first, page_types.begin() + next),
+                        std::chrono::steady_clock::now() - start);
+            sync->n_written_blocks += buffers.size();
+        }
+
+        first = next;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sync->write_state);
+
+        for (auto& [block_id, page] : pages)
+            sync->pages_in_write.erase(block_id);
+    }
+
+    sync->write_done.notify_all();
+}
+
+void BufferManager::start_trace()
+{
+    std::lock_guard<std::mutex> lock(sync->trace);
+    trace.clear();
+    sync->tracing = true;
+}
+
+std::vector<ReplacementPolicy::TraceEntry> BufferManager::stop_trace()
+{
+    std::lock_guard<std::mutex> lock(sync->trace);
+    sync->tracing = false;
+
+    std::vector<ReplacementPolicy::TraceEntry> result;
+    result.swap(trace);
+    return result;
+}
+
+std::shared_ptr<Record> BufferManager::get_record(RecordId record_id)
+{
+    PageId block_id = Block::get_block_id(record_id);
+    std::shared_ptr<Block> block = fix_block(block_id);
+
+    std::shared_ptr<Record> record = block->get_record(record_id);
+    std::optional<RecordId> forward = block->get_forward(record_id);
+    unfix_block(block_id);
+
+    if (!forward.has_value())
+        return record;
+
+    // read the record at its new location
+    PageId target_block_id = Block::get_block_id(forward.value());
+    std::shared_ptr<Block> target_block = fix_block(target_block_id);
+
+    record = target_block->get_record(forward.value());
+    unfix_block(target_block_id);
+
+    return record;
+}
+
+bool BufferManager::update_record(std::shared_ptr<Record> const& record)
+{
+    RecordId record_id = record->get_record_id();
+    PageId block_id = Block::get_block_id(record_id);
+    std::shared_ptr<Block> block = fix_block(block_id);
+
+    std::optional<RecordId> forward = block->get_forward(record_id);
+    bool success = false;
+
+    if (!forward.has_value())
+    {
+        // update in its block (compacting it if needed), otherwise move it and leave a forwarding stub
+        success = block->update_record(record);
+
+        if (!success && block->get_record_view(record_id).has_value())
+        {
+            std::optional<RecordId> location = relocate_record(record);
+            success = location.has_value() && block->set_forward(record_id, location.value());
+        }
+    } else
+    {
+        PageId target_block_id = Block::get_block_id(forward.value());
+        std::shared_ptr<Block> target_block = fix_block(target_block_id);
+
+        success = target_block->update_record(record, forward.value());
+
+        // move it again and point the stub to the new location, so forwarding chains never grow
+        if (!success)
+        {
+            std::optional<RecordId> location = relocate_record(record);
+
+            if (location.has_value())
+            {
+                target_block->delete_record(forward.value());
+                success = block->set_forward(record_id, location.value());
+            }
+        }
+
+        unfix_block(target_block_id);
+    }
+
+    unfix_block(block_id);
+    return success;
+}
+
+bool BufferManager::delete_record(RecordId record_id)
+{
+    PageId block_id = Block::get_block_id(record_id);
+    std::shared_ptr<Block> block = fix_block(block_id);
+
+    std::optional<RecordId> forward = block->get_forward(record_id);
+
+    // delete the moved record as well
+    if (forward.has_value())
+    {
+        PageId target_block_id = Block::get_block_id(forward.value());
+        std::shared_ptr<Block> target_block = fix_block(target_block_id);
+
+        target_block->delete_record(forward.value());
+        unfix_block(target_block_id);
+    }
+
+    bool success = block->delete_record(record_id);
+    unfix_block(block_id);
+
+    return success;
+}
+
+std::optional<RecordId> BufferManager::relocate_record(std::shared_ptr<Record> const& record)
+{
+    // try the current overflow block first, then a new one
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        PageId block_id = INVALID_PAGE_ID;
+
+        {
+            std::lock_guard<std::mutex> lock(sync->allocation);
+            block_id = overflow_block_id;
+        }
+
+        if (block_id == INVALID_PAGE_ID || attempt > 0)
+        {
+            block_id = create_new_block();
+
+            std::lock_guard<std::mutex> lock(sync->allocation);
+            overflow_block_id = block_id;
+        }
+
+        std::shared_ptr<Block> block = fix_block(block_id);
+        latch_block(block_id, true);
+        std::optional<RecordId> location = block->add_relocated_record(record);
+        unlatch_block(block_id, true);
+        unfix_block(block_id);
+
+        if (location.has_value())
+            return location;
+    }
+
+    // record does not fit into an empty block
+    return std::nullopt;
+}
+
+std::shared_ptr<Block> BufferManager::fix_mapped_block(PageId block_id)
+{
+    // mapped blocks are views of the mapping and take no frames, so the page table does not grow with the database
+    void const* page = storage->get_mapped_page(block_id);
+
+    if (page == nullptr)
+        return nullptr;
+
+    // the block does not own the page, the mapping lives as long as the storage
+    std::shared_ptr<void> data(const_cast<void*>(page), [](void*) {});
+    return std::make_shared<Block>(storage, block_id, data);
+}
+
+void BufferManager::recover()
+{
+    // read the dirty page table of the last checkpoint, without one the whole log is redone
+    uint64_t checkpoint_lsn = log->get_checkpoint_lsn();
+    uint64_t begin_lsn = 0;
+    uint64_t redo_lsn = LogManager::FIRST_LSN;
+    std::unordered_map<PageId, uint64_t> dirty_pages;
+
+    if (checkpoint_lsn != 0)
+    {
+        std::vector<LogManager::LogRecord> checkpoint = log->read_records(checkpoint_lsn);
+
+        if (checkpoint.empty() || checkpoint.front().type != LogManager::Type::CHECKPOINT)
+            throw std::runtime_error("Cannot read checkpoint: " + std::to_string(checkpoint_lsn));
+
+        std::vector<uint64_t> data(checkpoint.front().data.size() / sizeof(uint64_t));
+        std::memcpy(data.data(), checkpoint.front().data.data(), data.size() * sizeof(uint64_t));
+        begin_lsn = data.at(0);
+        redo_lsn = begin_lsn;
+
+        for (size_t i = 1; i + 1 < data.size(); i += 2)
+        {
+            dirty_pages[data.at(i)] = data.at(i + 1);
+            redo_lsn = std::min(redo_lsn, data.at(i + 1));
+        }
+    }
+
+    recovering = true;
+
+    // redo: repeat all changes the written pages do not contain
+    for (LogManager::LogRecord const& log_record : log->read_records(redo_lsn))
+    {
+        if (log_record.type == LogManager::Type::COMMIT || log_record.type == LogManager::Type::CHECKPOINT)
+            continue;
+
+        // pages that were clean in the dirty page table scan contain all changes before it began, later
+        // changes may have happened before the checkpoint record was appended
+        if (log_record.lsn < begin_lsn)
+        {
+            auto it = dirty_pages.find(log_record.page_id);
+
+            if (it == dirty_pages.end() || log_record.lsn < it->second)
+                continue;
+        }
+
+        if (log_record.type == LogManager::Type::ERASE_BLOCK)
+        {
+            erase_block(log_record.page_id);
+        } else
+        {
+            std::shared_ptr<Block> block = fix_block(log_record.page_id);
+            block->redo(log_record);
+            unfix_block(log_record.page_id);
+        }
+
+        n_recovered_records++;
+    }
+
+    recovering = false;
+
+    // the blocks of the free block list are known after the redo
+    if (block_exists(BLOCK_ID))
+        load_free_blocks();
+
+    // Undo: revert the changes after the last commit, newest first. Erases cannot be reverted, erased pages stay
+    // erased, and so the ids in the meta block and the free block list are not reverted either.
+    std::vector<LogManager::LogRecord> uncommitted = log->read_records(log->get_commit_lsn());
+
+    for (auto it = uncommitted.rbegin(); it != uncommitted.rend(); it++)
+    {
+        if (it->type == LogManager::Type::COMMIT || it->type == LogManager::Type::CHECKPOINT ||
+            it->type == LogManager::Type::ERASE_BLOCK || !block_exists(it->page_id) || it->page_id == BLOCK_ID ||
+            std::find(free_list_block_ids.begin(), free_list_block_ids.end(), it->page_id) != free_list_block_ids.end())
+            continue;
+
+        std::shared_ptr<Block> block = fix_block(it->page_id);
+        block->undo(*it);
+        unfix_block(it->page_id);
+
+        n_recovered_records++;
+    }
+
+    // the next recovery starts after this one
+    if (n_recovered_records > 0)
+    {
+        log->commit();
+        checkpoint();
+    }
+}
+
+void BufferManager::load_free_blocks()
+{
+    std::shared_ptr<Block> block = fix_block(BLOCK_ID);
+
+    std::optional<RecordView> last_block_id = block->get_record_view(Block::create_record_id(BLOCK_ID, 0));
+
+    if (!last_block_id.has_value())
+        throw std::runtime_error("Cannot load last block id in: " + std::to_string(BLOCK_ID));
+
+    // ids after the last saved one were never handed out
+    reserved_block_id = last_block_id->get_id_attribute(1);
+    next_block_id = reserved_block_id + 1;
+    unfix_block(BLOCK_ID);
+
+    free_blocks.clear();
+    free_list_block_ids.clear();
+
+    // The other records of the meta block list the erased blocks, starting with their number. A record with only
+    // one id links the next block of the list.
+    PageId block_id = BLOCK_ID;
+
+    while (block_id != INVALID_PAGE_ID)
+    {
+        block = fix_block(block_id);
+        PageId next_list_block_id = INVALID_PAGE_ID;
+
+        for (int slot = block_id == BLOCK_ID ? 1 : 0; slot < block->get_slot_count(); slot++)
+        {
+            std::optional<RecordView> view = block->get_record_view(Block::create_record_id(block_id, slot));
+
+            if (!view.has_value())
+                continue;
+
+            if (view->get_attribute_count() == 1)
+            {
+                next_list_block_id = view->get_id_attribute(1);
+                continue;
+            }
+
+            uint64_t n_free_blocks = view->get_id_attribute(1);
+
+            for (uint64_t i = 0; i < n_free_blocks; i++)
+                free_blocks.push_back(view->get_id_attribute(i + 2));
+        }
+
+        unfix_block(block_id);
+
+        if (next_list_block_id != INVALID_PAGE_ID)
+            free_list_block_ids.push_back(next_list_block_id);
+
+        block_id = next_list_block_id;
+    }
+}
+
+bool BufferManager::save_free_blocks()
+{
+    if (storage->is_read_only() || !free_blocks_changed)
+        return true;
+
+    // ids that do not fit into the meta block continue in the blocks of the list, which are kept when it shrinks
+    PageId block_id = BLOCK_ID;
+    size_t n_saved = 0;
+
+    for (size_t i = 0; block_id != INVALID_PAGE_ID; i++)
+    {
+        std::shared_ptr<Block> block = fix_block(block_id);
+
+        for (int slot = block->get_slot_count() - 1; slot >= (block_id == BLOCK_ID ? 1 : 0); slot--)
+            block->delete_record(Block::create_record_id(block_id, slot));
+
+        PageId next_list_block_id = i < free_list_block_ids.size() ? free_list_block_ids.at(i) : INVALID_PAGE_ID;
+
+        if (next_list_block_id != INVALID_PAGE_ID && block->add_record({(uint64_t) next_list_block_id}) == nullptr)
+            throw std::runtime_error("Cannot link free block list in: " + std::to_string(block_id));
+
+        std::shared_ptr<Record> last_record = nullptr;
+        size_t last_start = n_saved;
+
+        while (n_saved < free_blocks.size())
+        {
+            size_t end = std::min(n_saved + FREE_BLOCKS_PER_RECORD, free_blocks.size());
+            std::vector<Record::Attribute> attributes = {(uint64_t) (end - n_saved)};
+
+            for (size_t k = n_saved; k < end; k++)
+                attributes.push_back((uint64_t) free_blocks.at(k));
+
+            std::shared_ptr<Record> record = block->add_record(attributes);
+
+            if (record == nullptr)
+                break;
+
+            last_record = record;
+            last_start = n_saved;
+            n_saved = end;
+        }
+
+        // the last block is full, a new block continues the list and its link replaces the last ids
+        if (n_saved < free_blocks.size() && next_list_block_id == INVALID_PAGE_ID)
+        {
+            if (last_record == nullptr)
+                throw std::runtime_error("Cannot save free blocks in: " + std::to_string(block_id));
+
+            next_list_block_id = reserve_block_id();
+            free_list_block_ids.push_back(next_list_block_id);
+
+            block->delete_record(last_record->get_record_id());
+            n_saved = last_start;
+
+            if (block->add_record({(uint64_t) next_list_block_id}) == nullptr)
+                throw std::runtime_error("Cannot link free block list in: " + std::to_string(block_id));
+        }
+
+        unfix_block(block_id);
+        block_id = next_list_block_id;
+    }
+
+    free_blocks_changed = false;
+
+    return true;
+}
+
+PageId BufferManager::reserve_block_id()
+{
+    // reserve a batch of new ids, so that the meta block only changes once per batch
+    if (next_block_id > reserved_block_id && !save_last_block_id(reserved_block_id + ALLOCATION_BATCH))
+        throw std::runtime_error("Cannot save last block id in: " + std::to_string(BLOCK_ID));
+
+    return next_block_id++;
+}
+
+bool BufferManager::save_last_block_id(PageId last_block_id)
+{
+    std::shared_ptr<Block> block = fix_block(BLOCK_ID);
+
+    std::shared_ptr<Record> record = std::make_shared<Record>(Record(Block::create_record_id(BLOCK_ID, 0), {(uint64_t) last_block_id}));
+    bool success = block->update_record(record);
+
+    unfix_block(BLOCK_ID);
+
+    if (success)
+        reserved_block_id = last_block_id;
+
+    return success;
+}
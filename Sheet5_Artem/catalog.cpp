@@ -0,0 +1,356 @@
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <variant>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <optional>
+#include <cctype>
+#include <unordered_set>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "header/filesystem.h"
+#include "header/identifiers.h"
+#include "header/record.h"
+#include "header/schema.h"
+#include "header/buffer_manager.h"
+#include "header/bptree.h"
+#include "header/execution.h"
+#include "header/catalog.h"
+
+std::string const Catalog::CATALOG_FILE = "catalog";
+
+// Replaces the file at once, a crash leaves either the old or the new content. The new file is synced before the
+// rename, so it cannot be torn, and the directory after it, so that the rename survives a crash.
+static bool write_file(std::string const& path, std::string const& content)
+{
+    int file = open((path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (file < 0)
+        return false;
+
+    bool success = write(file, content.data(), content.size()) == (ssize_t) content.size() && fsync(file) == 0;
+    close(file);
+
+    if (!success)
+        return false;
+
+    std::error_code error;
+    std::filesystem::rename(path + ".tmp", path, error);
+
+    if (error)
+        return false;
+
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int dir = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (dir < 0)
+        return false;
+
+    success = fsync(dir) == 0;
+    close(dir);
+    return success;
+}
+
+Catalog::Catalog(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& directory)
+    : buffer_manager(buffer_manager), directory(directory)
+{
+    load();
+}
+
+void Catalog::create_table(std::string const& table_name, std::vector<std::string> const& column_names,
+                           std::vector<std::string> const& column_types)
+{
+    check_name(table_name);
+
+    if (has_table(table_name))
+        throw std::invalid_argument("Table already exists: " + table_name);
+
+    if (column_names.size() != column_types.size())
+        throw std::invalid_argument("Cannot create table with " + std::to_string(column_names.size()) + " columns and " + std::to_string(column_types.size()) + " types");
+
+    for (size_t i = 0; i < column_names.size(); i++)
+    {
+        check_name(column_names.at(i));
+
+        if (std::find(column_names.begin(), column_names.begin() + i, column_names.at(i)) != column_names.begin() + i)
+            throw std::invalid_argument("Duplicate column: " + column_names.at(i));
+    }
+
+    tables[table_name] = {column_names, std::make_shared<Schema>(column_types), {}, {}};
+
+    if (!save())
+        throw std::runtime_error("Cannot write catalog: " + directory + CATALOG_FILE);
+}
+
+bool Catalog::drop_table(std::string const& table_name)
+{
+    auto it = tables.find(table_name);
+
+    if (it == tables.end())
+        return false;
+
+    bool result = true;
+
+    for (Index const& index : it->second.indexes)
+        result = index.bptree->erase() && result;
+
+    for (PageId block_id : it->second.block_ids)
+        result = buffer_manager->erase_block(block_id) && result;
+
+    tables.erase(it);
+    return save() && result;
+}
+
+bool Catalog::has_table(std::string const& table_name)
+{
+    return tables.find(table_name) != tables.end();
+}
+
+std::vector<std::string> Catalog::get_table_names()
+{
+    std::vector<std::string> table_names;
+
+    for (auto const& [table_name, table] : tables)
+        table_names.push_back(table_name);
+
+    return table_names;
+}
+
+std::shared_ptr<Schema> Catalog::get_schema(std::string const& table_name)
+{
+    return get_table(table_name).schema;
+}
+
+std::vector<std::string> const& Catalog::get_column_names(std::string const& table_name)
+{
+    return get_table(table_name).column_names;
+}
+
+int Catalog::get_column_position(std::string const& table_name, std::string const& column_name)
+{
+    std::vector<std::string> const& column_names = get_table(table_name).column_names;
+    auto it = std::find(column_names.begin(), column_names.end(), column_name);
+
+    if (it == column_names.end())
+        throw std::invalid_argument("Unknown column of table " + table_name + ": " + column_name);
+
+    return it - column_names.begin() + 1;
+}
+
+Schema::Type Catalog::get_column_type(std::string const& table_name, std::string const& column_name)
+{
+    return get_table(table_name).schema->get_type(get_column_position(table_name, column_name));
+}
+
+std::vector<PageId> const& Catalog::get_block_ids(std::string const& table_name)
+{
+    return get_table(table_name).block_ids;
+}
+
+std::vector<RecordId> Catalog::append(std::string const& table_name, std::vector<std::vector<Record::Attribute>> const& tuples)
+{
+    TableEntry& table = get_table(table_name);
+
+    // the indexes only take unique keys, check them before the tuples are stored
+    for (Index const& index : table.indexes)
+    {
+        std::unordered_set<int> keys;
+
+        for (std::vector<Record::Attribute> const& tuple : tuples)
+        {
+            int key = std::get<int>(tuple.at(index.column_position - 1));
+
+            if (!keys.insert(key).second || index.bptree->search_record(key).has_value())
+                throw std::invalid_argument("Duplicate key in index " + index.name + ": " + std::to_string(key));
+        }
+    }
+
+    TableAppender appender(buffer_manager, table.schema, table.block_ids);
+    std::vector<RecordId> record_ids = appender.append(tuples);
+    appender.close();
+    table.block_ids = appender.get_block_ids();
+
+    for (Index const& index : table.indexes)
+    {
+        for (size_t i = 0; i < tuples.size(); i++)
+            index.bptree->insert_record(std::get<int>(tuples.at(i).at(index.column_position - 1)), record_ids.at(i));
+    }
+
+    // new blocks and index roots
+    if (!save())
+        throw std::runtime_error("Cannot write catalog: " + directory + CATALOG_FILE);
+
+    return record_ids;
+}
+
+std::shared_ptr<Table> Catalog::scan(std::string const& table_name)
+{
+    TableEntry& table = get_table(table_name);
+    return std::make_shared<Table>(buffer_manager, table.block_ids, table.schema);
+}
+
+void Catalog::create_index(std::string const& table_name, std::string const& index_name, std::string const& column_name)
+{
+    check_name(index_name);
+    TableEntry& table = get_table(table_name);
+    int column_position = get_column_position(table_name, column_name);
+
+    if (table.schema->get_type(column_position) != Schema::Type::INTEGER)
+        throw std::invalid_argument("Cannot index column of type " + table.schema->get_attribute_types().at(column_position - 1) + ": " + column_name);
+
+    if (get_index(table_name, index_name) != nullptr)
+        throw std::invalid_argument("Index already exists: " + index_name);
+
+    std::shared_ptr<BPTree> bptree = std::make_shared<BPTree>(buffer_manager, buffer_manager->create_new_block());
+
+    // add the tuples that are already in the table
+    for (PageId block_id : table.block_ids)
+    {
+        std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
+
+        if (block == nullptr)
+            throw std::runtime_error("Cannot load table block: " + std::to_string(block_id));
+
+        std::vector<std::pair<int, RecordId>> keys;
+
+        for (int slot = 0; slot < block->get_slot_count(); slot++)
+        {
+            std::optional<TupleView> view = block->get_tuple_view(*table.schema, Block::create_record_id(block_id, slot));
+
+            if (view.has_value())
+                keys.push_back({view->get_integer_attribute(column_position), view->get_record_id()});
+        }
+
+        // the index may need other blocks of the buffer
+        buffer_manager->unfix_block(block_id);
+
+        for (auto const& [key, record_id] : keys)
+        {
+            if (bptree->search_record(key).has_value())
+            {
+                bptree->erase();
+                throw std::invalid_argument("Duplicate key in column " + column_name + ": " + std::to_string(key));
+            }
+
+            bptree->insert_record(key, record_id);
+        }
+    }
+
+    table.indexes.push_back({index_name, column_position, bptree});
+
+    if (!save())
+        throw std::runtime_error("Cannot write catalog: " + directory + CATALOG_FILE);
+}
+
+std::shared_ptr<BPTree> Catalog::get_index(std::string const& table_name, std::string const& index_name)
+{
+    for (Index const& index : get_table(table_name).indexes)
+    {
+        if (index.name == index_name)
+            return index.bptree;
+    }
+
+    return nullptr;
+}
+
+bool Catalog::save()
+{
+    std::string path = directory + CATALOG_FILE;
+    std::ostringstream file;
+    file << tables.size() << std::endl;
+
+    for (auto const& [table_name, table] : tables)
+    {
+        file << table_name << " " << table.column_names.size() << " " << table.block_ids.size() << " "
+             << table.indexes.size() << std::endl;
+
+        for (size_t i = 0; i < table.column_names.size(); i++)
+            file << table.column_names.at(i) << " " << table.schema->get_attribute_types().at(i) << std::endl;
+
+        for (PageId block_id : table.block_ids)
+            file << block_id << " ";
+
+        file << std::endl;
+
+        // roots change when the B+ trees grow
+        for (Index const& index : table.indexes)
+            file << index.name << " " << index.column_position << " " << index.bptree->get_root_node_id() << std::endl;
+    }
+
+    return write_file(path, file.str());
+}
+
+Catalog::TableEntry& Catalog::get_table(std::string const& table_name)
+{
+    auto it = tables.find(table_name);
+
+    if (it == tables.end())
+        throw std::invalid_argument("Unknown table: " + table_name);
+
+    return it->second;
+}
+
+void Catalog::load()
+{
+    std::ifstream file(directory + CATALOG_FILE);
+
+    // new database
+    if (!file)
+        return;
+
+    size_t n_tables = 0;
+    file >> n_tables;
+
+    for (size_t i = 0; i < n_tables && file; i++)
+    {
+        std::string table_name;
+        size_t n_columns = 0, n_blocks = 0, n_indexes = 0;
+        file >> table_name >> n_columns >> n_blocks >> n_indexes;
+
+        TableEntry table;
+        std::vector<std::string> column_types(n_columns);
+        table.column_names.resize(n_columns);
+
+        for (size_t k = 0; k < n_columns; k++)
+            file >> table.column_names.at(k) >> column_types.at(k);
+
+        table.block_ids.resize(n_blocks);
+
+        for (size_t k = 0; k < n_blocks; k++)
+            file >> table.block_ids.at(k);
+
+        for (size_t k = 0; k < n_indexes && file; k++)
+        {
+            Index index;
+            PageId root_node_id;
+            file >> index.name >> index.column_position >> root_node_id;
+
+            if (!file)
+                break;
+
+            index.bptree = std::make_shared<BPTree>(buffer_manager, root_node_id);
+            table.indexes.push_back(index);
+        }
+
+        if (!file)
+            break;
+
+        table.schema = std::make_shared<Schema>(column_types);
+        tables[table_name] = table;
+    }
+
+    if (!file)
+        throw std::runtime_error("Cannot read catalog: " + directory + CATALOG_FILE);
+}
+
+void Catalog::check_name(std::string const& name)
+{
+    if (name.empty() || std::any_of(name.begin(), name.end(), [](char c) {return std::isspace(static_cast<unsigned char>(c));}))
+        throw std::invalid_argument("Invalid name: \"" + name + "\"");
+}
@@ -2,21 +2,172 @@
 #include <string>
 #include <vector>
 #include <variant>
+#include <string_view>
 #include <cassert>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
 
+#include "header/identifiers.h"
 #include "header/record.h"
+#include "header/record_hash.h"
 #include "header/block.h"
 #include "header/buffer_manager.h"
+#include "header/page_guard.h"
 #include "header/execution.h"
 #include "header/bptree.h"
+#include "header/pax_block.h"
+#include "header/schema.h"
 
-Table::Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<std::string> const& block_ids)
-    : buffer_manager(buffer_manager), block_ids(block_ids), current_block(0), current_record(0) {}
+using Comparator = QueryOperator::Comparator;
+
+template <typename T>
+static bool compare_values(T const& left, T const& right, Comparator comparator)
+{
+    switch (comparator)
+    {
+        case Comparator::EQUAL:
+            return left == right;
+        case Comparator::NOT_EQUAL:
+            return left != right;
+        case Comparator::LESS:
+            return left < right;
+        case Comparator::LESS_EQUAL:
+            return left <= right;
+        case Comparator::GREATER:
+            return left > right;
+        case Comparator::GREATER_EQUAL:
+            return left >= right;
+    }
+
+    return false;
+}
+
+// Compares an attribute with a value in place, without copying strings out of the record
+template <typename View>
+static bool compare_attribute(View const& view, int position, Schema::Type attribute_type, Record::Attribute const& value,
+                              Comparator comparator)
+{
+    switch (attribute_type)
+    {
+        case Schema::Type::INTEGER:
+            return compare_values(view.get_integer_attribute(position), std::get<int>(value), comparator);
+        case Schema::Type::STRING:
+            return compare_values(view.get_string_attribute(position), std::string_view(std::get<std::string>(value)), comparator);
+        case Schema::Type::BOOLEAN:
+            return compare_values(view.get_boolean_attribute(position), std::get<bool>(value), comparator);
+        case Schema::Type::ID:
+            return compare_values(view.get_id_attribute(position), std::get<uint64_t>(value), comparator);
+    }
+
+    return false;
+}
+
+// Compares two attributes in place, without copying strings out of the records
+static bool compare_attributes(RecordView const& left, int left_position, RecordView const& right, int right_position,
+                               Schema::Type attribute_type, Comparator comparator)
+{
+    switch (attribute_type)
+    {
+        case Schema::Type::INTEGER:
+            return compare_values(left.get_integer_attribute(left_position), right.get_integer_attribute(right_position), comparator);
+        case Schema::Type::STRING:
+            return compare_values(left.get_string_attribute(left_position), right.get_string_attribute(right_position), comparator);
+        case Schema::Type::BOOLEAN:
+            return compare_values(left.get_boolean_attribute(left_position), right.get_boolean_attribute(right_position), comparator);
+        case Schema::Type::ID:
+            return compare_values(left.get_id_attribute(left_position), right.get_id_attribute(right_position), comparator);
+    }
+
+    return false;
+}
+
+// Copies an attribute of a record, e.g. into a projected or joined record
+static Record::Attribute get_attribute(RecordView const& view, int position, Schema::Type attribute_type)
+{
+    switch (attribute_type)
+    {
+        case Schema::Type::INTEGER:
+            return view.get_integer_attribute(position);
+        case Schema::Type::STRING:
+            return std::string(view.get_string_attribute(position));
+        case Schema::Type::BOOLEAN:
+            return view.get_boolean_attribute(position);
+        case Schema::Type::ID:
+            return view.get_id_attribute(position);
+    }
+
+    return false;
+}
+
+// Equal attributes without the record id, like the hashes of records
+static bool has_same_attributes(RecordView const& left, RecordView const& right)
+{
+    int n_attributes = left.get_attribute_count();
+
+    if (right.get_attribute_count() != n_attributes)
+        return false;
+
+    for (int position = 1; position <= n_attributes; position++)
+    {
+        if (left.get_attribute_bytes(position) != right.get_attribute_bytes(position))
+            return false;
+    }
+
+    return true;
+}
+
+// Join type lists start with "" for the record id, which is not copied
+static std::vector<Schema::Type> parse_join_types(std::vector<std::string> const& attribute_types)
+{
+    if (!attribute_types.empty() && attribute_types.front().empty())
+        return Schema::parse_types(std::vector<std::string>(attribute_types.begin() + 1, attribute_types.end()));
+
+    return Schema::parse_types(attribute_types);
+}
+
+QueryOperator::Comparator QueryOperator::parse_comparator(std::string const& comparator)
+{
+    if (comparator == "==")
+        return Comparator::EQUAL;
+    else if (comparator == "!=")
+        return Comparator::NOT_EQUAL;
+    else if (comparator == "<")
+        return Comparator::LESS;
+    else if (comparator == "<=")
+        return Comparator::LESS_EQUAL;
+    else if (comparator == ">")
+        return Comparator::GREATER;
+    else if (comparator == ">=")
+        return Comparator::GREATER_EQUAL;
+
+    throw std::invalid_argument("Unknown comparator: " + comparator);
+}
+
+Table::Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<PageId> const& block_ids)
+    : Table(buffer_manager, block_ids, nullptr) {}
+
+Table::Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<PageId> const& block_ids,
+             std::shared_ptr<Schema> const& schema)
+    : buffer_manager(buffer_manager), block_ids(block_ids), schema(schema), current_block(0), current_record(0),
+      read_ahead_block(0), next_read_ahead(0), read_ahead_window(MIN_READ_AHEAD) {}
 
 bool Table::open()
 {
+    block_guard.reset();
+    cancel_read_ahead();
     current_block = 0;
     current_record = 0;
+
+    read_ahead_block = 0;
+    next_read_ahead = 0;
+    read_ahead_window = MIN_READ_AHEAD;
+
+    if ((int) block_ids.size() > buffer_manager->get_frame_count() / 4)
+        ring = buffer_manager->create_ring();
+    else
+        ring = nullptr;
+
     return true;
 }
 
@@ -25,29 +176,72 @@ std::shared_ptr<Record> Table::next()
     // get first valid record
     while (current_block < block_ids.size())
     {
-        std::string block_id = block_ids.at(current_block);
-        std::shared_ptr<Block> block = buffer_manager->fix_block(block_id);
+        // fix the block once for all of its records
+        if (!block_guard)
+        {
+            if (current_block >= next_read_ahead)
+                read_ahead();
 
-        if (block == nullptr)
-            throw std::runtime_error("Cannot load table block: " + block_id);
+            PageId block_id = block_ids.at(current_block);
+            block_guard = PageGuard(buffer_manager, block_id, ring);
+
+            if (!block_guard)
+                throw std::runtime_error("Cannot load table block: " + std::to_string(block_id));
+        }
 
-        // get record from block
-        std::shared_ptr<Record> record = block->get_record(Block::create_record_id(block_id, current_record));
-        buffer_manager->unfix_block(block_id);
+        std::shared_ptr<Block> const& block = block_guard.get_block();
+        PageId block_id = block->get_block_id();
 
-        // go to next record position
-        if (current_record == Block::MAX_RECORDS - 1)
+        // PAX blocks return their records column by column
+        if (PaxBlock::is_pax_block(block))
         {
-            current_record = 0;
-            ++current_block;
+            std::shared_ptr<Record> record = next_pax_record(block);
+
+            if (record != nullptr)
+                return record;
         } else
-            ++current_record;
+        {
+            // only used slots of the directory are read
+            for (int slot = block->find_used_slot(current_record); slot != -1; slot = block->find_used_slot(current_record))
+            {
+                current_record = slot + 1;
+                RecordId record_id = Block::create_record_id(block_id, slot);
+                std::shared_ptr<Record> record = nullptr;
 
-        // may be hole in the block, try next one
-        if (record == nullptr)
-            continue;
+                // tuples are decoded with the schema, they are never moved
+                if (schema)
+                {
+                    std::optional<TupleView> view = block->get_tuple_view(*schema, record_id);
 
-        return record;
+                    if (view.has_value() && matches(view.value()))
+                        record = view->materialize();
+                }
+                // records moved here from other blocks are read via their forwarding stub
+                else if (block->get_forward(record_id).has_value())
+                {
+                    record = buffer_manager->get_record(record_id);
+
+                    if (record != nullptr && !matches(record->get_view()))
+                        record = nullptr;
+                }
+                else if (!block->is_relocated(record_id))
+                {
+                    std::optional<RecordView> view = block->get_record_view(record_id);
+
+                    // only copy matching records
+                    if (view.has_value() && matches(view.value()))
+                        record = view->materialize();
+                }
+
+                if (record != nullptr)
+                    return record;
+            }
+        }
+
+        // go to next block
+        block_guard.reset();
+        current_record = 0;
+        ++current_block;
     }
 
     // entire table read
@@ -56,14 +250,189 @@ std::shared_ptr<Record> Table::next()
 
 bool Table::close()
 {
+    block_guard.reset();
+    cancel_read_ahead();
     current_block = 0;
     current_record = 0;
+    filters.clear();
+    ring = nullptr;
     return true;
 }
 
+void Table::push_filter(int attribute_position, std::string const& attribute_type, Record::Attribute const& value,
+                        std::string const& comparator)
+{
+    push_filter(attribute_position, Schema::parse_type(attribute_type), value, parse_comparator(comparator));
+}
+
+void Table::push_filter(int attribute_position, Schema::Type attribute_type, Record::Attribute const& value,
+                        Comparator comparator)
+{
+    filters.push_back({attribute_position, attribute_type, value, comparator});
+}
+
+void Table::read_ahead()
+{
+    int first = std::max(read_ahead_block, current_block + 1);
+    int last = std::min((int) block_ids.size(), current_block + 1 + read_ahead_window);
+
+    if (first >= last)
+    {
+        next_read_ahead = current_block + 1;
+        return;
+    }
+
+    std::vector<PageId> batch(block_ids.begin() + first, block_ids.begin() + last);
+    int n_passed = buffer_manager->prefetch_blocks(batch);
+
+    // a sequential scan reaches the requested blocks, so it may read further ahead. The window shrinks when the
+    // buffer manager cannot take more prefetched blocks, e.g. because the scan is slower than the reads.
+    if (n_passed < (int) batch.size())
+        read_ahead_window = std::max(MIN_READ_AHEAD, read_ahead_window / 2);
+    else
+        read_ahead_window = std::min(MAX_READ_AHEAD, read_ahead_window * 2);
+
+    // the next batch is requested in the middle of this one, so the reads overlap with the scan
+    read_ahead_block = first + n_passed;
+    next_read_ahead = std::max(current_block + 1, (current_block + read_ahead_block) / 2);
+}
+
+void Table::cancel_read_ahead()
+{
+    if (read_ahead_block > current_block)
+        buffer_manager->cancel_prefetches(std::vector<PageId>(block_ids.begin() + current_block, block_ids.begin() + read_ahead_block));
+
+    read_ahead_block = 0;
+}
+
+std::shared_ptr<Record> Table::next_pax_record(std::shared_ptr<Block> const& block)
+{
+    PaxBlock pax_block(block);
+    int n_slots = pax_block.get_slot_count();
+
+    while (current_record < n_slots)
+    {
+        int slot = current_record++;
+
+        // filters only read the minipages of their attributes
+        if (!pax_block.is_used(slot) || !matches(pax_block, slot))
+            continue;
+
+        return pax_block.get_record(Block::create_record_id(block->get_block_id(), slot));
+    }
+
+    return nullptr;
+}
+
+template <typename View>
+bool Table::matches(View const& view)
+{
+    for (Filter const& filter : filters)
+    {
+        if (!compare_attribute(view, filter.attribute_position, filter.attribute_type, filter.value, filter.comparator))
+            return false;
+    }
+
+    return true;
+}
+
+bool Table::matches(PaxBlock& block, int slot)
+{
+    for (Filter const& filter : filters)
+    {
+        bool result = false;
+
+        // PAX blocks have no id attributes
+        if (filter.attribute_type == Schema::Type::INTEGER)
+            result = compare_values(block.get_integer_attribute(slot, filter.attribute_position), std::get<int>(filter.value), filter.comparator);
+        else if (filter.attribute_type == Schema::Type::STRING)
+            result = compare_values(block.get_string_attribute(slot, filter.attribute_position), std::string_view(std::get<std::string>(filter.value)), filter.comparator);
+        else if (filter.attribute_type == Schema::Type::BOOLEAN)
+            result = compare_values(block.get_boolean_attribute(slot, filter.attribute_position), std::get<bool>(filter.value), filter.comparator);
+
+        if (!result)
+            return false;
+    }
+
+    return true;
+}
+
+TableAppender::TableAppender(std::shared_ptr<BufferManager> const& buffer_manager)
+    : TableAppender(buffer_manager, nullptr) {}
+
+TableAppender::TableAppender(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<Schema> const& schema)
+    : TableAppender(buffer_manager, schema, {}) {}
+
+TableAppender::TableAppender(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<Schema> const& schema,
+                             std::vector<PageId> const& block_ids)
+    : buffer_manager(buffer_manager), schema(schema), block_ids(block_ids), block(nullptr), fill_last_block(!block_ids.empty()) {}
+
+std::vector<RecordId> TableAppender::append(std::vector<std::vector<Record::Attribute>> const& tuples)
+{
+    std::vector<RecordId> record_ids;
+    record_ids.reserve(tuples.size());
+
+    while (record_ids.size() < tuples.size())
+    {
+        if (block == nullptr && fill_last_block)
+        {
+            block = buffer_manager->fix_block(block_ids.back());
+            fill_last_block = false;
+
+            if (block == nullptr)
+                throw std::runtime_error("Cannot load table block: " + std::to_string(block_ids.back()));
+        } else if (block == nullptr)
+        {
+            block = buffer_manager->fix_block(buffer_manager->create_new_block());
+            block_ids.push_back(block->get_block_id());
+        }
+
+        std::vector<RecordId> added = schema ? block->add_tuples(*schema, tuples, record_ids.size())
+                                             : block->add_records(tuples, record_ids.size());
+
+        // an empty block that cannot take the tuple never will
+        if (added.empty() && block->get_record_count() == 0)
+            throw std::invalid_argument("Cannot append tuple larger than a block: " + std::to_string(record_ids.size()));
+
+        record_ids.insert(record_ids.end(), added.begin(), added.end());
+
+        // continue with a new block
+        if (record_ids.size() < tuples.size())
+            close();
+    }
+
+    return record_ids;
+}
+
+void TableAppender::close()
+{
+    if (block == nullptr)
+        return;
+
+    buffer_manager->unfix_block(block->get_block_id());
+    block = nullptr;
+}
+
+std::vector<PageId> const& TableAppender::get_block_ids()
+{
+    return block_ids;
+}
+
 Projection::Projection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
                        std::vector<int> const& positions, std::vector<std::string> const& attribute_types)
-    : buffer_manager(buffer_manager), source(source), positions(positions), attribute_types(attribute_types) {}
+    : buffer_manager(buffer_manager), source(source), positions(positions), attribute_types(Schema::parse_types(attribute_types))
+{
+    if (positions.size() != attribute_types.size())
+        throw std::invalid_argument("Cannot project " + std::to_string(positions.size()) + " attributes with " + std::to_string(attribute_types.size()) + " types");
+}
+
+Projection::Projection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
+                       std::vector<int> const& positions, Schema const& schema)
+    : buffer_manager(buffer_manager), source(source), positions(positions)
+{
+    for (int position : positions)
+        attribute_types.push_back(schema.get_type(position));
+}
 
 bool Projection::open()
 {
@@ -82,18 +451,10 @@ std::shared_ptr<Record> Projection::next()
     // create projected record
     std::vector<Record::Attribute> values;
 
-    for (int i = 0; i < positions.size(); i++)
-    {
-        int position = positions.at(i);
-        std::string attribute_type = attribute_types.at(i);
-
-        if (attribute_type == "int")
-            values.push_back(record->get_integer_attribute(position));
-        else if (attribute_type == "string")
-            values.push_back(record->get_string_attribute(position));
-        else if (attribute_type == "bool")
-            values.push_back(record->get_boolean_attribute(position));
-    }
+    RecordView view = record->get_view();
+
+    for (size_t i = 0; i < positions.size(); i++)
+        values.push_back(get_attribute(view, positions[i], attribute_types[i]));
 
     return std::make_shared<Record>(Record(record->get_record_id(), values));
 }
@@ -106,30 +467,37 @@ bool Projection::close()
 
 Selection::Selection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
 int attribute_position, std::string const& attribute_type, Record::Attribute const& value, std::string const& comparator)
+    : Selection(buffer_manager, source, attribute_position, Schema::parse_type(attribute_type), value, parse_comparator(comparator)) {}
+
+Selection::Selection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
+int attribute_position, Schema::Type attribute_type, Record::Attribute const& value, Comparator comparator)
     : buffer_manager(buffer_manager), source(source), attribute_position(attribute_position),
-    attribute_type(attribute_type), value(value), comparator(comparator)
+    attribute_type(attribute_type), value(value), comparator(comparator), pushed_down(false)
 {
     // check that attribute type and value type match
-    if (attribute_type == "int")
+    if (attribute_type == Schema::Type::INTEGER)
         assert(std::holds_alternative<int>(value));
-    else if (attribute_type == "string")
+    else if (attribute_type == Schema::Type::STRING)
         assert(std::holds_alternative<std::string>(value));
-    else if (attribute_type == "bool")
+    else if (attribute_type == Schema::Type::BOOLEAN)
         assert(std::holds_alternative<bool>(value));
     else
-        assert(false);
+        assert(std::holds_alternative<uint64_t>(value));
 
-    // check that comparator is correctly defined (==, !=, <, <=, >, >=)
-    if (comparator == "==" or comparator == "!=")
-        assert(true); // valid for all data types
-    else if (comparator == "<" or comparator == "<=" or comparator == ">" or comparator == ">=")
-        assert(std::holds_alternative<int>(value)); // only works for numerical types
-    else
-        assert(false);
+    // order comparators only work for numerical types
+    if (comparator != Comparator::EQUAL && comparator != Comparator::NOT_EQUAL)
+        assert(std::holds_alternative<int>(value) || std::holds_alternative<uint64_t>(value));
 }
 
 bool Selection::open()
 {
+    // let a table skip non-matching records before copying them
+    std::shared_ptr<Table> table = std::dynamic_pointer_cast<Table>(source);
+
+    if (table != nullptr)
+        table->push_filter(attribute_position, attribute_type, value, comparator);
+
+    pushed_down = table != nullptr;
     return source->open();
 }
 
@@ -138,35 +506,13 @@ std::shared_ptr<Record> Selection::next()
     // get record from source
     std::shared_ptr<Record> record = source->next();
 
+    if (pushed_down)
+        return record;
+
     while (record)
     {
-        // get correct attribute
-        Record::Attribute attribute;
-
-        if (attribute_type == "int")
-            attribute = record->get_integer_attribute(attribute_position);
-        else if (attribute_type == "string")
-            attribute = record->get_string_attribute(attribute_position);
-        else if (attribute_type == "bool")
-            attribute = record->get_boolean_attribute(attribute_position);
-
-        // compare attribute with value
-        bool comparison_result = false;
-
-        if (comparator == "==")
-            comparison_result = attribute == value;
-        else if (comparator == "!=")
-            comparison_result = attribute != value;
-        else if (comparator == "<")
-            comparison_result = attribute < value;
-        else if (comparator == "<=")
-            comparison_result = attribute <= value;
-        else if (comparator == ">")
-            comparison_result = attribute > value;
-        else if (comparator == ">=")
-            comparison_result = attribute >= value;
-
-        if (comparison_result)
+        // compare attribute with value in place
+        if (compare_attribute(record->get_view(), attribute_position, attribute_type, value, comparator))
             return record;
 
         record = source->next();
@@ -182,11 +528,11 @@ bool Selection::close()
 
 
 Distinct::Distinct(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source)
-    : buffer_manager(buffer_manager), source(source) {}
+    : buffer_manager(buffer_manager), source(source), n_index_blocks(0) {}
 
 bool Distinct::open()
 {
-    bptree = std::make_shared<BPTree>(BPTree(buffer_manager, buffer_manager->create_new_block()));
+    erase_tmp_blocks();
     return source->open();
 }
 
@@ -197,12 +543,12 @@ std::shared_ptr<Record> Distinct::next()
 
     while (record)
     {
-        int record_hash = record->get_hash();
+        RecordView view = record->get_view();
+        uint64_t record_hash = RecordHash::hash_record(view);
 
-        // check if record is known
-        if (!bptree->search_record(record_hash).has_value())
+        if (!is_returned(view, record_hash))
         {
-            bptree->insert_record(record_hash, "----------");
+            add_returned(view, record_hash);
             return record;
         }
 
@@ -214,7 +560,149 @@ std::shared_ptr<Record> Distinct::next()
 
 bool Distinct::close()
 {
-    return bptree->erase() && source->close();
+    erase_tmp_blocks();
+    return source->close();
+}
+
+bool Distinct::is_returned(RecordView const& view, uint64_t record_hash)
+{
+    if (buckets.empty())
+        return false;
+
+    for (PageId block_id : buckets.at(record_hash & (buckets.size() - 1)))
+    {
+        PageGuard index_guard(buffer_manager, block_id);
+
+        if (!index_guard)
+            throw std::runtime_error("Cannot load distinct index block: " + std::to_string(block_id));
+
+        for (int slot = index_guard->find_used_slot(0); slot != -1; slot = index_guard->find_used_slot(slot + 1))
+        {
+            RecordView entry = index_guard->get_record_view(Block::create_record_id(block_id, slot)).value();
+
+            // equal hashes do not mean equal records
+            if (entry.get_id_attribute(1) != record_hash)
+                continue;
+
+            RecordId location = entry.get_id_attribute(2);
+            PageGuard record_guard(buffer_manager, Block::get_block_id(location));
+
+            if (!record_guard)
+                throw std::runtime_error("Cannot load distinct block: " + std::to_string(Block::get_block_id(location)));
+
+            if (has_same_attributes(record_guard->get_record_view(location).value(), view))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void Distinct::add_returned(RecordView const& view, uint64_t record_hash)
+{
+    std::optional<RecordId> location;
+
+    if (!tmp_block_ids.empty())
+    {
+        PageGuard guard(buffer_manager, tmp_block_ids.back());
+
+        if (!guard)
+            throw std::runtime_error("Cannot load distinct block: " + std::to_string(tmp_block_ids.back()));
+
+        location = guard->add_record_copy(view);
+    }
+
+    // block is full, new block required
+    if (!location.has_value())
+    {
+        PageGuard guard(buffer_manager, create_tmp_block());
+        tmp_block_ids.push_back(guard->get_block_id());
+        location = guard->add_record_copy(view);
+
+        if (!location.has_value())
+            throw std::invalid_argument("Cannot copy record larger than a block: " + std::to_string(view.get_record_id()));
+    }
+
+    if (buckets.empty())
+        buckets.resize(1);
+
+    add_entry(buckets.at(record_hash & (buckets.size() - 1)), record_hash, location.value());
+
+    if (n_index_blocks > 2 * buckets.size())
+        grow_index();
+}
+
+void Distinct::add_entry(std::vector<PageId>& bucket, uint64_t record_hash, RecordId location)
+{
+    std::vector<Record::Attribute> attributes = {record_hash, location};
+
+    if (!bucket.empty())
+    {
+        PageGuard guard(buffer_manager, bucket.back());
+
+        if (!guard)
+            throw std::runtime_error("Cannot load distinct index block: " + std::to_string(bucket.back()));
+
+        if (guard->add_record(attributes) != nullptr)
+            return;
+    }
+
+    PageGuard guard(buffer_manager, create_tmp_block());
+    bucket.push_back(guard->get_block_id());
+    n_index_blocks++;
+    guard->add_record(attributes);
+}
+
+void Distinct::grow_index()
+{
+    std::vector<std::vector<PageId>> old_buckets(buckets.size() * 2);
+    old_buckets.swap(buckets);
+    n_index_blocks = 0;
+
+    for (std::vector<PageId> const& bucket : old_buckets)
+    {
+        for (PageId block_id : bucket)
+        {
+            {
+                PageGuard guard(buffer_manager, block_id);
+
+                if (!guard)
+                    throw std::runtime_error("Cannot load distinct index block: " + std::to_string(block_id));
+
+                for (int slot = guard->find_used_slot(0); slot != -1; slot = guard->find_used_slot(slot + 1))
+                {
+                    RecordView entry = guard->get_record_view(Block::create_record_id(block_id, slot)).value();
+                    uint64_t record_hash = entry.get_id_attribute(1);
+                    add_entry(buckets.at(record_hash & (buckets.size() - 1)), record_hash, entry.get_id_attribute(2));
+                }
+            }
+
+            buffer_manager->erase_block(block_id);
+        }
+    }
+}
+
+PageId Distinct::create_tmp_block()
+{
+    PageId block_id = buffer_manager->create_new_block();
+    buffer_manager->set_page_type(block_id, BufferManager::PageType::TEMP);
+    return block_id;
+}
+
+void Distinct::erase_tmp_blocks()
+{
+    for (PageId block_id : tmp_block_ids)
+        buffer_manager->erase_block(block_id);
+
+    for (std::vector<PageId> const& bucket : buckets)
+    {
+        for (PageId block_id : bucket)
+            buffer_manager->erase_block(block_id);
+    }
+
+    tmp_block_ids.clear();
+    buckets.clear();
+    n_index_blocks = 0;
 }
 
 Join::Join(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source1,
@@ -222,100 +710,81 @@ Join::Join(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr
            std::vector<std::string> const& attribute_types1, std::vector<std::string> const& attribute_types2,
            std::string const& comparator) : buffer_manager(buffer_manager), source1(source1), source2(source2),
            attribute_position1(attribute_position1), attribute_position2(attribute_position2),
-           attribute_types1(attribute_types1), attribute_types2(attribute_types2), comparator(comparator)
+           attribute_types1(parse_join_types(attribute_types1)), attribute_types2(parse_join_types(attribute_types2)),
+           comparator(parse_comparator(comparator))
+{
+    check_attribute_types();
+}
+
+Join::Join(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source1,
+           std::shared_ptr<QueryOperator> const& source2, int attribute_position1, int attribute_position2,
+           Schema const& schema1, Schema const& schema2, Comparator comparator)
+    : buffer_manager(buffer_manager), source1(source1), source2(source2), attribute_position1(attribute_position1),
+      attribute_position2(attribute_position2), attribute_types1(schema1.get_types()), attribute_types2(schema2.get_types()),
+      comparator(comparator)
+{
+    check_attribute_types();
+}
+
+void Join::check_attribute_types()
 {
     // check that join attribute types are the same
-    assert(attribute_types1[attribute_position1] == attribute_types2[attribute_position2]);
+    assert(attribute_types1.at(attribute_position1 - 1) == attribute_types2.at(attribute_position2 - 1));
 
-    // check that comparator is correctly defined (==, !=, <, <=, >, >=)
-    if (comparator == "==" or comparator == "!=")
-        assert(true); // valid for all data types
-    else if (comparator == "<" or comparator == "<=" or comparator == ">" or comparator == ">=")
-        assert(attribute_types1[attribute_position1] == "int"); // only works for numerical types
-    else
-        assert(false);
+    // order comparators only work for numerical types
+    if (comparator != Comparator::EQUAL && comparator != Comparator::NOT_EQUAL)
+        assert(attribute_types1.at(attribute_position1 - 1) == Schema::Type::INTEGER ||
+               attribute_types1.at(attribute_position1 - 1) == Schema::Type::ID);
 }
 
 bool Join::open()
 {
-
-    Record::Attribute attribute_to_compare_source1;
-    Record::Attribute attribute_to_compare_source2;
     bool comparison_result = false;
 
+    // the temporary blocks are written through a ring, so that they do not replace the blocks of the sources
+    std::shared_ptr<BufferManager::Ring> ring = buffer_manager->create_ring();
+
     // create new block
     tmp_block_id = buffer_manager->create_new_block();
+    buffer_manager->set_page_type(tmp_block_id, BufferManager::PageType::TEMP);
     // save block id
     tmp_block_ids.push_back(tmp_block_id);
 
     source1->open();
     // get record from source1
     std::shared_ptr<Record> record_source1 = source1->next();
+    Schema::Type attribute_type1 = attribute_types1.at(attribute_position1 - 1);
+
     while (record_source1)
     {
-        std::string attribute_type1 = attribute_types1.at(attribute_position1);
-        std::string attribute_type2 = attribute_types2.at(attribute_position2);
-
-        // define attribute from source 1
-        if (attribute_type1 == "int")
-            attribute_to_compare_source1 = record_source1->get_integer_attribute(attribute_position1);
-        else if (attribute_type1 == "string")
-            attribute_to_compare_source1 = record_source1->get_string_attribute(attribute_position1);
-        else if (attribute_type1 == "bool")
-            attribute_to_compare_source1 = record_source1->get_boolean_attribute(attribute_position1);
 
         source2->open();
         // get record from source2
         std::shared_ptr<Record> record_source2 = source2->next();
         while (record_source2)
         {
-            // define attribute from source 1
-            if (attribute_type2 == "int")
-                attribute_to_compare_source2 = record_source2->get_integer_attribute(attribute_position2);
-            else if (attribute_type2 == "string")
-                attribute_to_compare_source2 = record_source2->get_string_attribute(attribute_position2);
-            else if (attribute_type2 == "bool")
-                attribute_to_compare_source2 = record_source2->get_boolean_attribute(attribute_position2);
-
-            if (comparator == "==")
-                comparison_result = attribute_to_compare_source1 == attribute_to_compare_source2;
-            else if (comparator == "!=")
-                comparison_result = attribute_to_compare_source1 != attribute_to_compare_source2;
-            else if (comparator == "<")
-                comparison_result = attribute_to_compare_source1 < attribute_to_compare_source2;
-            else if (comparator == "<=")
-                comparison_result = attribute_to_compare_source1 <= attribute_to_compare_source2;
-            else if (comparator == ">")
-                comparison_result = attribute_to_compare_source1 > attribute_to_compare_source2;
-            else if (comparator == ">=")
-                comparison_result = attribute_to_compare_source1 >= attribute_to_compare_source2;
+            // compare join attributes in place
+            comparison_result = compare_attributes(record_source1->get_view(), attribute_position1,
+                                                   record_source2->get_view(), attribute_position2,
+                                                   attribute_type1, comparator);
 
             //if true -> write to block
             if (comparison_result)
             {
                 // get attributes from source tuples
-                std::vector<std::variant<int, std::string, bool>> attributes_to_add;
-
-                for (size_t i = 0; i < attribute_types1.size(); i++) {
-                    if (attribute_types1[i] == "int")
-                        attributes_to_add.push_back(record_source1->get_integer_attribute(i));
-                    else if (attribute_types1[i] == "string")
-                        attributes_to_add.push_back(record_source1->get_string_attribute(i));
-                    else if (attribute_types1[i] == "bool")
-                        attributes_to_add.push_back(record_source1->get_boolean_attribute(i));
-                }
+                std::vector<Record::Attribute> attributes_to_add;
 
-                for (size_t i = 0; i < attribute_types2.size(); i++) {
-                    if (attribute_types2[i] == "int")
-                        attributes_to_add.push_back(record_source2->get_integer_attribute(i));
-                    else if (attribute_types2[i] == "string")
-                        attributes_to_add.push_back(record_source2->get_string_attribute(i));
-                    else if (attribute_types2[i] == "bool")
-                        attributes_to_add.push_back(record_source2->get_boolean_attribute(i));
-                }
+                RecordView view1 = record_source1->get_view();
+                RecordView view2 = record_source2->get_view();
+
+                for (size_t i = 0; i < attribute_types1.size(); i++)
+                    attributes_to_add.push_back(get_attribute(view1, i + 1, attribute_types1[i]));
+
+                for (size_t i = 0; i < attribute_types2.size(); i++)
+                    attributes_to_add.push_back(get_attribute(view2, i + 1, attribute_types2[i]));
 
                 // fix block
-                std::shared_ptr<Block> tmp_block = buffer_manager->fix_block(tmp_block_id);
+                std::shared_ptr<Block> tmp_block = buffer_manager->fix_block(tmp_block_id, ring);
                 // write data to block
                 std::shared_ptr<Record> tmp_record = tmp_block->add_record(attributes_to_add);
 
@@ -326,10 +795,11 @@ bool Join::open()
                     buffer_manager->unfix_block(tmp_block->get_block_id());
                     // create new block
                     tmp_block_id = buffer_manager->create_new_block();
+                    buffer_manager->set_page_type(tmp_block_id, BufferManager::PageType::TEMP);
                     // save block id
                     tmp_block_ids.push_back(tmp_block_id);
                     // fix new block
-                    std::shared_ptr<Block> tmp_block = buffer_manager->fix_block(tmp_block_id);
+                    std::shared_ptr<Block> tmp_block = buffer_manager->fix_block(tmp_block_id, ring);
                     // write data to new block
                     tmp_block->add_record(attributes_to_add);
                 }
@@ -357,9 +827,12 @@ std::shared_ptr<Record> Join::next()
 
 bool Join::close()
 {
-    for (std::string block_id : tmp_block_ids) {
+    // the scan of the result keeps its current block fixed
+    bool closed = tmp_table->close();
+
+    for (PageId block_id : tmp_block_ids) {
         buffer_manager->erase_block(block_id);
     }
 
-    return tmp_table->close();
+    return closed;
 }
\ No newline at end of file
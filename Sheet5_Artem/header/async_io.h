@@ -0,0 +1,76 @@
+#ifndef TASK_3_ASYNC_IO_H
+#define TASK_3_ASYNC_IO_H
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+
+// Asynchronous reads and writes through an io_uring ring (set up with raw system calls).
+// Without io_uring support (or without its read and write operations), requests are executed synchronously when they
+// are queued.
+class AsyncIo
+{
+public:
+    struct Completion {
+        uint64_t tag;
+        int result;     // transferred bytes or negative error number
+    };
+
+    AsyncIo(unsigned queue_depth);
+
+    ~AsyncIo();
+
+    AsyncIo(AsyncIo const&) = delete;
+
+    AsyncIo& operator=(AsyncIo const&) = delete;
+
+    bool is_available();
+
+    // Queue requests, they are started by submit
+    bool queue_read(int fd, void* buffer, unsigned length, uint64_t offset, uint64_t tag);
+
+    bool queue_write(int fd, void const* buffer, unsigned length, uint64_t offset, uint64_t tag);
+
+    bool submit();
+
+    // Waits until at least min_completions requests finished, returns all finished requests
+    std::vector<Completion> wait(unsigned min_completions);
+
+    unsigned get_in_flight();
+
+private:
+    bool queue(bool write, int fd, void const* buffer, unsigned length, uint64_t offset, uint64_t tag);
+
+    // Collects at least min_completions finished requests, without returning them
+    void collect(unsigned min_completions);
+
+    void reap();
+
+    int ring_fd;
+
+    // shared ring memory
+    void* sq_ring;
+    void* cq_ring;
+    void* sqes;
+    size_t sq_ring_size;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    void* cqes;
+
+    unsigned sq_entries;
+    unsigned queued;
+    unsigned in_flight;
+
+    // finished requests that were not returned yet (all requests without io_uring)
+    std::deque<Completion> completions;
+};
+
+#endif
@@ -3,46 +3,220 @@
 
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
+#include "identifiers.h"
 #include "record.h"
+#include "storage_manager.h"
+#include "log_manager.h"
+#include "schema.h"
 
+// Slotted page: header, slot bitmap and dictionary grow from the front, records grow from the back.
+// The block size is the page size of the storage, the number of slots is derived from it.
 class Block
 {
 public:
-    Block(std::string const& block_id);
+    Block(std::shared_ptr<StorageManager> const& storage, PageId block_id);
 
-    std::string get_block_id();
+    // Uses a page that was already read, or creates a new block if it is nullptr
+    Block(std::shared_ptr<StorageManager> const& storage, PageId block_id, std::shared_ptr<void> const& page);
 
-    std::shared_ptr<Record> get_record(std::string const& record_id);
+    PageId get_block_id();
+
+    std::shared_ptr<Record> get_record(RecordId record_id);
+
+    // The view points into the block and must not be used after the block is unfixed
+    std::optional<RecordView> get_record_view(RecordId record_id);
 
     std::shared_ptr<Record> add_record(std::vector<Record::Attribute> const& attributes);
 
+    // Adds the tuples starting at the first index in one pass until the block is full, the records are
+    // encoded directly into the page. Returns the record ids of the added tuples.
+    std::vector<RecordId> add_records(std::vector<std::vector<Record::Attribute>> const& tuples, size_t first);
+
+    // Tuples encoded with a schema, a block stores either records or the tuples of one schema
+    std::optional<RecordId> add_tuple(Schema const& schema, std::vector<Record::Attribute> const& attributes);
+
+    std::vector<RecordId> add_tuples(Schema const& schema, std::vector<std::vector<Record::Attribute>> const& tuples, size_t first);
+
+    // The view points into the block and must not be used after the block is unfixed
+    std::optional<TupleView> get_tuple_view(Schema const& schema, RecordId record_id);
+
     bool update_record(std::shared_ptr<Record> const& record);
 
-    bool delete_record(std::string const& record_id);
+    // Updates a record stored at the given location, which differs from its record id if it was relocated
+    bool update_record(std::shared_ptr<Record> const& record, RecordId location);
+
+    bool delete_record(RecordId record_id);
+
+    // Stores a copy of the record data with a record id of this block, e.g. for records whose attribute types
+    // are not known. Returns the new record id.
+    std::optional<RecordId> add_record_copy(RecordView const& view);
+
+    // Stores a record that moved here from another block and returns its new location
+    std::optional<RecordId> add_relocated_record(std::shared_ptr<Record> const& record);
+
+    // Forwarding stubs replace records that moved to another block
+    std::optional<RecordId> get_forward(RecordId record_id);
+
+    bool set_forward(RecordId record_id, RecordId target_id);
+
+    bool is_relocated(RecordId record_id);
+
+    // Slides all records together at the block end, so that freed space becomes usable again
+    void compact();
+
+    int get_slot_count();
+
+    // First used slot from start on, -1 if there is none. Scans skip empty slots 64 at a time.
+    int find_used_slot(int start);
+
+    int get_record_count();
+
+    int get_free_space();
+
+    int get_block_size();
+
+    int get_max_records();
 
     bool is_dirty();
 
+    void set_dirty();
+
+    // The page of the block, for page layouts other than the slotted page
+    std::shared_ptr<void> get_data();
+
+    // Whether the page uses the slotted layout (and not another layout like PAX), only its changes are logged
+    bool is_slotted();
+
+    // Blocks of read-only databases reject all changes
+    bool is_read_only();
+
+    // Logs all following record changes, the page is only written once its log records are durable
+    void set_log(std::shared_ptr<LogManager> const& log);
+
+    // LSN of the last logged change of the page
+    uint64_t get_page_lsn();
+
+    // LSN of the first logged change since the page was written, 0 if there is none
+    uint64_t get_recovery_lsn();
+
+    // Repeats a logged change of the page if the page does not contain it yet
+    bool redo(LogManager::LogRecord const& log_record);
+
+    // Reverts a logged change of the page and logs the reverting change
+    bool undo(LogManager::LogRecord const& log_record);
+
     bool write_data();
 
-    static std::string create_block_id(int offset);
+    // Copy of the page for a write elsewhere, e.g. together with neighbouring pages. The block counts as written,
+    // so its log records have to be durable before the copy is.
+    std::shared_ptr<void> copy_data_for_write();
+
+    // The copy with the given recovery LSN was not written, the block is dirty again
+    void restore_dirty(uint64_t recovery_lsn);
+
+    static RecordId create_record_id(PageId block_id, int offset);
+
+    static PageId get_block_id(RecordId record_id);
 
-    static std::string create_record_id(std::string const& block_id, int offset);
+    static int get_block_dictionary_offset(RecordId record_id);
 
-    static std::string get_block_id(std::string const& record_id);
+    // Number of slots of a block with the given size
+    static int get_max_records(int block_size);
 
-    static int get_block_dictionary_offset(std::string const& record_id);
+    // Bytes available for records and their dictionary entries in an empty block
+    static int get_usable_space(int block_size);
 
-    static int const BLOCK_ID_SIZE = 5;
-    static int const BLOCK_SIZE = 4096;
+    // Marks valid blocks, pages that were never written or erased are zero
+    static constexpr uint32_t BLOCK_MAGIC = 0x4b4c4244;
+    static int const SLOT_BITS = 16;
+    static int const SLOT_SIZE = 8;
+    // Block size of databases created without an explicit page size
+    static constexpr int BLOCK_SIZE = StorageManager::DEFAULT_PAGE_SIZE;
     static std::string const BLOCK_DIR;
-    static int const MAX_RECORDS = 64;
 
 private:
-    std::shared_ptr<void> load_data(std::string const& block_id);
+    struct Header {
+        uint32_t magic;
+        uint32_t n_records;     // live records
+        PageId block_id;
+        uint64_t lsn;           // last log record that changed the page
+        uint32_t n_slots;       // dictionary entries up to the last used slot
+        uint32_t free_start;    // end of the dictionary
+        uint32_t free_end;      // start of the record area
+        uint32_t fragmented;    // unused bytes inside the record area
+    };
+
+    struct Slot {
+        uint32_t offset;
+        uint16_t length;
+        uint16_t flags;
+    };
+
+    static_assert(sizeof(Slot) == SLOT_SIZE, "Dictionary entries must match SLOT_SIZE");
+
+    static uint16_t const SLOT_NORMAL = 0;
+    static uint16_t const SLOT_FORWARDED = 1;
+    static uint16_t const SLOT_RELOCATED = 2;
+
+    static int const BITMAP_OFFSET = sizeof(Header);
+    // lower bound of the space a record takes including its slot, so slots never run out before space does
+    static int const MIN_RECORD_SPACE = 16;
+
+    static std::shared_ptr<void> load_data(std::shared_ptr<StorageManager> const& storage, PageId block_id);
+
+    Header* get_header();
+
+    Slot* get_slot(int offset_index);
+
+    bool is_slot_used(int offset_index);
+
+    void set_slot_used(int offset_index, bool used);
 
+    int find_free_slot();
+
+    // first free slot at or after the start slot
+    int find_free_slot(int start);
+
+    bool insert_data(int offset_index, void const* record_data, uint32_t record_size, uint16_t flags);
+
+    bool reserve_space(uint32_t free_start, uint32_t size);
+
+    // encodes the tuples in place, as records or with the schema if there is one
+    std::vector<RecordId> add_encoded(std::vector<std::vector<Record::Attribute>> const& tuples, size_t first, Schema const* schema);
+
+    // stores the record in the slot, whether it is used or not
+    bool put_slot(int offset_index, void const* record_data, uint32_t record_size, uint16_t flags);
+
+    bool replace_data(int offset_index, void const* record_data, uint32_t record_size);
+
+    void free_slot(int offset_index);
+
+    // slot flags and record data of a used slot (for undo), empty if the slot is free or changes are not logged
+    std::vector<char> get_slot_image(int offset_index);
+
+    // appends a log record for a change of the slot and stamps its LSN into the page
+    void log_change(LogManager::Type type, int offset_index, void const* change_data, uint32_t size,
+                    std::vector<char> const& undo_image);
+
+    static uint16_t get_slot_flags(LogManager::Type type);
+
+    static LogManager::Type get_log_type(uint16_t flags);
+
+    std::shared_ptr<StorageManager> storage;
+    std::shared_ptr<LogManager> log;
     std::shared_ptr<void> data;
     bool dirty;
+    bool read_only;
+    uint64_t recovery_lsn;
+
+    // page geometry
+    int block_size;
+    int max_records;
+    int dictionary_offset;
 };
 
 #endif
@@ -5,6 +5,7 @@
 #include <string>
 #include <optional>
 
+#include "identifiers.h"
 #include "block.h"
 #include "buffer_manager.h"
 
@@ -14,48 +15,64 @@
 class BPTreeNode
 {
 public:
-    BPTreeNode(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& node_id);
+    BPTreeNode(std::shared_ptr<BufferManager> const& buffer_manager, PageId node_id);
 
-    std::string get_node_id();
+    PageId get_node_id();
 
-    std::string get_parent_id();
+    PageId get_parent_id();
 
     bool is_leaf();
 
     std::vector<int> get_values();
 
-    std::vector<std::string> get_children_ids();
+    std::vector<uint64_t> get_children_ids();
 
-    bool change_parent_id(std::string parent_id);
+    bool change_parent_id(PageId parent_id);
 
     bool change_values(std::vector<int> const& values);
 
-    bool change_children_ids(std::vector<std::string> const& children_ids);
+    bool change_children_ids(std::vector<uint64_t> const& children_ids);
 
-    std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> insert_record(int attribute, std::string const& record_id);
+    std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> insert_record(int attribute, RecordId record_id);
 
-    std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> insert_value(int attribute, std::string const& left_children_id, std::string const& right_children_id);
+    std::optional<std::pair<std::shared_ptr<BPTreeNode>, int>> insert_value(int attribute, PageId left_children_id, PageId right_children_id);
 
-    static std::shared_ptr<BPTreeNode> create_node(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& node_id, std::string parent_id, bool leaf);
+    int get_max_values();
 
-    static int const MAX_VALUES = 29;
-    static int const MAX_CHILDREN = 30;
+    int get_max_children();
+
+    static std::shared_ptr<BPTreeNode> create_node(std::shared_ptr<BufferManager> const& buffer_manager, PageId node_id, PageId parent_id, bool leaf);
+
+    // Fanout of a node that fills a block of the given size
+    static int get_max_values(int block_size);
 
 private:
+    // Record slots: parent id, leaf flag, number of values, values, number of children, children
+    static int const PARENT_SLOT = 0;
+    static int const LEAF_SLOT = 1;
+    static int const N_VALUES_SLOT = 2;
+    static int const VALUES_SLOT = 3;
+
+    int get_n_children_slot();
+
+    int get_children_slot();
+
     std::shared_ptr<BufferManager> buffer_manager;
-    std::string block_id;
+    PageId block_id;
+
+    int max_values;
 };
 
 class BPTree
 {
 public:
-    BPTree(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& root_node_id);
+    BPTree(std::shared_ptr<BufferManager> const& buffer_manager, PageId root_node_id);
 
-    std::optional<std::string> search_record(int attribute);
+    std::optional<RecordId> search_record(int attribute);
 
-    bool insert_record(int attribute, std::string const& record_id);
+    bool insert_record(int attribute, RecordId record_id);
 
-    std::string get_root_node_id();
+    PageId get_root_node_id();
 
     bool erase();
 
@@ -63,9 +80,9 @@ private:
     std::shared_ptr<BPTreeNode> find_leaf_node(int attribute);
 
     std::shared_ptr<BufferManager> buffer_manager;
-    std::string root_node_id;
+    PageId root_node_id;
 
-    std::string const NO_PARENT = "-----";
+    PageId const NO_PARENT = INVALID_PAGE_ID;
 };
 
 #endif
\ No newline at end of file
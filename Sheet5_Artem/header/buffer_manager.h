@@ -5,44 +5,435 @@
 #include <string>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 
+#include "identifiers.h"
 #include "record.h"
 #include "block.h"
+#include "storage_manager.h"
+#include "log_manager.h"
+#include "replacement_policy.h"
 
+// Caches blocks in a fixed number of frames. Fixes, unfixes, prefetches, allocation, erases, flushes and
+// checkpoints may run in parallel threads. Blocks themselves are not synchronized: threads that share a block
+// latch it while they use it (shared for reading, exclusive for changes).
 class BufferManager
 {
 public:
+    // Kinds of blocks that statistics are kept for, blocks are table blocks unless they are marked otherwise
+    enum class PageType : uint8_t {
+        TABLE,
+        INDEX,  // B+ tree nodes
+        TEMP    // intermediate results of operators
+    };
+
+    static constexpr int N_PAGE_TYPES = 3;
+
+    // Counters since the buffer manager was created or its statistics were reset
+    struct Statistics {
+        struct Counters {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+
+            // dirty blocks written back by evictions, the background writer and flushes
+            uint64_t dirty_writes;
+        };
+
+        // indexed by PageType
+        Counters counters[N_PAGE_TYPES];
+
+        // blocks read on misses and write calls, with the time they took
+        uint64_t n_reads;
+        uint64_t read_time_ns;
+        uint64_t n_writes;
+        uint64_t write_time_ns;
+
+        // frames when the statistics were taken, not counted by scopes
+        int n_cached_frames;
+        int n_pinned_frames;
+
+        Counters const& get_counters(PageType type) const;
+
+        // sum of all page types
+        Counters get_total() const;
+
+        double get_hit_ratio() const;
+
+        double get_average_read_us() const;
+
+        double get_average_write_us() const;
+    };
+
+    // Adds the hits, misses, evictions, writes and reads of this thread to the statistics while it lives, e.g. to
+    // attribute them to a query. The work of the background writer is not attributed. Nested scopes replace outer ones.
+    class StatisticsScope
+    {
+    public:
+        StatisticsScope(Statistics& statistics);
+
+        StatisticsScope(StatisticsScope const&) = delete;
+
+        StatisticsScope& operator=(StatisticsScope const&) = delete;
+
+        ~StatisticsScope();
+
+    private:
+        Statistics* previous;
+    };
+
     BufferManager(int n_blocks);
 
-    std::shared_ptr<Block> fix_block(std::string const& block_id);
+    BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage);
+
+    // Logs all record changes, so dirty blocks can stay cached after a commit.
+    // Recovers the database from the log first: redoes the changes after the last checkpoint and undoes uncommitted ones.
+    BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage, std::shared_ptr<LogManager> const& log);
+
+    // Evicts blocks with the policy instead of the least recently unfixed one, the log may be nullptr
+    BufferManager(int n_blocks, std::shared_ptr<StorageManager> const& storage, std::shared_ptr<LogManager> const& log,
+                  ReplacementPolicy::Type policy);
+
+    BufferManager(BufferManager&& other) = default;
+
+    // Stops the background writer, dirty blocks are not written
+    ~BufferManager();
+
+    // Frames that a large scan or bulk write recycles. Once the ring is full, a block that is loaded through it
+    // replaces the oldest block of the ring, so the scan takes at most these frames and other cached blocks stay.
+    // Blocks that are fixed without the ring in the meantime are kept. A ring is used by one thread at a time.
+    class Ring
+    {
+    public:
+        Ring(int n_frames);
+
+    private:
+        friend class BufferManager;
+
+        size_t n_frames;
+
+        // blocks loaded through the ring, the oldest first
+        std::deque<PageId> block_ids;
+
+        uint64_t ring_id;
+        static std::atomic<uint64_t> next_ring_id;
+    };
+
+    // Threads that fix the same missing block wait for one read of it
+    std::shared_ptr<Block> fix_block(PageId block_id);
 
-    bool unfix_block(std::string const& block_id);
+    // Loads a missing block into a frame of the ring, the ring may be nullptr
+    std::shared_ptr<Block> fix_block(PageId block_id, std::shared_ptr<Ring> const& ring);
 
-    bool block_exists(std::string const& block_id);
+    // Ring of a quarter of the frames, at most MAX_RING_FRAMES
+    std::shared_ptr<Ring> create_ring();
 
-    std::string create_new_block();
+    static constexpr int MAX_RING_FRAMES = 32;
 
-    bool erase_block(std::string const& block_id);
+    // Asynchronous fix requests: starts reading the blocks, so that a later fix_block only waits for the read.
+    // Stops when the prefetched blocks take as many pages as there are frames, returns the index of the block where it
+    // stopped. The blocks before it are cached, being read or could not be requested (they are read by their fix).
+    int prefetch_blocks(std::vector<PageId> const& block_ids);
+
+    // false if the prefetched blocks take all pages
+    bool prefetch_block(PageId block_id);
+
+    // Number of blocks that are read ahead and not fixed yet
+    int get_prefetched_block_count();
+
+    // Drops the pages that were read ahead for these blocks and not fixed yet, e.g. when a scan stops early.
+    // Returns the number of dropped pages.
+    int cancel_prefetches(std::vector<PageId> const& block_ids);
+
+    bool unfix_block(PageId block_id);
+
+    // Latches a fixed block, release the latch before the block is unfixed
+    void latch_block(PageId block_id, bool exclusive);
+
+    void unlatch_block(PageId block_id, bool exclusive);
+
+    bool block_exists(PageId block_id);
+
+    // Whether the block is in a frame, e.g. to check which blocks a scan replaced
+    bool is_cached(PageId block_id);
+
+    // Reuses the ids of erased blocks, new ids are reserved in batches
+    PageId create_new_block();
+
+    bool erase_block(PageId block_id);
+
+    // Number of erased block ids that are waiting for reuse
+    int get_free_block_count();
+
+    // Writes all dirty blocks (and the free block list) and makes them durable, commits the log if there is one
+    bool flush();
+
+    // Makes all changes durable, with a log only the log is written (otherwise the dirty blocks are flushed).
+    // Changes of pages that are not logged (e.g. PAX pages) are written and synced.
+    bool commit();
+
+    // Fuzzy checkpoint: logs the dirty blocks without writing them, recovery starts at the oldest change of these
+    uint64_t checkpoint();
+
+    // Number of log records that were redone or undone when the buffer manager was created
+    int get_recovered_records();
+
+    // Page size of the underlying database
+    int get_block_size();
+
+    int get_frame_count();
+
+    // Marks the block for the statistics until it is erased
+    void set_page_type(PageId block_id, PageType type);
+
+    // Counters of all threads, cheap enough to stay on
+    Statistics get_statistics();
+
+    void reset_statistics();
+
+    // Starts a thread that writes dirty unfixed blocks in the background, so that evictions find clean blocks:
+    // the oldest ones while more than dirty_ratio of the frames hold them (down to half of it), and all that are
+    // dirty for longer than max_age. Neighbouring blocks are written together. The buffer manager must not be
+    // moved while the writer runs.
+    void start_writer(double dirty_ratio, std::chrono::milliseconds max_age);
+
+    void stop_writer();
+
+    // Number of blocks written by the background writer
+    uint64_t get_written_block_count();
+
+    // Records all fixes, unfixes and erases until the trace is stopped, e.g. to compare replacement policies
+    void start_trace();
+
+    std::vector<ReplacementPolicy::TraceEntry> stop_trace();
+
+    // Record access that follows forwarding stubs, so record ids stay stable when records move between blocks
+    std::shared_ptr<Record> get_record(RecordId record_id);
+
+    bool update_record(std::shared_ptr<Record> const& record);
+
+    bool delete_record(RecordId record_id);
 
 private:
+    std::optional<RecordId> relocate_record(std::shared_ptr<Record> const& record);
+
+    // View of the mapped page, it does not enter the page table and needs no unfix
+    std::shared_ptr<Block> fix_mapped_block(PageId block_id);
+
+    void recover();
+
+    // Replaces the free block list and the next ids with the saved ones
+    void load_free_blocks();
+
+    // stores the free block list in the meta block and the blocks linked from it, the allocation mutex is held
+    bool save_free_blocks();
+
+    // a new id from the reserved batch, the allocation mutex is held
+    PageId reserve_block_id();
+
+    // the allocation mutex is held
+    bool save_last_block_id(PageId last_block_id);
+
     int n_blocks;
 
-    struct CacheEntry {
+    // Reads and writes the pages of all blocks
+    std::shared_ptr<StorageManager> storage;
+
+    // Write-ahead log of the changes, may be nullptr
+    std::shared_ptr<LogManager> log;
+    bool recovering;
+    int n_recovered_records;
+
+    struct Frame {
         std::shared_ptr<Block> block;
-        int reference_count;
 
-        CacheEntry() : block(nullptr), reference_count(0) {}
-        CacheEntry(std::shared_ptr<Block> const& block, int ref_count) : block(block), reference_count(ref_count) {}
+        // Fixes of the block. Changes from and to 0 hold the policy mutex, so the policy knows every fixed block
+        // (except blocks that an eviction writes, the policy chose them already).
+        std::atomic<int> reference_count;
+
+        // The block is read, fixes do not wait for the latch anymore
+        std::atomic<bool> loaded;
+
+        // The frame left the page table, guarded by the policy mutex
+        bool evicted;
+
+        // An eviction writes the block and holds one of its fixes, guarded by the policy mutex
+        bool evicting;
+
+        // Ring that loaded the block and may replace it (0 if none), guarded by the policy mutex
+        uint64_t ring_id;
+
+        // changed under the mutex of the shard, read by writes without it
+        std::atomic<PageType> page_type;
+
+        // Latch of the block, exclusive while the block is read or written by an eviction. After the fields that every
+        // fix uses.
+        std::shared_mutex latch;
+
+        Frame() : block(nullptr), reference_count(1), loaded(false), evicted(false), evicting(false), ring_id(0),
+                  page_type(PageType::TABLE) {}
     };
 
-    // Map a block ID to a CacheEntry
-    std::unordered_map<std::string, CacheEntry> cache;
+    // Short critical sections, a mutex is cheaper than a shared mutex
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<PageId, std::shared_ptr<Frame>> frames;
+
+        // blocks that are not table blocks, also while they are not cached
+        std::unordered_map<PageId, PageType> page_types;
+
+        // hits and misses of the blocks in this shard, counted under the mutex that fixes take anyway
+        Statistics::Counters counters[N_PAGE_TYPES];
+
+        Shard() : counters() {}
+    };
+
+    static constexpr size_t N_SHARDS = 16;
+
+    // Mutexes cannot be moved, so buffer managers keep them behind a pointer
+    struct Synchronization {
+        // Page table: maps a block ID to its frame, partitioned so that fixes of different blocks rarely wait for each other
+        Shard shards[N_SHARDS];
+
+        // Replacement policy, number of frames and first fixes and last unfixes of blocks
+        std::mutex policy;
+        std::condition_variable eviction_done;
+
+        // Block ids and the overflow block
+        std::mutex allocation;
+
+        // Prefetched pages
+        std::mutex prefetch;
+
+        std::mutex trace;
+        std::atomic<bool> tracing;
+
+        // Held by the writer while it writes blocks, checkpoints wait for it
+        std::mutex writer;
+
+        // Wakes up the writer early, e.g. when an eviction has to write a dirty block
+        std::mutex writer_state;
+        std::condition_variable writer_wakeup;
+        bool writer_stopped;
+        std::thread writer_thread;
+
+        std::atomic<uint64_t> n_written_blocks;
+
+        // A page whose changes are not logged (e.g. a PAX page) was written without a sync, the next commit syncs it
+        std::atomic<bool> unlogged_writes;
+
+        // Pages the writer copied and counts as written until its write finished, other accesses of them wait
+        std::mutex write_state;
+        std::condition_variable write_done;
+        std::unordered_set<PageId> pages_in_write;
+
+        // Evictions, writes and reads, the hits and misses are kept in the shards
+        std::mutex statistics;
+        Statistics io_statistics;
+
+        Synchronization() : tracing(false), writer_stopped(true), n_written_blocks(0), unlogged_writes(false),
+                            io_statistics() {}
+    };
+
+    Shard& get_shard(PageId block_id);
+
+    // The frame stays valid while the block is fixed or the policy mutex is held
+    Frame* find_frame(PageId block_id);
+
+    // Loads the block into a new frame, nullptr if another thread added a frame for it first
+    std::shared_ptr<Frame> load_frame(PageId block_id, Ring* ring);
+
+    // The oldest block of a full ring if it can be replaced, the policy mutex is held
+    PageId recycle_ring_block(Ring& ring);
+
+    // Adds a fix to a fixed block without the policy mutex, false if the block has no fixes
+    static bool add_fix(Frame& frame);
+
+    // Fixes the frame, false if it was evicted in the meantime
+    bool pin_frame(PageId block_id, std::shared_ptr<Frame> const& frame, Ring* ring);
+
+    // Removes the frame from the page table, the policy mutex is held
+    std::shared_ptr<Block> remove_frame(PageId block_id);
+
+    // Evicts the unfixed block that the policy chose, the policy mutex is held. Dirty blocks are fixed and written
+    // without the mutex, false if the block stays cached because it was used in the meantime or a flush writes it.
+    // The policy takes such a block back where it was. Throws if it cannot be written.
+    bool evict_frame(PageId block_id, std::unique_lock<std::mutex>& policy_lock);
+
+    // Waits until the writer wrote the page of the block
+    void wait_for_write(PageId block_id);
+
+    // All frames with a loaded block
+    std::vector<std::pair<PageId, std::shared_ptr<Frame>>> get_frames();
+
+    void add_trace_entry(ReplacementPolicy::TraceEntry::Access access, PageId block_id);
+
+    // Counts a hit or miss in the shard, its mutex is held
+    static void count_fix(Shard& shard, PageType type, bool hit);
+
+    void count_eviction(PageType type);
+
+    // one read of a missing block
+    void count_read(std::chrono::steady_clock::duration time);
+
+    // one write of the blocks with these types
+    void count_write(std::vector<PageType> const& types, std::chrono::steady_clock::duration time);
+
+    // statistics of the scope of this thread, nullptr if there is none
+    static thread_local Statistics* scope_statistics;
+
+    void run_writer();
+
+    // Writes the chosen dirty blocks, remembers since when the unfixed blocks are dirty
+    void write_dirty_blocks(std::unordered_map<PageId, std::chrono::steady_clock::time_point>& dirty_since);
+
+    std::unique_ptr<Synchronization> sync;
+
+    // Number of frames in the page table, at most n_blocks
+    int n_frames;
+
+    // Thresholds of the background writer
+    double dirty_ratio;
+    std::chrono::milliseconds max_dirty_age;
+
+    static constexpr std::chrono::milliseconds WRITER_INTERVAL = std::chrono::milliseconds(10);
+
+    // Chooses the unfixed blocks that are evicted, in constant time for LRU
+    std::shared_ptr<ReplacementPolicy> policy;
+
+    std::vector<ReplacementPolicy::TraceEntry> trace;
+
+    // Pages that are read ahead of their fix, at most n_blocks
+    std::unordered_map<PageId, std::shared_ptr<void>> prefetched;
+
+    // Erased block ids, handed out again before new ones
+    std::vector<PageId> free_blocks;
+
+    // Blocks that continue the free block list of the meta block, in the order they are linked
+    std::vector<PageId> free_list_block_ids;
+
+    // New ids are handed out from a batch that is reserved in the meta block
+    PageId next_block_id;
+    PageId reserved_block_id;
+    bool free_blocks_changed;
+
+    static constexpr int ALLOCATION_BATCH = 64;
+    static constexpr size_t FREE_BLOCKS_PER_RECORD = 32;
 
-    // Keeps track of blocks that are not fixed, for eviction purposes
-    std::list<std::string> unfixed_blocks;
+    // Receives records that do not fit into their block anymore
+    PageId overflow_block_id;
 
     // Contains meta information
-    static std::string const BLOCK_ID;
+    static constexpr PageId BLOCK_ID = 0;
 };
 
 #endif
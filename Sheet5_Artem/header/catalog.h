@@ -0,0 +1,89 @@
+#ifndef TASK_3_CATALOG_H
+#define TASK_3_CATALOG_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "identifiers.h"
+#include "record.h"
+#include "schema.h"
+#include "buffer_manager.h"
+#include "bptree.h"
+#include "execution.h"
+
+// Tables of a database: their typed columns, blocks and B+ tree indexes. The catalog file in the database
+// directory is replaced on every change, so opening a database restores the tables without rebuilding block lists.
+// The pages themselves are made durable by the buffer manager (flush or commit).
+class Catalog
+{
+public:
+    Catalog(std::shared_ptr<BufferManager> const& buffer_manager, std::string const& directory);
+
+    // Names contain no whitespace, column types are those of a schema (int, string, bool, id)
+    void create_table(std::string const& table_name, std::vector<std::string> const& column_names,
+                      std::vector<std::string> const& column_types);
+
+    // Erases the blocks and indexes of the table
+    bool drop_table(std::string const& table_name);
+
+    bool has_table(std::string const& table_name);
+
+    std::vector<std::string> get_table_names();
+
+    std::shared_ptr<Schema> get_schema(std::string const& table_name);
+
+    std::vector<std::string> const& get_column_names(std::string const& table_name);
+
+    // Position of the column in the tuples (starting at 1), throws if there is no such column
+    int get_column_position(std::string const& table_name, std::string const& column_name);
+
+    Schema::Type get_column_type(std::string const& table_name, std::string const& column_name);
+
+    std::vector<PageId> const& get_block_ids(std::string const& table_name);
+
+    // Appends the tuples behind the last tuple of the table and adds them to its indexes.
+    // Throws before anything is appended if a key is already in an index.
+    std::vector<RecordId> append(std::string const& table_name, std::vector<std::vector<Record::Attribute>> const& tuples);
+
+    // Table operator over the blocks of the table, bound to its schema
+    std::shared_ptr<Table> scan(std::string const& table_name);
+
+    // Indexes an int column with unique values, including the tuples already in the table
+    void create_index(std::string const& table_name, std::string const& index_name, std::string const& column_name);
+
+    // nullptr if the table has no such index
+    std::shared_ptr<BPTree> get_index(std::string const& table_name, std::string const& index_name);
+
+    bool save();
+
+    static std::string const CATALOG_FILE;
+
+private:
+    struct Index {
+        std::string name;
+        int column_position;
+        std::shared_ptr<BPTree> bptree;
+    };
+
+    struct TableEntry {
+        std::vector<std::string> column_names;
+        std::shared_ptr<Schema> schema;
+        std::vector<PageId> block_ids;
+        std::vector<Index> indexes;
+    };
+
+    TableEntry& get_table(std::string const& table_name);
+
+    void load();
+
+    static void check_name(std::string const& name);
+
+    std::shared_ptr<BufferManager> buffer_manager;
+    std::string directory;
+
+    std::map<std::string, TableEntry> tables;
+};
+
+#endif
@@ -4,15 +4,32 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 
+#include "identifiers.h"
 #include "record.h"
 #include "block.h"
 #include "bptree.h"
 #include "buffer_manager.h"
+#include "page_guard.h"
+#include "pax_block.h"
+#include "schema.h"
 
 class QueryOperator
 {
 public:
+    // Comparators are resolved once when the plan is built, not for every tuple
+    enum class Comparator : uint8_t {
+        EQUAL,          // ==
+        NOT_EQUAL,      // !=
+        LESS,           // <
+        LESS_EQUAL,     // <=
+        GREATER,        // >
+        GREATER_EQUAL   // >=
+    };
+
+    static Comparator parse_comparator(std::string const& comparator);
+
     virtual bool open() {return true;}
 
     virtual std::shared_ptr<Record> next() {return nullptr;}
@@ -24,7 +41,11 @@ public:
 class Table : public QueryOperator
 {
 public:
-    Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<std::string> const& block_ids);
+    Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<PageId> const& block_ids);
+
+    // Table of tuples encoded with the schema
+    Table(std::shared_ptr<BufferManager> const& buffer_manager, std::vector<PageId> const& block_ids,
+          std::shared_ptr<Schema> const& schema);
 
     virtual bool open() override;
 
@@ -32,12 +53,96 @@ public:
 
     virtual bool close() override;
 
+    // Skips records that do not match before they are copied out of their block (until the table is closed).
+    // On PAX blocks, only the minipage of the filtered attribute is read for these records.
+    void push_filter(int attribute_position, std::string const& attribute_type, Record::Attribute const& value,
+                     std::string const& comparator);
+
+    void push_filter(int attribute_position, Schema::Type attribute_type, Record::Attribute const& value,
+                     Comparator comparator);
+
 private:
+    struct Filter {
+        int attribute_position;
+        Schema::Type attribute_type;
+        Record::Attribute value;
+        Comparator comparator;
+    };
+
+    std::shared_ptr<Record> next_pax_record(std::shared_ptr<Block> const& block);
+
+    // Prefetches the next blocks of the scan, the window doubles while the scan follows it
+    void read_ahead();
+
+    // Drops the blocks that were read ahead and not reached, so that they do not take the prefetch slots
+    void cancel_read_ahead();
+
+    // works on record and tuple views
+    template <typename View>
+    bool matches(View const& view);
+
+    bool matches(PaxBlock& block, int slot);
+
     std::shared_ptr<BufferManager> buffer_manager;
-    std::vector<std::string> block_ids;
+    std::vector<PageId> block_ids;
+
+    // nullptr if the blocks contain records
+    std::shared_ptr<Schema> schema;
 
     int current_block;
+
+    // next slot of the current block
     int current_record;
+
+    // the current block stays fixed until the scan leaves it
+    PageGuard block_guard;
+
+    // blocks before this one are cached or being read, the next ones are requested when the scan reaches next_read_ahead
+    int read_ahead_block;
+    int next_read_ahead;
+    int read_ahead_window;
+
+    static constexpr int MIN_READ_AHEAD = 4;
+    static constexpr int MAX_READ_AHEAD = 32;
+
+    // scans of tables with more blocks than a quarter of the frames recycle a ring, nullptr otherwise
+    std::shared_ptr<BufferManager::Ring> ring;
+
+    std::vector<Filter> filters;
+};
+
+// Bulk loads tuples into new blocks of a table: each block is fixed once and filled in one pass
+class TableAppender
+{
+public:
+    TableAppender(std::shared_ptr<BufferManager> const& buffer_manager);
+
+    // Encodes the tuples with the schema instead of as records
+    TableAppender(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<Schema> const& schema);
+
+    // Continues a table with these blocks, the last one is filled before new blocks are created
+    TableAppender(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<Schema> const& schema,
+                  std::vector<PageId> const& block_ids);
+
+    // Returns the record ids of the tuples in their order
+    std::vector<RecordId> append(std::vector<std::vector<Record::Attribute>> const& tuples);
+
+    // Unfixes the block that is filled at the moment
+    void close();
+
+    // Blocks of the table, e.g. to scan it
+    std::vector<PageId> const& get_block_ids();
+
+private:
+    std::shared_ptr<BufferManager> buffer_manager;
+    std::shared_ptr<Schema> schema;
+    std::vector<PageId> block_ids;
+
+    // last block of the table, fixed until it is full or the appender is closed
+    std::shared_ptr<Block> block;
+
+    // the last of the given blocks may still have room
+    bool fill_last_block;
 };
 
 class Projection : public QueryOperator
@@ -46,6 +151,10 @@ public:
     Projection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
                std::vector<int> const& positions, std::vector<std::string> const& attribute_types);
 
+    // Resolves the types of the positions with the schema of the source
+    Projection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
+               std::vector<int> const& positions, Schema const& schema);
+
     virtual bool open() override;
 
     virtual std::shared_ptr<Record> next() override;
@@ -56,7 +165,7 @@ private:
     std::shared_ptr<BufferManager> buffer_manager;
     std::shared_ptr<QueryOperator> source;
     std::vector<int> positions;
-    std::vector<std::string> attribute_types;
+    std::vector<Schema::Type> attribute_types;
 };
 
 class Selection : public QueryOperator
@@ -65,6 +174,9 @@ public:
     Selection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
                int attribute_position, std::string const& attribute_type, Record::Attribute const& value, std::string const& comparator);
 
+    Selection(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source,
+              int attribute_position, Schema::Type attribute_type, Record::Attribute const& value, Comparator comparator);
+
     virtual bool open() override;
 
     virtual std::shared_ptr<Record> next() override;
@@ -75,9 +187,12 @@ private:
     std::shared_ptr<BufferManager> buffer_manager;
     std::shared_ptr<QueryOperator> source;
     int attribute_position;
-    std::string attribute_type;
+    Schema::Type attribute_type;
     Record::Attribute value;
-    std::string comparator;
+    Comparator comparator;
+
+    // the source table already filters the records
+    bool pushed_down;
 };
 
 class Distinct : public QueryOperator
@@ -92,19 +207,48 @@ public:
     virtual bool close() override;
 
 private:
+    // Whether a returned record has the same attributes, records with the hash are compared in place
+    bool is_returned(RecordView const& view, uint64_t record_hash);
+
+    // Copies the record into the temporary table and adds its location to the index
+    void add_returned(RecordView const& view, uint64_t record_hash);
+
+    // Appends an entry to the bucket, a full block continues in a new one
+    void add_entry(std::vector<PageId>& bucket, uint64_t record_hash, RecordId location);
+
+    // Doubles the buckets of the index and moves the entries into them
+    void grow_index();
+
+    PageId create_tmp_block();
+
+    void erase_tmp_blocks();
+
     std::shared_ptr<BufferManager> buffer_manager;
     std::shared_ptr<QueryOperator> source;
-    std::shared_ptr<BPTree> bptree;
+
+    // records returned so far, copied into temporary blocks
+    std::vector<PageId> tmp_block_ids;
+
+    // hash index of the returned records in temporary blocks: the entries (hash, location) are in the bucket of the
+    // low bits of their hash. The buckets double when they take more than two blocks on average.
+    std::vector<std::vector<PageId>> buckets;
+    size_t n_index_blocks;
 };
 
 class Join : public QueryOperator
 {
 public:
+    // The type lists start with "" for the record id
     Join(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source1,
          std::shared_ptr<QueryOperator> const& source2, int attribute_position1, int attribute_position2,
          std::vector<std::string> const& attribute_types1, std::vector<std::string> const& attribute_types2,
          std::string const& comparator);
 
+    // Takes the attribute types from the schemas of the sources
+    Join(std::shared_ptr<BufferManager> const& buffer_manager, std::shared_ptr<QueryOperator> const& source1,
+         std::shared_ptr<QueryOperator> const& source2, int attribute_position1, int attribute_position2,
+         Schema const& schema1, Schema const& schema2, Comparator comparator);
+
     virtual bool open() override;
 
     virtual std::shared_ptr<Record> next() override;
@@ -112,17 +256,20 @@ public:
     virtual bool close() override;
 
 private:
+    void check_attribute_types();
+
     std::shared_ptr<BufferManager> buffer_manager;
     std::shared_ptr<QueryOperator> source1;
     std::shared_ptr<QueryOperator> source2;
     int attribute_position1;
     int attribute_position2;
-    std::vector<std::string> attribute_types1;
-    std::vector<std::string> attribute_types2;
-    std::string comparator;
+    // without the record id, attribute i + 1 has type i
+    std::vector<Schema::Type> attribute_types1;
+    std::vector<Schema::Type> attribute_types2;
+    Comparator comparator;
 
-    std::string tmp_block_id;
-    std::vector<std::string> tmp_block_ids;
+    PageId tmp_block_id;
+    std::vector<PageId> tmp_block_ids;
 
     std::shared_ptr<Table> tmp_table;
 };
@@ -0,0 +1,15 @@
+#ifndef TASK_3_IDENTIFIERS_H
+#define TASK_3_IDENTIFIERS_H
+
+#include <cstdint>
+
+// Page ids are the page numbers used by the storage manager
+typedef uint64_t PageId;
+
+// Record ids contain the page id (upper 48 bits) and the slot in the block dictionary (lower 16 bits)
+typedef uint64_t RecordId;
+
+constexpr PageId INVALID_PAGE_ID = UINT64_MAX;
+constexpr RecordId INVALID_RECORD_ID = UINT64_MAX;
+
+#endif
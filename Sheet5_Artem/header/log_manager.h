@@ -0,0 +1,119 @@
+#ifndef TASK_3_LOG_MANAGER_H
+#define TASK_3_LOG_MANAGER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "identifiers.h"
+
+// Write-ahead log of a database. Log records are physiological (page id, slot and record images before and
+// after the change) and are identified by their LSN, the offset of the record in the log file. Appending only
+// copies into a buffer, flush writes the buffer and syncs it once for all threads that wait for it (group commit).
+// A checkpoint file points to the last checkpoint record, so opening the log only reads the records after it.
+class LogManager
+{
+public:
+    enum class Type : uint16_t {
+        INSERT = 1,         // record added to a slot
+        INSERT_RELOCATED,   // record moved to a slot of an overflow block
+        UPDATE,             // new record image of a slot
+        DELETE,             // slot freed
+        FORWARD,            // slot replaced by a forwarding stub to another record id
+        ERASE_BLOCK,        // page erased
+        COMMIT,             // all previous changes are durable once this record is
+        CHECKPOINT          // state of the buffer at the time of the checkpoint
+    };
+
+    struct LogRecord {
+        uint64_t lsn;
+        Type type;
+        PageId page_id;
+        int slot;
+        std::vector<char> data;
+        std::vector<char> undo_data;
+    };
+
+    LogManager(std::string const& directory);
+
+    ~LogManager();
+
+    LogManager(LogManager const&) = delete;
+
+    LogManager& operator=(LogManager const&) = delete;
+
+    // Returns the LSN of the new log record
+    uint64_t append(Type type, PageId page_id, int slot, void const* data, uint32_t size,
+                    void const* undo_data = nullptr, uint32_t undo_size = 0);
+
+    // Makes all log records up to the LSN durable
+    bool flush(uint64_t lsn);
+
+    // Appends a commit record and waits until it is durable, returns its LSN
+    uint64_t commit();
+
+    // Appends a checkpoint record with the data, makes it durable and points the checkpoint file to it
+    uint64_t checkpoint(void const* data, uint32_t size);
+
+    // Reads all valid log records starting at the LSN, stops at the first incomplete or damaged one
+    std::vector<LogRecord> read_records(uint64_t lsn);
+
+    // LSN of the last checkpoint record, 0 if there is none
+    uint64_t get_checkpoint_lsn();
+
+    // All log records before this LSN belong to committed changes
+    uint64_t get_commit_lsn();
+
+    uint64_t get_end_lsn();
+
+    uint64_t get_flushed_lsn();
+
+    // Number of syncs of the log file, commits that were flushed together share one
+    uint64_t get_sync_count();
+
+    static std::string const LOG_FILE;
+    static std::string const CHECKPOINT_FILE;
+
+    // the log file starts with its magic number, so no log record has the LSN 0
+    static constexpr uint64_t FIRST_LSN = sizeof(uint64_t);
+    static constexpr uint64_t LOG_MAGIC = 0x314c4157;
+
+private:
+    struct Header {
+        uint32_t size;      // of the whole log record
+        uint32_t checksum;  // of the log record after this field
+        uint64_t lsn;
+        PageId page_id;
+        uint16_t type;
+        uint16_t slot;
+        uint32_t data_size;
+        uint32_t undo_size;
+        uint32_t padding;
+    };
+
+    static uint32_t get_checksum(char const* data, size_t size);
+
+    bool write_checkpoint_file(uint64_t lsn, uint64_t committed_lsn);
+
+    std::string directory;
+    int fd;
+
+    std::mutex mutex;
+    std::condition_variable flushed;
+
+    // log records after the flushed part, starting at buffer_lsn
+    std::vector<char> buffer;
+    uint64_t buffer_lsn;
+    uint64_t end_lsn;
+    uint64_t flushed_lsn;
+    uint64_t checkpoint_lsn;
+    uint64_t commit_lsn;
+
+    // a thread is writing and syncing the log, the others wait for it
+    bool flushing;
+    uint64_t sync_count;
+};
+
+#endif
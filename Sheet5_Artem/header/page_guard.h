@@ -0,0 +1,49 @@
+#ifndef TASK_3_PAGE_GUARD_H
+#define TASK_3_PAGE_GUARD_H
+
+#include <memory>
+
+#include "identifiers.h"
+#include "block.h"
+#include "buffer_manager.h"
+
+// Keeps a block fixed while it lives, the block is unfixed when the guard is destroyed, reset or assigned.
+// Guards can be moved, e.g. into an operator that holds the block of its scan, but not copied.
+class PageGuard
+{
+public:
+    // Guard without a block
+    PageGuard();
+
+    PageGuard(std::shared_ptr<BufferManager> const& buffer_manager, PageId block_id);
+
+    // Loads a missing block into a frame of the ring, the ring may be nullptr
+    PageGuard(std::shared_ptr<BufferManager> const& buffer_manager, PageId block_id,
+              std::shared_ptr<BufferManager::Ring> const& ring);
+
+    PageGuard(PageGuard&& other) noexcept;
+
+    PageGuard& operator=(PageGuard&& other) noexcept;
+
+    PageGuard(PageGuard const&) = delete;
+
+    PageGuard& operator=(PageGuard const&) = delete;
+
+    ~PageGuard();
+
+    // nullptr if the guard holds no block
+    std::shared_ptr<Block> const& get_block() const;
+
+    Block* operator->() const;
+
+    explicit operator bool() const;
+
+    // Unfixes the block before the guard is destroyed
+    void reset();
+
+private:
+    std::shared_ptr<BufferManager> buffer_manager;
+    std::shared_ptr<Block> block;
+};
+
+#endif
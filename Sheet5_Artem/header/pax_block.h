@@ -0,0 +1,101 @@
+#ifndef TASK_3_PAX_BLOCK_H
+#define TASK_3_PAX_BLOCK_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "identifiers.h"
+#include "record.h"
+#include "block.h"
+
+// PAX page layout for a fixed block: each attribute of the tuples on the page is stored in its own
+// minipage, so scans only touch the columns they need. Strings are stored in a heap at the page end
+// and referenced by offset and length from their minipage. Tuples keep the record ids of slotted blocks.
+class PaxBlock
+{
+public:
+    PaxBlock(std::shared_ptr<Block> const& block);
+
+    // Turns an empty block into a PAX block for tuples with the given attribute types (int, string, bool)
+    static std::shared_ptr<PaxBlock> create(std::shared_ptr<Block> const& block, std::vector<std::string> const& attribute_types);
+
+    static bool is_pax_block(std::shared_ptr<Block> const& block);
+
+    // Returns INVALID_RECORD_ID if the block is full
+    RecordId add_record(std::vector<Record::Attribute> const& attributes);
+
+    bool delete_record(RecordId record_id);
+
+    // Assembles a row record of all attributes
+    std::shared_ptr<Record> get_record(RecordId record_id);
+
+    // Attribute positions start at 1, like in records (position 0 is the record id)
+    int get_integer_attribute(int slot, int position);
+
+    std::string_view get_string_attribute(int slot, int position);
+
+    bool get_boolean_attribute(int slot, int position);
+
+    bool is_used(int slot);
+
+    int get_slot_count();
+
+    int get_record_count();
+
+    int get_capacity();
+
+    std::vector<std::string> get_attribute_types();
+
+    static constexpr uint32_t PAX_MAGIC = 0x58415044;
+
+private:
+    // shares its first fields with slotted blocks, so the block id is found at the same place
+    struct Header {
+        uint32_t magic;
+        uint32_t n_records;     // live tuples
+        PageId block_id;
+        uint64_t lsn;           // not logged, commits write the page instead, kept for the common header
+        uint32_t n_slots;       // tuples added (deleted ones included)
+        uint32_t capacity;      // tuples per minipage
+        uint32_t n_attributes;
+        uint32_t minipages_end; // end of the last minipage
+        uint32_t heap_start;    // start of the string heap
+    };
+
+    struct StringEntry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    enum AttributeType : uint8_t {
+        INTEGER = 1,
+        STRING = 2,
+        BOOLEAN = 3
+    };
+
+    static AttributeType parse_type(std::string const& attribute_type);
+
+    static int get_width(AttributeType type);
+
+    // bytes of the header, type list, minipage offsets, deleted bitmap and minipages for the capacity
+    static uint32_t get_layout_size(std::vector<AttributeType> const& types, uint32_t capacity);
+
+    Header* get_header();
+
+    AttributeType get_type(int attribute_index);
+
+    char* get_minipage(int attribute_index);
+
+    uint8_t* get_bitmap();
+
+    // average string length that is reserved in the heap when choosing the capacity
+    static int const STRING_RESERVE = 16;
+
+    std::shared_ptr<Block> block;
+    char* data;
+};
+
+#endif
@@ -5,17 +5,58 @@
 #include <variant>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "identifiers.h"
+
+class Record;
+
+// Non-owning view of record data, only valid as long as the underlying memory (e.g. a fixed block) is
+class RecordView
+{
+public:
+    RecordView(void const* data);
+
+    RecordId get_record_id() const;
+
+    std::string_view get_string_attribute(int attribute_index) const;
+
+    int get_integer_attribute(int attribute_index) const;
+
+    bool get_boolean_attribute(int attribute_index) const;
+
+    uint64_t get_id_attribute(int attribute_index) const;
+
+    // Raw bytes of an attribute, e.g. for hashing it in place
+    std::string_view get_attribute_bytes(int attribute_index) const;
+
+    // Number of attributes without the record id
+    int get_attribute_count() const;
+
+    void const* get_data() const;
+
+    int get_size() const;
+
+    // Copies the record data, e.g. to keep a record after its block is unfixed
+    std::shared_ptr<Record> materialize() const;
+
+private:
+    int get_attribute_position(int attribute_index) const;
+
+    char const* data;
+};
 
 class Record
 {
 public:
-    typedef std::variant<int, std::string, bool> Attribute;
+    typedef std::variant<int, std::string, bool, uint64_t> Attribute;
 
     Record(std::shared_ptr<void> const& data);
 
-    Record(std::string const& record_id, std::vector<Attribute> const& attributes);
+    Record(RecordId record_id, std::vector<Attribute> const& attributes);
 
-    std::string get_record_id();
+    RecordId get_record_id();
 
     std::string get_string_attribute(int attribute_index);
 
@@ -23,13 +64,21 @@ public:
 
     bool get_boolean_attribute(int attribute_index);
 
+    uint64_t get_id_attribute(int attribute_index);
+
     std::shared_ptr<void> get_data();
 
+    RecordView get_view();
+
     int get_size();
 
-    int get_hash();
+    // Size of the record data with these attributes
+    static int get_encoded_size(std::vector<Attribute> const& attributes);
+
+    // Writes the record data to the destination, which has room for get_encoded_size bytes
+    static void encode(void* destination, RecordId record_id, std::vector<Attribute> const& attributes);
 
-    static int const RECORD_ID_SIZE = 10;
+    static int const RECORD_ID_SIZE = sizeof(RecordId);
 
 private:
     std::shared_ptr<void> data;
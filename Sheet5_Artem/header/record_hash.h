@@ -0,0 +1,134 @@
+#ifndef TASK_3_RECORD_HASH_H
+#define TASK_3_RECORD_HASH_H
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "record.h"
+
+// Fast 64-bit hashes of attributes, computed in place on the bytes of records and tuples without copying them.
+// Attributes have the same hashes in records, in tuples of a schema and as Record::Attribute, so hash-based
+// operators may mix them. Multi-column hashes run over the attributes in one pass and depend on their order.
+class RecordHash
+{
+public:
+    static uint64_t hash(void const* data, size_t size, uint64_t seed = SEED);
+
+    // Hash of the attribute at the position (starting at 1), works on RecordView and TupleView
+    template <typename View>
+    static uint64_t hash_attribute(View const& view, int position)
+    {
+        std::string_view bytes = view.get_attribute_bytes(position);
+        return hash(bytes.data(), bytes.size());
+    }
+
+    static uint64_t hash_attribute(Record::Attribute const& attribute);
+
+    // Combined hash of the attributes at the positions, e.g. the columns of a group or join key
+    template <typename View>
+    static uint64_t hash_attributes(View const& view, std::vector<int> const& positions)
+    {
+        uint64_t state = SEED;
+
+        for (int position : positions)
+        {
+            std::string_view bytes = view.get_attribute_bytes(position);
+            state = update(state, bytes.data(), bytes.size());
+        }
+
+        return finalize(state);
+    }
+
+    static uint64_t hash_attributes(std::vector<Record::Attribute> const& attributes, std::vector<int> const& positions);
+
+    // Combined hash of all attributes, without the record id
+    template <typename View>
+    static uint64_t hash_record(View const& view)
+    {
+        uint64_t state = SEED;
+        int n_attributes = view.get_attribute_count();
+
+        for (int position = 1; position <= n_attributes; position++)
+        {
+            std::string_view bytes = view.get_attribute_bytes(position);
+            state = update(state, bytes.data(), bytes.size());
+        }
+
+        return finalize(state);
+    }
+
+    static uint64_t hash_record(std::vector<Record::Attribute> const& attributes);
+
+    // Hashes the attributes at the positions of all records into hashes (all attributes if positions is empty).
+    // The vector of hashes is reused, so hashing every batch of a scan does not allocate.
+    static void hash_batch(std::vector<std::shared_ptr<Record>> const& records, std::vector<int> const& positions,
+                           std::vector<uint64_t>& hashes);
+
+    static void hash_batch(std::vector<std::vector<Record::Attribute>> const& tuples, std::vector<int> const& positions,
+                           std::vector<uint64_t>& hashes);
+
+    // Combines two hashes, e.g. of different sources, in this order
+    static uint64_t combine(uint64_t hash, uint64_t value);
+
+    static constexpr uint64_t SEED = 0xa0761d6478bd642full;
+
+private:
+    static constexpr uint64_t PRIME = 0xe7037ed1a0b428dbull;
+
+    // Adds the bytes and their size to the state of a hash, inlined since it runs for every attribute.
+    // The size separates attributes, so "ab", "c" and "a", "bc" differ.
+    static uint64_t update(uint64_t state, void const* data, size_t size)
+    {
+        unsigned char const* bytes = static_cast<unsigned char const*>(data);
+        state ^= size;
+
+        // 8 bytes per multiplication
+        for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t))
+            state = mix(load(bytes, sizeof(uint64_t)) ^ PRIME, state ^ SEED);
+
+        // rest without a call to memcpy: two overlapping 4 byte loads, or the first, middle and last byte
+        uint64_t word = 0;
+
+        if (size >= sizeof(uint32_t))
+            word = (load(bytes, sizeof(uint32_t)) << 32) | load(bytes + size - sizeof(uint32_t), sizeof(uint32_t));
+        else if (size > 0)
+            word = ((uint64_t) bytes[0] << 16) | ((uint64_t) bytes[size / 2] << 8) | bytes[size - 1];
+
+        return mix(word ^ PRIME, state ^ SEED);
+    }
+
+    static uint64_t update(uint64_t state, Record::Attribute const& attribute);
+
+    static uint64_t finalize(uint64_t state)
+    {
+        return mix(state, PRIME);
+    }
+
+    // folds the 128-bit product of both values
+    static uint64_t mix(uint64_t a, uint64_t b)
+    {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    // unaligned load of 4 or 8 bytes
+    static uint64_t load(unsigned char const* bytes, size_t size)
+    {
+        if (size == sizeof(uint32_t))
+        {
+            uint32_t value;
+            std::memcpy(&value, bytes, sizeof(uint32_t));
+            return value;
+        }
+
+        uint64_t value;
+        std::memcpy(&value, bytes, sizeof(uint64_t));
+        return value;
+    }
+};
+
+#endif
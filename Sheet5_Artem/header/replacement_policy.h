@@ -0,0 +1,281 @@
+#ifndef TASK_3_REPLACEMENT_POLICY_H
+#define TASK_3_REPLACEMENT_POLICY_H
+
+#include <memory>
+#include <string>
+#include <list>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+#include "identifiers.h"
+
+// Chooses the blocks that the buffer manager evicts. The buffer manager reports the first fix and the last unfix
+// of a block and blocks that leave the cache, and asks for a victim when it needs a frame. Fixed blocks are never
+// chosen. Policies are selected when a buffer manager is created, and can be compared on recorded traces.
+// Policies are not synchronized, the buffer manager calls them with a mutex.
+class ReplacementPolicy
+{
+public:
+    enum class Type : uint8_t {
+        LRU,        // least recently unfixed
+        CLOCK,      // second chance
+        TWO_QUEUE,  // 2Q: FIFO for new blocks, LRU for blocks that were used again after their eviction
+        LRU_K,      // LRU-2: oldest second to last use
+        ARC         // adaptive replacement cache
+    };
+
+    // Fix, unfix and erase of a block, e.g. recorded by a buffer manager
+    struct TraceEntry {
+        enum class Access : uint8_t {
+            FIX,
+            UNFIX,
+            ERASE
+        };
+
+        Access access;
+        PageId block_id;
+    };
+
+    struct SimulationResult {
+        uint64_t hits;
+        uint64_t misses;
+
+        double get_hit_ratio() const;
+    };
+
+    virtual ~ReplacementPolicy() = default;
+
+    // The block is loaded into a frame, it is fixed until on_unfix
+    virtual void on_load(PageId block_id) = 0;
+
+    // A cached block without fixes is fixed again
+    virtual void on_fix(PageId block_id) = 0;
+
+    // The last fix of the block is released, it may be evicted now
+    virtual void on_unfix(PageId block_id) = 0;
+
+    // The block leaves the cache without an eviction, e.g. because it is erased
+    virtual void on_erase(PageId block_id) = 0;
+
+    // Chooses an unfixed block to make room for the block and forgets it, INVALID_PAGE_ID if all blocks are fixed
+    virtual PageId evict(PageId block_id) = 0;
+
+    // The block that evict chose stays cached and unfixed, e.g. because it could not be written. It goes back to
+    // where evict took it from, remembered evictions forget it and it does not count as a use.
+    virtual void on_eviction_cancelled(PageId block_id) = 0;
+
+    static std::shared_ptr<ReplacementPolicy> create(Type type, int n_frames);
+
+    static std::string get_name(Type type);
+
+    // Replays the trace with a cache of n_frames, throws if a fix does not find a frame
+    static SimulationResult simulate(Type type, int n_frames, std::vector<TraceEntry> const& trace);
+
+protected:
+    // List of blocks with constant time access to every block
+    class PageList
+    {
+    public:
+        bool contains(PageId block_id) const;
+
+        void push_back(PageId block_id);
+
+        void push_front(PageId block_id);
+
+        bool remove(PageId block_id);
+
+        // moves the block to the back if it is in the list
+        bool move_to_back(PageId block_id);
+
+        PageId pop_front();
+
+        // INVALID_PAGE_ID if the list is empty
+        PageId front() const;
+
+        size_t size() const;
+
+    private:
+        std::list<PageId> blocks;
+        std::unordered_map<PageId, std::list<PageId>::iterator> positions;
+    };
+};
+
+// Evicts the block whose last unfix is the oldest, only unfixed blocks are in its list
+class LruPolicy : public ReplacementPolicy
+{
+public:
+    void on_load(PageId block_id) override;
+
+    void on_fix(PageId block_id) override;
+
+    void on_unfix(PageId block_id) override;
+
+    void on_erase(PageId block_id) override;
+
+    PageId evict(PageId block_id) override;
+
+    void on_eviction_cancelled(PageId block_id) override;
+
+private:
+    PageList unfixed_blocks;
+};
+
+// Frames in a circle with a reference bit, the hand clears the bits of used blocks and evicts the first
+// unfixed block without one
+class ClockPolicy : public ReplacementPolicy
+{
+public:
+    ClockPolicy(int n_frames);
+
+    void on_load(PageId block_id) override;
+
+    void on_fix(PageId block_id) override;
+
+    void on_unfix(PageId block_id) override;
+
+    void on_erase(PageId block_id) override;
+
+    PageId evict(PageId block_id) override;
+
+    void on_eviction_cancelled(PageId block_id) override;
+
+private:
+    struct Frame {
+        PageId block_id;
+        bool referenced;
+        bool fixed;
+    };
+
+    std::vector<Frame> frames;
+    std::unordered_map<PageId, size_t> positions;
+    std::vector<size_t> free_frames;
+    size_t hand;
+};
+
+// New blocks go through a FIFO queue (a1in) and are remembered after their eviction (a1out). Blocks that are
+// loaded again while they are remembered are hot and kept in an LRU list (am), so a scan only replaces a1in.
+// Like with LRU, fixed blocks leave am and are appended again by their unfix. a1in keeps its order, fixed blocks
+// that reach its front wait beside it and go back to the front with their unfix.
+class TwoQueuePolicy : public ReplacementPolicy
+{
+public:
+    TwoQueuePolicy(int n_frames);
+
+    void on_load(PageId block_id) override;
+
+    void on_fix(PageId block_id) override;
+
+    void on_unfix(PageId block_id) override;
+
+    void on_erase(PageId block_id) override;
+
+    PageId evict(PageId block_id) override;
+
+    void on_eviction_cancelled(PageId block_id) override;
+
+private:
+    PageList a1in;
+    PageList a1in_fixed;
+    PageList a1out;
+    PageList am;
+    std::unordered_set<PageId> fixed;
+
+    size_t max_a1in;
+    size_t max_a1out;
+};
+
+// Evicts the block whose K-th last use is the oldest, blocks with less than K uses first (in LRU order).
+// The uses of evicted blocks are remembered for a while. Repeated fixes of the block that was used last
+// (e.g. once per record of a scan) are correlated and count as one use.
+class LruKPolicy : public ReplacementPolicy
+{
+public:
+    LruKPolicy(int n_frames);
+
+    void on_load(PageId block_id) override;
+
+    void on_fix(PageId block_id) override;
+
+    void on_unfix(PageId block_id) override;
+
+    void on_erase(PageId block_id) override;
+
+    PageId evict(PageId block_id) override;
+
+    void on_eviction_cancelled(PageId block_id) override;
+
+    static constexpr int K = 2;
+
+private:
+    struct History {
+        // times of the last K uses, the most recent first, 0 if there was none
+        uint64_t uses[K];
+        bool evictable;
+    };
+
+    void use(PageId block_id, History& history);
+
+    // eviction order: K-th last use, then last use
+    std::tuple<uint64_t, uint64_t, PageId> get_key(PageId block_id, History const& history);
+
+    std::unordered_map<PageId, History> histories;
+    std::set<std::tuple<uint64_t, uint64_t, PageId>> evictable_blocks;
+
+    // histories of evicted blocks, the oldest is forgotten first
+    std::unordered_map<PageId, History> evicted_histories;
+    PageList evicted_blocks;
+
+    size_t n_frames;
+    uint64_t time;
+    PageId last_block_id;
+};
+
+// Balances a list of blocks used once (t1) with a list of blocks used again (t2). Evicted blocks are remembered
+// in b1 and b2, loading one of them again moves the target size of t1 towards the list that would have kept it.
+// Fixed blocks leave t1 and t2 and are appended again by their unfix, but count for the sizes of their list.
+class ArcPolicy : public ReplacementPolicy
+{
+public:
+    ArcPolicy(int n_frames);
+
+    void on_load(PageId block_id) override;
+
+    void on_fix(PageId block_id) override;
+
+    void on_unfix(PageId block_id) override;
+
+    void on_erase(PageId block_id) override;
+
+    PageId evict(PageId block_id) override;
+
+    void on_eviction_cancelled(PageId block_id) override;
+
+private:
+    // sizes of t1 and t2 with their fixed blocks
+    size_t get_t1_size();
+
+    size_t get_t2_size();
+
+    PageList t1;
+    PageList t2;
+    PageList b1;
+    PageList b2;
+
+    // fixed blocks and whether they belong to t2
+    std::unordered_map<PageId, bool> fixed;
+    size_t n_fixed_t1;
+
+    size_t n_frames;
+
+    // target size of t1
+    size_t target;
+
+    // repeated fixes of the last block count as one use
+    PageId last_block_id;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef TASK_3_SCHEMA_H
+#define TASK_3_SCHEMA_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "identifiers.h"
+#include "record.h"
+
+// Attribute types of the tuples of a table. Tuples encoded with a schema store fixed-width attributes at
+// constant offsets, strings are referenced by offset and length from there and stored behind them.
+// The tuple has no size field, dictionary or record id, the slot of its block provides these.
+class Schema
+{
+public:
+    enum class Type : uint8_t {
+        INTEGER = 1,
+        STRING = 2,
+        BOOLEAN = 3,
+        ID = 4
+    };
+
+    // Attribute types are int, string, bool and id (uint64_t)
+    Schema(std::vector<std::string> const& attribute_types);
+
+    // Resolves a type tag once, so that operators do not compare strings per tuple
+    static Type parse_type(std::string const& attribute_type);
+
+    static std::vector<Type> parse_types(std::vector<std::string> const& attribute_types);
+
+    int get_attribute_count() const;
+
+    std::vector<std::string> const& get_attribute_types() const;
+
+    std::vector<Type> const& get_types() const;
+
+    // Type of the attribute at the position (starting at 1)
+    Type get_type(int position) const;
+
+    // Bytes of the fixed-width part of every tuple
+    int get_fixed_size() const;
+
+    // Throws if the attributes do not match the schema
+    int get_encoded_size(std::vector<Record::Attribute> const& attributes) const;
+
+    // Writes the tuple to the destination, which has room for get_encoded_size bytes
+    void encode(void* destination, std::vector<Record::Attribute> const& attributes) const;
+
+    std::vector<Record::Attribute> decode(void const* data) const;
+
+    // Attribute positions start at 1, like in records (position 0 is the record id)
+    int get_integer_attribute(void const* data, int position) const;
+
+    std::string_view get_string_attribute(void const* data, int position) const;
+
+    bool get_boolean_attribute(void const* data, int position) const;
+
+    uint64_t get_id_attribute(void const* data, int position) const;
+
+    // Raw bytes of an attribute, the same bytes as in a record with that attribute
+    std::string_view get_attribute_bytes(void const* data, int position) const;
+
+private:
+    // location of a string in the tuple
+    struct StringEntry {
+        uint16_t offset;
+        uint16_t length;
+    };
+
+    static int get_width(Type type);
+
+    std::vector<std::string> attribute_types;
+    std::vector<Type> types;
+
+    // offset of every attribute in the fixed-width part
+    std::vector<int> offsets;
+    int fixed_size;
+};
+
+// Non-owning view of a tuple encoded with a schema, with the accessors of RecordView. Only valid as long
+// as the block and the schema are.
+class TupleView
+{
+public:
+    TupleView(Schema const& schema, void const* data, int size, RecordId record_id);
+
+    RecordId get_record_id() const;
+
+    std::string_view get_string_attribute(int attribute_index) const;
+
+    int get_integer_attribute(int attribute_index) const;
+
+    bool get_boolean_attribute(int attribute_index) const;
+
+    uint64_t get_id_attribute(int attribute_index) const;
+
+    std::string_view get_attribute_bytes(int attribute_index) const;
+
+    int get_attribute_count() const;
+
+    void const* get_data() const;
+
+    int get_size() const;
+
+    // Copies the tuple into a record, e.g. for the query operators
+    std::shared_ptr<Record> materialize() const;
+
+private:
+    Schema const* schema;
+    char const* data;
+    int size;
+    RecordId record_id;
+};
+
+#endif
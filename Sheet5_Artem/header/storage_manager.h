@@ -0,0 +1,158 @@
+#ifndef TASK_3_STORAGE_MANAGER_H
+#define TASK_3_STORAGE_MANAGER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+
+#include "async_io.h"
+
+// Keeps all pages of a database in a few segment files inside one directory.
+// Pages are addressed by their page number and accessed with positioned reads and writes.
+// The page size is chosen when the database is created and stored with it.
+// Threads may access different pages at the same time, accesses of the same page have to be ordered by the caller.
+class StorageManager
+{
+public:
+    enum class Mode {
+        BUFFERED,   // positioned reads and writes through the OS page cache
+        DIRECT,     // pages bypass the OS page cache and are only cached in the buffer manager
+        MAPPED      // read-only, segment files are mapped into memory and the kernel manages residency
+    };
+
+    StorageManager(std::string const& directory, int page_size);
+
+    StorageManager(std::string const& directory, int page_size, Mode mode);
+
+    // Opens an existing database with its stored page size (or creates one with the default size)
+    StorageManager(std::string const& directory);
+
+    StorageManager(std::string const& directory, Mode mode);
+
+    ~StorageManager();
+
+    StorageManager(StorageManager const&) = delete;
+
+    StorageManager& operator=(StorageManager const&) = delete;
+
+    // Returns whether the page exists, throws if it cannot be read
+    bool read_page(uint64_t page_number, void* buffer);
+
+    bool write_page(uint64_t page_number, void const* buffer);
+
+    // Writes consecutive pages starting at the page number with one system call per segment
+    bool write_pages(uint64_t page_number, std::vector<void const*> const& buffers);
+
+    bool page_exists(uint64_t page_number);
+
+    bool erase_page(uint64_t page_number);
+
+    // Asynchronous page I/O (io_uring if available), the buffer is kept until the request finished.
+    // Requests are queued and started by submit_pages, at most one request per page is running.
+    bool read_page_async(uint64_t page_number, std::shared_ptr<void> const& buffer);
+
+    bool write_page_async(uint64_t page_number, std::shared_ptr<void> const& buffer);
+
+    void submit_pages();
+
+    // Waits for the running request of a page, returns whether it succeeded (reads: whether the page exists).
+    // A failed write is reported until the page is waited for, a failed read throws like read_page.
+    bool wait_page(uint64_t page_number);
+
+    // Waits for the running request of a page and drops its result
+    void cancel_page(uint64_t page_number);
+
+    bool is_async_io();
+
+    bool sync();
+
+    int get_page_size();
+
+    Mode get_mode();
+
+    bool is_direct_io();
+
+    bool is_read_only();
+
+    // Points to a page of a mapped database, nullptr if the page does not exist
+    void const* get_mapped_page(uint64_t page_number);
+
+    // Page buffers are aligned for direct I/O
+    std::shared_ptr<void> allocate_page();
+
+    // Reads the page size of an existing database, 0 if there is none
+    static int read_page_size(std::string const& directory);
+
+    static uint64_t const SEGMENT_PAGES = 65536;
+    static std::string const SEGMENT_PREFIX;
+    static std::string const GEOMETRY_FILE;
+
+    static int const DEFAULT_PAGE_SIZE = 4096;
+    static int const MIN_PAGE_SIZE = 4096;
+    static int const MAX_PAGE_SIZE = 65536;
+    static int const PAGE_ALIGNMENT = 4096;
+    static int const MAX_WRITE_PAGES = 64;
+    static constexpr unsigned ASYNC_QUEUE_DEPTH = 64;
+
+private:
+    int get_segment(uint64_t page_number, bool create);
+
+    static bool is_aligned(void const* buffer);
+
+    bool queue_page(uint64_t page_number, std::shared_ptr<void> const& buffer, bool write);
+
+    // The functions below are called with the mutex held
+    int open_segment(uint64_t page_number, bool create);
+
+    void finish_request(AsyncIo::Completion const& completion);
+
+    // Waits for the running request of a page and takes its result
+    bool take_result(uint64_t page_number);
+
+    // Waits for running requests without taking their results
+    void finish_page(uint64_t page_number);
+
+    void wait_all_pages();
+
+    std::string directory;
+    int page_size;
+    Mode mode;
+
+    // Guards the members below, reads and writes run without it. Waits for asynchronous requests hold it.
+    std::mutex mutex;
+
+    // Open file descriptors of the segment files (-1 if not opened yet)
+    std::vector<int> segments;
+
+    struct Mapping {
+        char* address;
+        size_t size;
+    };
+
+    // Mapped segment files in mapped mode (nullptr if not mapped yet)
+    std::vector<Mapping> mappings;
+
+    // Created on the first asynchronous request
+    std::unique_ptr<AsyncIo> async_io;
+
+    struct Request {
+        std::shared_ptr<void> buffer;
+        bool write;
+    };
+
+    enum class Result {
+        EXISTS,
+        MISSING,        // the page was never written or was erased
+        READ_FAILED,
+        WRITE_FAILED
+    };
+
+    // Running requests and results of finished reads and failed writes that were not waited for, by page number
+    std::unordered_map<uint64_t, Request> requests;
+    std::unordered_map<uint64_t, Result> results;
+};
+
+#endif
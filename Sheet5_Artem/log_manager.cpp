@@ -0,0 +1,312 @@
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "header/filesystem.h"
+#include "header/identifiers.h"
+#include "header/log_manager.h"
+
+std::string const LogManager::LOG_FILE = "wal";
+std::string const LogManager::CHECKPOINT_FILE = "checkpoint";
+
+LogManager::LogManager(std::string const& directory)
+    : directory(directory), buffer_lsn(FIRST_LSN), end_lsn(FIRST_LSN), flushed_lsn(FIRST_LSN), checkpoint_lsn(0),
+      commit_lsn(FIRST_LSN), flushing(false), sync_count(0)
+{
+    std::string path = directory + LOG_FILE;
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (fd < 0)
+        throw std::runtime_error("Cannot open log file: " + path);
+
+    // new log files start with the magic number
+    uint64_t magic = 0;
+
+    if (pread(fd, &magic, sizeof(uint64_t), 0) == 0)
+    {
+        magic = LOG_MAGIC;
+
+        if (pwrite(fd, &magic, sizeof(uint64_t), 0) != sizeof(uint64_t) || fdatasync(fd) != 0)
+            throw std::runtime_error("Cannot initialize log file: " + path);
+    }
+
+    if (magic != LOG_MAGIC)
+    {
+        close(fd);
+        throw std::invalid_argument("Not a log file: " + path);
+    }
+
+    // only the log records after the last checkpoint are read
+    std::ifstream file(directory + CHECKPOINT_FILE);
+    uint64_t stored_commit_lsn = 0;
+
+    if (file >> checkpoint_lsn >> stored_commit_lsn)
+        commit_lsn = stored_commit_lsn;
+    else
+        checkpoint_lsn = 0;
+
+    end_lsn = std::max(checkpoint_lsn, FIRST_LSN);
+
+    // continue after the last complete log record, a damaged tail is overwritten
+    for (LogRecord const& record : read_records(end_lsn))
+    {
+        end_lsn = record.lsn + sizeof(Header) + record.data.size() + record.undo_data.size();
+
+        if (record.type == Type::COMMIT)
+            commit_lsn = end_lsn;
+    }
+
+    buffer_lsn = end_lsn;
+    flushed_lsn = end_lsn;
+}
+
+LogManager::~LogManager()
+{
+    flush(end_lsn);
+    close(fd);
+}
+
+uint64_t LogManager::append(Type type, PageId page_id, int slot, void const* data, uint32_t size,
+                            void const* undo_data, uint32_t undo_size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.size = sizeof(Header) + size + undo_size;
+    header.lsn = end_lsn;
+    header.page_id = page_id;
+    header.type = static_cast<uint16_t>(type);
+    header.slot = slot;
+    header.data_size = size;
+    header.undo_size = undo_size;
+
+    // copy the log record into the buffer
+    size_t start = buffer.size();
+    buffer.resize(start + header.size);
+    std::memcpy(buffer.data() + start, &header, sizeof(Header));
+
+    if (size > 0)
+        std::memcpy(buffer.data() + start + sizeof(Header), data, size);
+
+    if (undo_size > 0)
+        std::memcpy(buffer.data() + start + sizeof(Header) + size, undo_data, undo_size);
+
+    // the checksum detects log records that were only partially written
+    size_t checksum_offset = offsetof(Header, checksum) + sizeof(uint32_t);
+    uint32_t checksum = get_checksum(buffer.data() + start + checksum_offset, header.size - checksum_offset);
+    std::memcpy(buffer.data() + start + offsetof(Header, checksum), &checksum, sizeof(uint32_t));
+
+    end_lsn += header.size;
+    return header.lsn;
+}
+
+bool LogManager::flush(uint64_t lsn)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (flushed_lsn <= lsn && flushed_lsn < end_lsn)
+    {
+        // another thread is writing, its sync may already contain our log records
+        if (flushing)
+        {
+            flushed.wait(lock);
+            continue;
+        }
+
+        // write everything appended so far, also for the threads that wait
+        flushing = true;
+
+        std::vector<char> batch;
+        batch.swap(buffer);
+        uint64_t batch_lsn = buffer_lsn;
+        uint64_t batch_end = end_lsn;
+        buffer_lsn = end_lsn;
+
+        lock.unlock();
+
+        bool success = pwrite(fd, batch.data(), batch.size(), (off_t) batch_lsn) == (ssize_t) batch.size() && fdatasync(fd) == 0;
+
+        lock.lock();
+        flushing = false;
+
+        if (success)
+        {
+            flushed_lsn = batch_end;
+            sync_count++;
+        } else
+        {
+            // keep the log records for the next try
+            batch.insert(batch.end(), buffer.begin(), buffer.end());
+            buffer.swap(batch);
+            buffer_lsn = batch_lsn;
+        }
+
+        flushed.notify_all();
+
+        if (!success)
+            return false;
+    }
+
+    return true;
+}
+
+uint64_t LogManager::commit()
+{
+    uint64_t lsn = append(Type::COMMIT, INVALID_PAGE_ID, 0, nullptr, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        commit_lsn = std::max<uint64_t>(commit_lsn, lsn + sizeof(Header));
+    }
+
+    if (!flush(lsn))
+        throw std::runtime_error("Cannot write commit log record: " + std::to_string(lsn));
+
+    return lsn;
+}
+
+uint64_t LogManager::checkpoint(void const* data, uint32_t size)
+{
+    // commits after this point may not be durable with the checkpoint record
+    uint64_t committed_lsn = get_commit_lsn();
+    uint64_t lsn = append(Type::CHECKPOINT, INVALID_PAGE_ID, 0, data, size);
+
+    if (!flush(lsn) || !write_checkpoint_file(lsn, committed_lsn))
+        throw std::runtime_error("Cannot write checkpoint: " + std::to_string(lsn));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    checkpoint_lsn = lsn;
+    return lsn;
+}
+
+std::vector<LogManager::LogRecord> LogManager::read_records(uint64_t lsn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<LogRecord> records;
+    lsn = std::max(lsn, FIRST_LSN);
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) != 0 || (uint64_t) file_stat.st_size <= lsn)
+        return records;
+
+    std::vector<char> data(file_stat.st_size - lsn);
+
+    if (pread(fd, data.data(), data.size(), (off_t) lsn) != (ssize_t) data.size())
+        return records;
+
+    size_t offset = 0;
+    size_t checksum_offset = offsetof(Header, checksum) + sizeof(uint32_t);
+
+    while (offset + sizeof(Header) <= data.size())
+    {
+        Header header;
+        std::memcpy(&header, data.data() + offset, sizeof(Header));
+
+        // stop at the end of the log or at a torn write
+        if (header.size != sizeof(Header) + header.data_size + header.undo_size || offset + header.size > data.size() || header.lsn != lsn + offset)
+            break;
+
+        if (get_checksum(data.data() + offset + checksum_offset, header.size - checksum_offset) != header.checksum)
+            break;
+
+        char const* record_data = data.data() + offset + sizeof(Header);
+        records.push_back({header.lsn, static_cast<Type>(header.type), header.page_id, header.slot,
+                           std::vector<char>(record_data, record_data + header.data_size),
+                           std::vector<char>(record_data + header.data_size, record_data + header.data_size + header.undo_size)});
+
+        offset += header.size;
+    }
+
+    return records;
+}
+
+uint64_t LogManager::get_checkpoint_lsn()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return checkpoint_lsn;
+}
+
+uint64_t LogManager::get_commit_lsn()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return commit_lsn;
+}
+
+uint64_t LogManager::get_end_lsn()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return end_lsn;
+}
+
+uint64_t LogManager::get_flushed_lsn()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushed_lsn;
+}
+
+uint64_t LogManager::get_sync_count()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return sync_count;
+}
+
+bool LogManager::write_checkpoint_file(uint64_t lsn, uint64_t committed_lsn)
+{
+    // replace the file at once, a crash leaves either the old or the new checkpoint. The new file is synced before
+    // the rename, so it cannot be torn, and the directory after it, so that the rename survives a crash.
+    std::string path = directory + CHECKPOINT_FILE;
+    std::string content = std::to_string(lsn) + " " + std::to_string(committed_lsn) + "\n";
+
+    int file = open((path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (file < 0)
+        return false;
+
+    bool success = write(file, content.data(), content.size()) == (ssize_t) content.size() && fsync(file) == 0;
+    close(file);
+
+    if (!success)
+        return false;
+
+    std::error_code error;
+    std::filesystem::rename(path + ".tmp", path, error);
+
+    if (error)
+        return false;
+
+    int dir = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (dir < 0)
+        return false;
+
+    success = fsync(dir) == 0;
+    close(dir);
+    return success;
+}
+
+uint32_t LogManager::get_checksum(char const* data, size_t size)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
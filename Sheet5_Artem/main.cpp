@@ -1,26 +1,47 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <set>
 #include <fstream>
 #include <random>
 #include <memory>
 #include <cassert>
 #include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
 
 #include "header/filesystem.h"
+#include "header/identifiers.h"
+#include "header/async_io.h"
 #include "header/record.h"
+#include "header/record_hash.h"
+#include "header/schema.h"
+#include "header/storage_manager.h"
+#include "header/log_manager.h"
 #include "header/block.h"
+#include "header/pax_block.h"
+#include "header/replacement_policy.h"
 #include "header/buffer_manager.h"
+#include "header/page_guard.h"
 #include "header/bptree.h"
 #include "header/execution.h"
+#include "header/catalog.h"
 
+// Records the table tests put into each block
+static int const RECORDS_PER_BLOCK = 64;
 
 static void test_record()
 {
     std::cout << "[i] Testing record functionality." << std::endl;
 
     // create attributes
-    std::string record_id = "0000000001";
+    RecordId record_id = Block::create_record_id(0, 1);
     int a1 = 1;
     std::string a2 = "Test";
     bool a3 = true;
@@ -33,218 +54,2063 @@ static void test_record()
     assert(record->get_integer_attribute(1) == a1);
     assert(record->get_string_attribute(2) == a2);
     assert(record->get_boolean_attribute(3) == a3);
+
+    // check that a view reads the same data without copying it
+    RecordView view = record->get_view();
+    assert(view.get_data() == record->get_data().get());
+    assert(view.get_record_id() == record_id);
+    assert(view.get_integer_attribute(1) == a1);
+    assert(view.get_string_attribute(2) == a2);
+    assert(view.get_boolean_attribute(3) == a3);
+
+    // check that materializing a view copies the data
+    std::shared_ptr<Record> copy = view.materialize();
+    assert(copy->get_data() != record->get_data());
+    assert(copy->get_size() == record->get_size());
+    assert(copy->get_string_attribute(2) == a2);
+}
+
+static void test_record_hash()
+{
+    std::cout << "[i] Testing record hash functionality." << std::endl;
+
+    std::vector<Record::Attribute> attributes = {(int) 42, (std::string) "Hash me in place", true, (uint64_t) 7};
+    Record record(1, attributes);
+    Record other(2, attributes);
+    RecordView view = record.get_view();
+    assert(view.get_attribute_count() == 4);
+
+    // the record id is not part of the hash
+    assert(RecordHash::hash_record(view) == RecordHash::hash_record(other.get_view()));
+
+    // attributes have the same hash in records, tuples and attribute lists
+    Schema schema({"int", "string", "bool", "id"});
+    std::vector<char> data(schema.get_encoded_size(attributes));
+    schema.encode(data.data(), attributes);
+    TupleView tuple(schema, data.data(), data.size(), 1);
+
+    for (int position = 1; position <= 4; position++)
+    {
+        assert(RecordHash::hash_attribute(view, position) == RecordHash::hash_attribute(attributes.at(position - 1)));
+        assert(RecordHash::hash_attribute(tuple, position) == RecordHash::hash_attribute(attributes.at(position - 1)));
+    }
+
+    assert(RecordHash::hash_record(tuple) == RecordHash::hash_record(view));
+    assert(RecordHash::hash_record(attributes) == RecordHash::hash_record(view));
+    assert(RecordHash::hash_attributes(view, {2, 1}) == RecordHash::hash_attributes(attributes, {2, 1}));
+
+    // multi-column hashes depend on the values and on the order of the columns
+    assert(RecordHash::hash_attributes(view, {1, 2}) != RecordHash::hash_attributes(view, {2, 1}));
+    assert(RecordHash::hash_record(view) != RecordHash::hash_record(Record(1, {(int) 43, (std::string) "Hash me in place", true, (uint64_t) 7}).get_view()));
+    assert(RecordHash::hash_record(Record(1, {(std::string) "ab", (std::string) "c"}).get_view()) !=
+           RecordHash::hash_record(Record(1, {(std::string) "a", (std::string) "bc"}).get_view()));
+    assert(RecordHash::hash("", 0) != RecordHash::hash("\0", 1));
+
+    // batches give the hashes of the single records
+    std::vector<std::shared_ptr<Record>> records;
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int i = 0; i < 100; i++)
+    {
+        tuples.push_back({i, (std::string) "Record " + std::to_string(i)});
+        records.push_back(std::make_shared<Record>(Record(i, tuples.back())));
+    }
+
+    std::vector<uint64_t> hashes;
+    RecordHash::hash_batch(records, {}, hashes);
+    assert(hashes.size() == records.size());
+
+    for (size_t i = 0; i < records.size(); i++)
+        assert(hashes.at(i) == RecordHash::hash_record(records.at(i)->get_view()));
+
+    RecordHash::hash_batch(tuples, {2}, hashes);
+
+    for (size_t i = 0; i < tuples.size(); i++)
+        assert(hashes.at(i) == RecordHash::hash_attributes(records.at(i)->get_view(), {2}));
+
+    std::sort(hashes.begin(), hashes.end());
+    assert(std::unique(hashes.begin(), hashes.end()) == hashes.end());
+}
+
+static void test_schema()
+{
+    std::cout << "[i] Testing schema functionality." << std::endl;
+
+    // check that fixed-width attributes take their width only
+    Schema small_schema({"int", "bool"});
+    assert(small_schema.get_fixed_size() == 5);
+    assert(small_schema.get_encoded_size({(int) 1, (bool) true}) == 5);
+    assert(Record::get_encoded_size({(int) 1, (bool) true}) > 30);
+
+    // check that tuples are decoded as they were encoded
+    Schema schema({"int", "string", "bool", "id", "string"});
+    std::vector<Record::Attribute> attributes = {(int) -7, (std::string) "Schema", (bool) true, (uint64_t) 1234567890123, (std::string) ""};
+    int size = schema.get_encoded_size(attributes);
+    assert(size == schema.get_fixed_size() + 6);
+
+    std::vector<char> data(size);
+    schema.encode(data.data(), attributes);
+    assert(schema.decode(data.data()) == attributes);
+
+    TupleView view(schema, data.data(), size, 42);
+    assert(view.get_record_id() == 42 && view.get_id_attribute(0) == 42);
+    assert(view.get_integer_attribute(1) == -7);
+    assert(view.get_string_attribute(2) == "Schema");
+    assert(view.get_boolean_attribute(3));
+    assert(view.get_id_attribute(4) == 1234567890123);
+    assert(view.get_string_attribute(5).empty());
+
+    std::shared_ptr<Record> record = view.materialize();
+    assert(record->get_record_id() == 42);
+    assert(record->get_string_attribute(2) == "Schema");
+
+    // check that wrong tuples are rejected
+    try
+    {
+        schema.get_encoded_size({(int) 1});
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    try
+    {
+        small_schema.get_encoded_size({(bool) true, (int) 1});
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    // check that blocks hold more tuples than records
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::vector<std::vector<Record::Attribute>> tuples(1000, {(int) 1, (bool) false});
+
+    Block record_block(storage, 1);
+    Block tuple_block(storage, 2);
+    int n_records = record_block.add_records(tuples, 0).size();
+    std::vector<RecordId> record_ids = tuple_block.add_tuples(small_schema, tuples, 0);
+    assert((int) record_ids.size() > 2 * n_records);
+
+    std::optional<RecordId> record_id = tuple_block.add_tuple(small_schema, {(int) 2, (bool) true});
+    assert(!record_id.has_value() || tuple_block.get_tuple_view(small_schema, record_id.value())->get_integer_attribute(1) == 2);
+    assert(tuple_block.get_tuple_view(small_schema, record_ids.at(10))->get_integer_attribute(1) == 1);
+
+    // check that tables of tuples are scanned and filtered like tables of records
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(10, storage);
+    std::shared_ptr<Schema> table_schema = std::make_shared<Schema>(std::vector<std::string>{"int", "string"});
+    TableAppender appender(buffer, table_schema);
+    tuples.clear();
+
+    for (int i = 0; i < 500; i++)
+        tuples.push_back({(int) i, (std::string) (i % 2 == 0 ? "even" : "odd")});
+
+    record_ids = appender.append(tuples);
+    appender.close();
+
+    Table table(buffer, appender.get_block_ids(), table_schema);
+    table.push_filter(2, "string", (std::string) "odd", "==");
+    int n_selected = 0;
+
+    assert(table.open());
+    for (record = table.next(); record != nullptr; record = table.next())
+    {
+        assert(record->get_integer_attribute(1) % 2 == 1);
+        assert(record->get_record_id() == record_ids.at(record->get_integer_attribute(1)));
+        n_selected++;
+    }
+    assert(n_selected == 250);
+    assert(table.close());
+}
+
+static void test_block()
+{
+    std::cout << "[i] Testing block functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    // create block
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    PageId block_id = 0;
+
+    std::shared_ptr<Block> block = std::make_shared<Block>(Block(storage, block_id));
+    std::vector<RecordId> record_ids;
+    int empty_free_space = block->get_free_space();
+
+    // check that we can insert records until the block is full
+    std::shared_ptr<Record> added_record = block->add_record({(int) 0, (std::string) "Test", (bool) true});
+
+    while (added_record != nullptr)
+    {
+        record_ids.push_back(added_record->get_record_id());
+        added_record = block->add_record({(int) record_ids.size(), (std::string) "Test", (bool) true});
+    }
+
+    // check that more records than the old fixed dictionary size fit
+    int n_records = record_ids.size();
+    assert(n_records > 64);
+    assert(block->get_record_count() == n_records);
+    assert(block->is_dirty());
+    assert(block->add_record({(int) -1, (std::string) "Test", (bool) true}) == nullptr);
+
+    // check that deleted slots are reused and the space of the last record is reclaimed
+    assert(block->delete_record(record_ids.at(3)));
+    assert(block->delete_record(record_ids.back()));
+    record_ids.pop_back();
+    n_records--;
+
+    assert(block->add_record({(int) 3, (std::string) "Test", (bool) true})->get_record_id() == record_ids.at(3));
+    assert(block->get_record_count() == n_records);
+
+    // check that we can correctly retrieve, update and delete all records
+    for (int i = 0; i < n_records; i++)
+    {
+        RecordId record_id = record_ids.at(i);
+        std::shared_ptr<Record> record = block->get_record(record_id);
+        // check that we found the record
+        assert(record != nullptr);
+
+        // check that data is correctly contained
+        assert(record->get_record_id() == record_id);
+        assert(record->get_integer_attribute(1) == i);
+        assert(record->get_string_attribute(2) == "Test");
+        assert(record->get_boolean_attribute(3) == true);
+
+        // check that the view reads the record from the block
+        std::optional<RecordView> view = block->get_record_view(record_id);
+        assert(view.has_value());
+        assert(view->get_record_id() == record_id);
+        assert(view->get_string_attribute(2) == "Test");
+
+        // check that the data can be changed
+        std::shared_ptr<Record> updated_record = std::make_shared<Record>(Record(record_id, {(int) i, (std::string) "test", (bool) false}));
+        block->update_record(updated_record);
+        record = block->get_record(record_id);
+
+        // check that data is correctly contained
+        assert(record->get_record_id() == record_id);
+        assert(record->get_integer_attribute(1) == i);
+        assert(record->get_string_attribute(2) == "test");
+        assert(record->get_boolean_attribute(3) == false);
+
+        // check that the record can be deleted
+        assert(block->delete_record(record_id));
+        assert(block->get_record(record_id) == nullptr);
+    }
+
+    assert(block->get_record_count() == 0);
+    assert(block->get_free_space() == empty_free_space);
+
+    // check that record ids can address more than 99,999 blocks
+    RecordId record_id = Block::create_record_id(1000000, 42);
+    assert(Block::get_block_id(record_id) == 1000000);
+    assert(Block::get_block_dictionary_offset(record_id) == 42);
+}
+
+static void test_block_compaction()
+{
+    std::cout << "[i] Testing block compaction functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<Block> block = std::make_shared<Block>(Block(storage, 0));
+    std::vector<RecordId> record_ids;
+
+    // fill the block
+    std::shared_ptr<Record> added_record = block->add_record({(int) 0, (std::string) "Test"});
+
+    while (added_record != nullptr)
+    {
+        record_ids.push_back(added_record->get_record_id());
+        added_record = block->add_record({(int) record_ids.size(), (std::string) "Test"});
+    }
+
+    // delete every second record, which leaves holes all over the block
+    for (size_t i = 0; i < record_ids.size(); i += 2)
+        assert(block->delete_record(record_ids.at(i)));
+
+    // check that a record can grow beyond the free space once the block is compacted
+    RecordId record_id = record_ids.at(1);
+    std::string long_string(block->get_free_space() + 100, 'x');
+    assert(block->update_record(std::make_shared<Record>(Record(record_id, {(int) 1, long_string}))));
+    assert(block->get_record(record_id)->get_string_attribute(2) == long_string);
+
+    // check that the other records were moved correctly
+    for (int i = 3; i < (int) record_ids.size(); i += 2)
+    {
+        std::shared_ptr<Record> record = block->get_record(record_ids.at(i));
+        assert(record->get_record_id() == record_ids.at(i));
+        assert(record->get_integer_attribute(1) == i);
+        assert(record->get_string_attribute(2) == "Test");
+    }
+
+    // check that records larger than the block are rejected and the old record is kept
+    std::string too_long_string(Block::BLOCK_SIZE, 'y');
+    assert(!block->update_record(std::make_shared<Record>(Record(record_id, {(int) 1, too_long_string}))));
+    assert(block->get_record(record_id)->get_string_attribute(2) == long_string);
+}
+
+static void test_bulk_insert()
+{
+    std::cout << "[i] Testing bulk insert functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int i = 0; i < 1000; i++)
+        tuples.push_back({(int) i, (std::string) "Bulk", (bool) (i % 2 == 0)});
+
+    // check that a block takes tuples until it is full
+    Block block(storage, 1);
+    std::vector<RecordId> record_ids = block.add_records(tuples, 0);
+    assert(!record_ids.empty() && record_ids.size() < tuples.size());
+    assert(block.get_record_count() == (int) record_ids.size());
+    assert(block.add_record(tuples.at(0)) == nullptr);
+
+    for (size_t i = 0; i < record_ids.size(); i++)
+    {
+        assert(record_ids.at(i) == Block::create_record_id(1, i));
+        std::shared_ptr<Record> record = block.get_record(record_ids.at(i));
+        assert(record->get_record_id() == record_ids.at(i));
+        assert(record->get_integer_attribute(1) == (int) i);
+        assert(record->get_string_attribute(2) == "Bulk");
+        assert(record->get_boolean_attribute(3) == (i % 2 == 0));
+    }
+
+    // check that freed slots are filled first, starting at the given tuple
+    assert(block.delete_record(record_ids.at(3)));
+    assert(block.delete_record(record_ids.at(70)));
+    std::vector<RecordId> refilled = block.add_records(tuples, 500);
+    assert(refilled.size() == 2);
+    assert(refilled.at(0) == record_ids.at(3) && refilled.at(1) == record_ids.at(70));
+    assert(block.get_record(refilled.at(1))->get_integer_attribute(1) == 501);
+
+    // check that the appender fills and allocates blocks in order
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(10, storage);
+    TableAppender appender(buffer);
+
+    record_ids = appender.append(std::vector<std::vector<Record::Attribute>>(tuples.begin(), tuples.begin() + 300));
+    std::vector<RecordId> more_ids = appender.append(std::vector<std::vector<Record::Attribute>>(tuples.begin() + 300, tuples.end()));
+    record_ids.insert(record_ids.end(), more_ids.begin(), more_ids.end());
+    appender.close();
+    assert(record_ids.size() == tuples.size());
+    assert(appender.get_block_ids().size() > 1);
+
+    Table table(buffer, appender.get_block_ids());
+    int n_records = 0;
+
+    assert(table.open());
+    for (std::shared_ptr<Record> record = table.next(); record != nullptr; record = table.next())
+    {
+        assert(record->get_record_id() == record_ids.at(n_records));
+        assert(record->get_integer_attribute(1) == n_records);
+        n_records++;
+    }
+    assert(n_records == (int) tuples.size());
+    assert(table.close());
+
+    // check that a tuple larger than a block is rejected
+    try
+    {
+        appender.append({{(std::string) std::string(Block::BLOCK_SIZE, 'x')}});
+        assert(false);
+    } catch (std::invalid_argument const& e)
+    {
+        appender.close();
+    }
+}
+
+static void test_block_read_write()
+{
+    std::cout << "[i] Testing block read/write functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    // check that block does not exist yet
+    PageId block_id = 1;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<Block> block = std::make_shared<Block>(Block(storage, block_id));
+    std::vector<RecordId> record_ids;
+
+    // add dummy records
+    for (int i = 0; i < RECORDS_PER_BLOCK; i++)
+        record_ids.push_back(block->add_record({(int) i, (std::string) "Test", (bool) true})->get_record_id());
+
+    // write block
+    assert(block->is_dirty());
+    block->write_data();
+    assert(!block->is_dirty());
+
+    // check that block can be read
+    assert(storage->page_exists(block_id));
+
+    // reload block and check its contents
+    block = std::make_shared<Block>(Block(storage, block_id));
+    assert(!block->is_dirty());
+
+    for (int i = 0; i < RECORDS_PER_BLOCK; i++)
+    {
+        RecordId record_id = record_ids.at(i);
+        std::shared_ptr<Record> record = block->get_record(record_id);
+
+        // check that data is correctly contained
+        assert(record->get_record_id() == record_id);
+        assert(record->get_integer_attribute(1) == i);
+        assert(record->get_string_attribute(2) == "Test");
+        assert(record->get_boolean_attribute(3) == true);
+    }
+
+    // delete the block
+    assert(storage->erase_page(block_id));
+    assert(!storage->page_exists(block_id));
+}
+
+static void test_page_geometry()
+{
+    std::cout << "[i] Testing page geometry functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    int previous_records = 0;
+    int previous_fanout = 0;
+
+    for (int page_size : {4096, 16384, 65536})
+    {
+        std::string directory = Block::BLOCK_DIR + "pages_" + std::to_string(page_size) + "/";
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(directory, page_size);
+
+        // fill a block, larger pages hold more records
+        std::shared_ptr<Block> block = std::make_shared<Block>(Block(storage, 1));
+        assert(block->get_block_size() == page_size);
+        assert(block->get_max_records() == Block::get_max_records(page_size));
+
+        int n_records = 0;
+
+        while (block->add_record({(int) n_records, (std::string) "Test", (bool) true}) != nullptr)
+            n_records++;
+
+        assert(n_records > previous_records);
+        previous_records = n_records;
+
+        // check that the whole page is written and read
+        block->write_data();
+        block = std::make_shared<Block>(Block(storage, 1));
+        assert(block->get_record_count() == n_records);
+        assert(block->get_record(Block::create_record_id(1, n_records - 1))->get_integer_attribute(1) == n_records - 1);
+        assert(storage->erase_page(1));
+
+        // the index fanout grows with the page size
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(10, storage));
+        std::shared_ptr<BPTree> bptree = std::make_shared<BPTree>(buffer, buffer->create_new_block());
+        BPTreeNode root(buffer, bptree->get_root_node_id());
+
+        assert(root.get_max_values() == BPTreeNode::get_max_values(page_size));
+        assert(root.get_max_values() > previous_fanout);
+        previous_fanout = root.get_max_values();
+
+        for (int i = 0; i < 500; i++)
+            assert(bptree->insert_record(i, Block::create_record_id(INVALID_PAGE_ID, i)));
+
+        for (int i = 0; i < 500; i++)
+            assert(bptree->search_record(i) == Block::create_record_id(INVALID_PAGE_ID, i));
+
+        assert(bptree->erase());
+    }
+
+    // the page size is stored with the database and cannot be changed
+    std::string directory = Block::BLOCK_DIR + "pages_16384/";
+    assert(StorageManager::read_page_size(directory) == 16384);
+    assert(StorageManager(directory).get_page_size() == 16384);
+
+    try
+    {
+        StorageManager storage(directory, 4096);
+        assert(false);
+    } catch (std::invalid_argument const& e)
+    {
+        assert(true);
+    }
+
+    // page sizes must be powers of two between 4K and 64K
+    try
+    {
+        StorageManager storage(Block::BLOCK_DIR + "pages_invalid/", 5000);
+        assert(false);
+    } catch (std::invalid_argument const& e)
+    {
+        assert(true);
+    }
+}
+
+static void test_direct_io()
+{
+    std::cout << "[i] Testing direct I/O functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE, StorageManager::Mode::DIRECT);
+    assert(storage->is_direct_io());
+
+    // page buffers are aligned
+    std::shared_ptr<void> page = storage->allocate_page();
+    assert(reinterpret_cast<uintptr_t>(page.get()) % StorageManager::PAGE_ALIGNMENT == 0);
+
+    // evicted blocks are written and read again with direct I/O
+    int n_cached_blocks = 5;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks, storage));
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 4 * n_cached_blocks; i++)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(buffer->create_new_block());
+        block_ids.push_back(block->get_block_id());
+
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+            block->add_record({(int) i, (std::string) "Direct", (bool) (k % 2 == 0)});
+
+        buffer->unfix_block(block->get_block_id());
+    }
+
+    for (int i = 0; i < (int) block_ids.size(); i++)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(i));
+        assert(block->get_record_count() == RECORDS_PER_BLOCK);
+
+        std::shared_ptr<Record> record = block->get_record(Block::create_record_id(block_ids.at(i), RECORDS_PER_BLOCK - 1));
+        assert(record->get_integer_attribute(1) == i);
+        assert(record->get_string_attribute(2) == "Direct");
+
+        buffer->unfix_block(block_ids.at(i));
+    }
+
+    // unaligned buffers are copied through an aligned page
+    std::vector<char> unaligned(Block::BLOCK_SIZE + 1);
+    assert(storage->read_page(block_ids.at(0), unaligned.data() + 1));
+    assert(storage->write_page(block_ids.at(0), unaligned.data() + 1));
+    assert(buffer->erase_block(block_ids.at(0)));
+    assert(!buffer->block_exists(block_ids.at(0)));
+}
+
+static void test_async_io()
+{
+    std::cout << "[i] Testing asynchronous I/O functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::cout << "    io_uring " << (storage->is_async_io() ? "available" : "not available, using synchronous I/O") << std::endl;
+
+    // requests without a ring are executed synchronously
+    AsyncIo sync_io(0);
+    assert(!sync_io.is_available());
+
+    std::string path = Block::BLOCK_DIR + "async_test";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    char text[] = "async";
+
+    assert(sync_io.queue_write(fd, text, sizeof(text), 0, 7));
+    std::vector<AsyncIo::Completion> completions = sync_io.wait(1);
+    assert(completions.size() == 1 && completions.at(0).tag == 7 && completions.at(0).result == sizeof(text));
+    close(fd);
+
+    // evicted blocks are written in the background
+    int n_cached_blocks = 5;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks, storage));
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 4 * n_cached_blocks; i++)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(buffer->create_new_block());
+        block_ids.push_back(block->get_block_id());
+
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+            block->add_record({(int) i, (std::string) "Async", (bool) true});
+
+        buffer->unfix_block(block->get_block_id());
+    }
+
+    // prefetch more blocks than fit into the cache, only as many as frames are read ahead
+    std::vector<PageId> first_blocks(block_ids.begin(), block_ids.begin() + 2 * n_cached_blocks);
+    assert(buffer->prefetch_blocks(first_blocks) == n_cached_blocks);
+
+    for (int i = 0; i < (int) block_ids.size(); i++)
+    {
+        // request the next block while reading the current one
+        if (i + 1 < (int) block_ids.size())
+            buffer->prefetch_block(block_ids.at(i + 1));
+
+        std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(i));
+        assert(block->get_record_count() == RECORDS_PER_BLOCK);
+        assert(block->get_record(Block::create_record_id(block_ids.at(i), 0))->get_integer_attribute(1) == i);
+        buffer->unfix_block(block_ids.at(i));
+    }
+
+    // prefetching a missing block creates a new one on fix
+    PageId missing_block_id = block_ids.back() + 1;
+    assert(buffer->prefetch_block(missing_block_id));
+    std::shared_ptr<Block> block = buffer->fix_block(missing_block_id);
+    assert(block->get_record_count() == 0 && block->is_dirty());
+    buffer->unfix_block(missing_block_id);
+
+    // prefetched blocks can be erased
+    assert(buffer->prefetch_block(block_ids.at(0)));
+    assert(buffer->erase_block(block_ids.at(0)));
+    assert(!buffer->block_exists(block_ids.at(0)));
+
+    // asynchronous reads report missing pages
+    assert(storage->read_page_async(block_ids.at(0), storage->allocate_page()));
+    storage->submit_pages();
+    assert(!storage->wait_page(block_ids.at(0)));
+
+    // a dirty block that cannot be written when it is evicted stays dirty in the cache
+    buffer = std::make_shared<BufferManager>(BufferManager(2, storage));
+    PageId dirty_block_id = buffer->create_new_block();
+    PageId clean_block_id = buffer->create_new_block();
+    PageId other_block_id = buffer->create_new_block();
+    assert(buffer->flush());
+
+    block = buffer->fix_block(dirty_block_id);
+    RecordId record_id = block->add_record({(int) 1, (std::string) "Unwritten", (bool) true})->get_record_id();
+    buffer->unfix_block(dirty_block_id);
+    buffer->fix_block(clean_block_id);
+    buffer->unfix_block(clean_block_id);
+
+    // files cannot grow, so all page writes fail
+    void (*signal_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    rlimit file_size_limit;
+    getrlimit(RLIMIT_FSIZE, &file_size_limit);
+    rlimit no_file_size = file_size_limit;
+    no_file_size.rlim_cur = 0;
+    setrlimit(RLIMIT_FSIZE, &no_file_size);
+
+    bool failed = false;
+
+    try {
+        buffer->fix_block(other_block_id);
+    } catch (std::runtime_error const&) {
+        failed = true;
+    }
+
+    setrlimit(RLIMIT_FSIZE, &file_size_limit);
+    signal(SIGXFSZ, signal_handler);
+
+    assert(failed);
+    assert(buffer->is_cached(dirty_block_id) && block->is_dirty());
+
+    // the change is written later
+    assert(buffer->flush());
+    buffer = std::make_shared<BufferManager>(BufferManager(2, storage));
+    assert(buffer->get_record(record_id)->get_string_attribute(2) == "Unwritten");
+
+    // a page that cannot be read completely is not mistaken for a missing one, which would be written back empty
+    PageId torn_block_id = other_block_id + 100;
+    std::string segment_path = Block::BLOCK_DIR + StorageManager::SEGMENT_PREFIX + "0";
+    assert(truncate(segment_path.c_str(), (off_t) torn_block_id * Block::BLOCK_SIZE + Block::BLOCK_SIZE / 2) == 0);
+
+    for (bool prefetch : {false, true})
+    {
+        if (prefetch)
+            assert(buffer->prefetch_block(torn_block_id));
+
+        failed = false;
+
+        try {
+            buffer->fix_block(torn_block_id);
+        } catch (std::runtime_error const&) {
+            failed = true;
+        }
+
+        assert(failed && !buffer->is_cached(torn_block_id));
+    }
+
+    failed = false;
+
+    try {
+        storage->read_page(torn_block_id, storage->allocate_page().get());
+    } catch (std::runtime_error const&) {
+        failed = true;
+    }
+
+    assert(failed);
+}
+
+static void test_mapped_database()
+{
+    std::cout << "[i] Testing mapped database functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    // only existing databases can be mapped
+    try
+    {
+        StorageManager storage(Block::BLOCK_DIR, StorageManager::Mode::MAPPED);
+        assert(false);
+    } catch (std::invalid_argument const& e)
+    {
+        assert(true);
+    }
+
+    // create a table and an index
+    int n_cached_blocks = 10;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 20; i++)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(buffer->create_new_block());
+        block_ids.push_back(block->get_block_id());
+
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+            block->add_record({(int) k, (std::string) "Mapped", (bool) (k % 2 == 0)});
+
+        buffer->unfix_block(block->get_block_id());
+    }
+
+    std::shared_ptr<BPTree> bptree = std::make_shared<BPTree>(buffer, buffer->create_new_block());
+
+    for (int i = 0; i < 200; i++)
+        assert(bptree->insert_record(i, Block::create_record_id(block_ids.at(i % 20), i % RECORDS_PER_BLOCK)));
+
+    assert(buffer->flush());
+
+    // open the database read-only
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, StorageManager::Mode::MAPPED);
+    std::shared_ptr<BufferManager> mapped = std::make_shared<BufferManager>(BufferManager(n_cached_blocks, storage));
+
+    assert(storage->is_read_only());
+    assert(storage->get_mapped_page(block_ids.at(0)) != nullptr);
+
+    // scans and selections read the mapped pages
+    std::shared_ptr<Table> table = std::make_shared<Table>(Table(mapped, block_ids));
+    std::shared_ptr<Selection> selection = std::make_shared<Selection>(Selection(mapped, table, 1, "int", (int) 5, "=="));
+    int n_records = 0;
+
+    assert(selection->open());
+
+    for (std::shared_ptr<Record> record = selection->next(); record != nullptr; record = selection->next())
+    {
+        assert(record->get_string_attribute(2) == "Mapped");
+        n_records++;
+    }
+
+    assert(selection->close());
+    assert(n_records == 20);
+
+    // index lookups
+    std::shared_ptr<BPTree> mapped_bptree = std::make_shared<BPTree>(mapped, bptree->get_root_node_id());
+
+    for (int i = 0; i < 200; i++)
+        assert(mapped_bptree->search_record(i) == Block::create_record_id(block_ids.at(i % 20), i % RECORDS_PER_BLOCK));
+
+    // blocks are views of the mapping and cannot be changed
+    std::shared_ptr<Block> block = mapped->fix_block(block_ids.at(0));
+    assert(block->get_data() == mapped->fix_block(block_ids.at(0))->get_data());
+    assert(block->is_read_only() && !block->is_dirty());
+    assert(block->add_record({(int) 0}) == nullptr);
+    assert(!block->delete_record(Block::create_record_id(block_ids.at(0), 0)));
+    assert(mapped->unfix_block(block_ids.at(0)) && mapped->unfix_block(block_ids.at(0)));
+    assert(mapped->fix_block(block_ids.back() + 1000) == nullptr);
+
+    // check that the views take no frames, however many blocks are used
+    for (PageId block_id : block_ids)
+        assert(mapped->fix_block(block_id) != nullptr && !mapped->is_cached(block_id));
+
+    assert(mapped->get_statistics().n_cached_frames == 0);
+
+    try
+    {
+        mapped->create_new_block();
+        assert(false);
+    } catch (std::runtime_error const& e)
+    {
+        assert(true);
+    }
+}
+
+static void test_buffer_manager()
+{
+    std::cout << "[i] Testing buffer manager functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    // create 100 filled blocks
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    int n_blocks = 100;
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < n_blocks; i++)
+    {
+        PageId block_id = i + 2;
+
+        // create block
+        std::shared_ptr<Block> block = std::make_shared<Block>(Block(storage, block_id));
+        assert(block->is_dirty());
+        block_ids.push_back(block->get_block_id());
+
+        // fill block with dummy data
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+            block->add_record({(int) k, (std::string) "Test", (bool) true});
+
+        // write block
+        block->write_data();
+    }
+
+    int n_cached_blocks = 10;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks, storage));
+
+    // test fixing blocks
+    for (int i = 0; i < n_cached_blocks; i++)
+    {
+        PageId block_id = block_ids.at(i);
+        std::shared_ptr<Block> block = buffer->fix_block(block_id);
+        assert(block->get_block_id() == block_id);
+    }
+
+    // test that we cannot fix any more blocks
+    try
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(n_cached_blocks));
+        assert(false);
+    } catch (std::exception const& e)
+    {
+        assert(true);
+    }
+
+    // test fixing blocks multiple times
+    for (int i = 0; i < n_cached_blocks; i++)
+    {
+        PageId block_id = block_ids.at(i);
+        std::shared_ptr<Block> block = buffer->fix_block(block_id);
+        assert(block->get_block_id() == block_id);
+    }
+
+    // test that we need two unfixes to remove a block
+    for (int i = 0; i < n_cached_blocks; i++)
+    {
+        PageId block_id = block_ids.at(i);
+        assert(buffer->unfix_block(block_id));
+
+        // check that we cannot fix a new block yet
+        try
+        {
+            std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(n_cached_blocks + i));
+            assert(false);
+        } catch (std::exception const& e)
+        {
+            assert(true);
+        }
+
+        assert(buffer->unfix_block(block_id));
+
+        // test that we cannot unfix a third time
+        try {
+            buffer->unfix_block(block_id);
+            assert(false);
+        } catch (std::exception const& e)
+        {
+            assert(true);
+        }
+
+        // fix a new block
+        block_id = block_ids.at(n_cached_blocks + i);
+        std::shared_ptr<Block> block = buffer->fix_block(block_id);
+        assert(block->get_block_id() == block_id);
+    }
+
+    // unfix blocks
+    for (int i = 0; i < n_cached_blocks; i++)
+    {
+        PageId block_id = block_ids.at(n_cached_blocks + i);
+        assert(buffer->unfix_block(block_id));
+    }
+
+    // delete blocks
+    for (PageId block_id : block_ids)
+        assert(buffer->erase_block(block_id));
+
+    // check that all blocks are stored in a single segment file (next to the page size)
+    assert(std::distance(std::filesystem::directory_iterator(Block::BLOCK_DIR), std::filesystem::directory_iterator{}) == 2);
+    assert(std::filesystem::exists(Block::BLOCK_DIR + StorageManager::SEGMENT_PREFIX + "0"));
+
+    for (PageId block_id : block_ids)
+        assert(!buffer->block_exists(block_id));
+
+    // blocks that are fixed again cannot be evicted, the least recently unfixed block is
+    buffer = std::make_shared<BufferManager>(BufferManager(2));
+    PageId block_id1 = buffer->create_new_block();
+    PageId block_id2 = buffer->create_new_block();
+    PageId block_id3 = buffer->create_new_block();
+
+    std::shared_ptr<Block> block1 = buffer->fix_block(block_id1);
+    assert(buffer->unfix_block(block_id1));
+    assert(buffer->fix_block(block_id1) == block1);
+    buffer->fix_block(block_id2);
+
+    bool thrown = false;
+    try { buffer->fix_block(block_id3); } catch (std::runtime_error const&) { thrown = true; }
+    assert(thrown);
+
+    assert(buffer->unfix_block(block_id2));
+    assert(buffer->unfix_block(block_id1));
+    buffer->fix_block(block_id3);
+    assert(buffer->fix_block(block_id1) == block1);
+    assert(buffer->unfix_block(block_id1));
+    assert(buffer->unfix_block(block_id3));
+}
+
+static void test_replacement_policies()
+{
+    std::cout << "[i] Testing replacement policy functionality." << std::endl;
+
+    std::vector<ReplacementPolicy::Type> types = {ReplacementPolicy::Type::LRU, ReplacementPolicy::Type::CLOCK,
+        ReplacementPolicy::Type::TWO_QUEUE, ReplacementPolicy::Type::LRU_K, ReplacementPolicy::Type::ARC};
+
+    for (ReplacementPolicy::Type type : types)
+    {
+        // delete existing block path if present
+        if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+            std::filesystem::remove_all(Block::BLOCK_DIR);
+
+        std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+        std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(4, storage, nullptr, type);
+
+        // evicted blocks are written, whichever block the policy chooses
+        std::vector<PageId> block_ids;
+
+        for (int i = 0; i < 20; i++)
+        {
+            block_ids.push_back(buffer->create_new_block());
+            std::shared_ptr<Block> block = buffer->fix_block(block_ids.back());
+            block->add_record({i});
+            assert(buffer->unfix_block(block_ids.back()));
+
+            // uses of the first block make it hot
+            if (i % 3 == 0)
+            {
+                buffer->fix_block(block_ids.front());
+                assert(buffer->unfix_block(block_ids.front()));
+            }
+        }
+
+        for (int i = 0; i < 20; i++)
+        {
+            std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(i));
+            assert(block->get_record(Block::create_record_id(block_ids.at(i), 0))->get_integer_attribute(1) == i);
+            assert(buffer->unfix_block(block_ids.at(i)));
+        }
+
+        // fixed blocks are never evicted
+        for (int i = 0; i < 4; i++)
+            buffer->fix_block(block_ids.at(i));
+
+        bool thrown = false;
+        try { buffer->fix_block(block_ids.at(4)); } catch (std::runtime_error const&) { thrown = true; }
+        assert(thrown);
+
+        assert(buffer->unfix_block(block_ids.at(2)));
+        buffer->fix_block(block_ids.at(4));
+
+        for (PageId block_id : {block_ids.at(0), block_ids.at(1), block_ids.at(3), block_ids.at(4)})
+            assert(buffer->unfix_block(block_id));
+
+        // erased blocks leave the policy
+        assert(buffer->erase_block(block_ids.at(4)));
+        buffer->fix_block(block_ids.at(5));
+        assert(buffer->unfix_block(block_ids.at(5)));
+    }
+
+    // trace: index lookups (a hot inner node, then one of many leaves) between scans that fix every block once per record
+    std::vector<ReplacementPolicy::TraceEntry> trace;
+
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < 50; i++)
+        {
+            for (PageId block_id : {(PageId) (1 + i % 4), (PageId) (1000 + (round * 50 + i) * 7919 % 1000)})
+            {
+                trace.push_back({ReplacementPolicy::TraceEntry::Access::FIX, block_id});
+                trace.push_back({ReplacementPolicy::TraceEntry::Access::UNFIX, block_id});
+            }
+        }
+
+        for (PageId block_id = 100; block_id < 200; block_id++)
+        {
+            for (int record = 0; record < 10; record++)
+            {
+                trace.push_back({ReplacementPolicy::TraceEntry::Access::FIX, block_id});
+                trace.push_back({ReplacementPolicy::TraceEntry::Access::UNFIX, block_id});
+            }
+        }
+    }
+
+    ReplacementPolicy::SimulationResult lru = ReplacementPolicy::simulate(ReplacementPolicy::Type::LRU, 16, trace);
+    assert(lru.hits + lru.misses == trace.size() / 2);
+
+    // the scan replaces all hot blocks with LRU, but not with the scan resistant policies
+    for (ReplacementPolicy::Type type : {ReplacementPolicy::Type::TWO_QUEUE, ReplacementPolicy::Type::LRU_K, ReplacementPolicy::Type::ARC})
+    {
+        ReplacementPolicy::SimulationResult result = ReplacementPolicy::simulate(type, 16, trace);
+        assert(result.misses < lru.misses);
+        assert(result.get_hit_ratio() > lru.get_hit_ratio());
+    }
+
+    // fixed blocks are no candidates, all unfixed blocks are evicted before the policy runs out of victims
+    for (ReplacementPolicy::Type type : types)
+    {
+        std::shared_ptr<ReplacementPolicy> policy = ReplacementPolicy::create(type, 1000);
+
+        for (PageId block_id = 1; block_id <= 1000; block_id++)
+            policy->on_load(block_id);
+
+        for (PageId block_id = 501; block_id <= 1000; block_id++)
+            policy->on_unfix(block_id);
+
+        std::set<PageId> victims;
+
+        for (int i = 0; i < 500; i++)
+        {
+            PageId victim = policy->evict(2000 + i);
+            assert(victim > 500 && victim <= 1000 && victims.insert(victim).second);
+        }
+
+        assert(policy->evict(3000) == INVALID_PAGE_ID);
+        policy->on_unfix(1);
+        assert(policy->evict(3000) == 1);
+    }
+
+    // a cancelled eviction, e.g. of a block that could not be written, leaves the policy as it was before
+    for (ReplacementPolicy::Type type : types)
+    {
+        std::shared_ptr<ReplacementPolicy> cancelled = ReplacementPolicy::create(type, 8);
+        std::shared_ptr<ReplacementPolicy> policy = ReplacementPolicy::create(type, 8);
+
+        for (std::shared_ptr<ReplacementPolicy> const& p : {cancelled, policy})
+        {
+            for (PageId block_id = 1; block_id <= 8; block_id++)
+            {
+                p->on_load(block_id);
+                p->on_unfix(block_id);
+            }
+
+            // evicted and loaded again, 2Q and ARC consider the blocks hot
+            for (PageId block_id : {p->evict(9), p->evict(10)})
+            {
+                p->on_load(block_id);
+                p->on_unfix(block_id);
+            }
+
+            p->on_fix(3);
+            p->on_unfix(3);
+        }
+
+        PageId victim = cancelled->evict(11);
+        cancelled->on_eviction_cancelled(victim);
+
+        for (PageId block_id = 11; block_id <= 30; block_id++)
+        {
+            PageId expected = policy->evict(block_id);
+            assert(cancelled->evict(block_id) == expected);
+
+            // loads of evicted blocks find the same remembered blocks
+            for (std::shared_ptr<ReplacementPolicy> const& p : {cancelled, policy})
+            {
+                p->on_load(block_id % 2 == 0 ? expected : block_id);
+                p->on_unfix(block_id % 2 == 0 ? expected : block_id);
+            }
+        }
+    }
+
+    // recorded traces replay with the same hits
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(8, storage, nullptr, ReplacementPolicy::Type::CLOCK);
+    buffer->start_trace();
+
+    for (int i = 0; i < 30; i++)
+    {
+        PageId block_id = buffer->create_new_block();
+        buffer->fix_block(block_id);
+        buffer->unfix_block(block_id);
+    }
+
+    // the trace also contains the fixes of the meta block
+    std::vector<ReplacementPolicy::TraceEntry> recorded = buffer->stop_trace();
+    size_t n_fixes = std::count_if(recorded.begin(), recorded.end(), [](ReplacementPolicy::TraceEntry const& entry) {
+        return entry.access == ReplacementPolicy::TraceEntry::Access::FIX;
+    });
+    assert(n_fixes >= 30 && recorded.size() == 2 * n_fixes);
+
+    ReplacementPolicy::SimulationResult result = ReplacementPolicy::simulate(ReplacementPolicy::Type::CLOCK, 8, recorded);
+    assert(result.hits + result.misses == n_fixes);
+    assert(result.misses >= 30);
+}
+
+static void test_concurrent_buffer_manager()
+{
+    std::cout << "[i] Testing concurrent buffer manager functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(10, storage));
+
+    // a counter per block, more blocks than frames
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 16; i++)
+    {
+        block_ids.push_back(buffer->create_new_block());
+        buffer->fix_block(block_ids.back())->add_record({(int) 0});
+        buffer->unfix_block(block_ids.back());
+    }
+
+    // check that latched increments from parallel threads are not lost, while blocks are evicted and loaded again
+    int n_threads = 8;
+    int n_increments = 200;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < n_threads; i++)
+    {
+        threads.emplace_back([&buffer, &block_ids, n_increments, i]() {
+            for (int j = 0; j < n_increments; j++)
+            {
+                PageId block_id = block_ids.at((i * 7 + j) % block_ids.size());
+                RecordId record_id = Block::create_record_id(block_id, 0);
+
+                std::shared_ptr<Block> block = buffer->fix_block(block_id);
+                buffer->latch_block(block_id, true);
+
+                int value = block->get_record(record_id)->get_integer_attribute(1);
+                assert(block->update_record(std::make_shared<Record>(Record(record_id, {value + 1}))));
+
+                buffer->unlatch_block(block_id, true);
+                assert(buffer->unfix_block(block_id));
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    int sum = 0;
+
+    for (PageId block_id : block_ids)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(block_id);
+        buffer->latch_block(block_id, false);
+        sum += block->get_record(Block::create_record_id(block_id, 0))->get_integer_attribute(1);
+        buffer->unlatch_block(block_id, false);
+        buffer->unfix_block(block_id);
+    }
+
+    assert(sum == n_threads * n_increments);
+
+    // check that threads fixing the same missing block share one read of it
+    assert(buffer->flush());
+    buffer = std::make_shared<BufferManager>(BufferManager(10, storage));
+
+    std::vector<std::shared_ptr<Block>> blocks(n_threads);
+    threads.clear();
+
+    for (int i = 0; i < n_threads; i++)
+        threads.emplace_back([&buffer, &blocks, &block_ids, i]() { blocks.at(i) = buffer->fix_block(block_ids.front()); });
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (int i = 0; i < n_threads; i++)
+    {
+        assert(blocks.at(i) == blocks.front());
+        assert(buffer->unfix_block(block_ids.front()));
+    }
+
+    // all fixes are counted
+    try
+    {
+        buffer->unfix_block(block_ids.front());
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    try
+    {
+        buffer->latch_block(block_ids.front(), false);
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    // check that unfixed blocks can be erased while an eviction writes them
+    threads.clear();
+
+    threads.emplace_back([&buffer, &block_ids, n_increments]() {
+        for (int j = 0; j < n_increments; j++)
+        {
+            PageId block_id = block_ids.at(j % block_ids.size());
+            std::shared_ptr<Block> block = buffer->fix_block(block_id);
+            buffer->latch_block(block_id, true);
+            assert(block->update_record(std::make_shared<Record>(Record(Block::create_record_id(block_id, 0), {j}))));
+            buffer->unlatch_block(block_id, true);
+            assert(buffer->unfix_block(block_id));
+        }
+    });
+
+    threads.emplace_back([&buffer, n_increments]() {
+        for (int j = 0; j < n_increments; j++)
+        {
+            PageId block_id = buffer->create_new_block();
+            buffer->fix_block(block_id)->add_record({j});
+            assert(buffer->unfix_block(block_id));
+
+            // the other thread evicts the block in the meantime
+            std::this_thread::sleep_for(std::chrono::microseconds(j % 20 * 10));
+            assert(buffer->erase_block(block_id));
+        }
+    });
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // check that the storage manager reads and writes different pages in parallel, synchronously and asynchronously
+    threads.clear();
+
+    for (int i = 0; i < n_threads; i++)
+    {
+        threads.emplace_back([&storage, n_increments, i]() {
+            uint64_t page_number = 1000 + i;
+            std::shared_ptr<void> page = storage->allocate_page();
+
+            for (int j = 1; j <= n_increments; j++)
+            {
+                std::memset(page.get(), j, Block::BLOCK_SIZE);
+
+                if (j % 2 == 0)
+                    assert(storage->write_page(page_number, page.get()));
+                else
+                {
+                    assert(storage->write_page_async(page_number, page));
+                    storage->submit_pages();
+                    assert(storage->wait_page(page_number));
+                }
+
+                std::memset(page.get(), 0, Block::BLOCK_SIZE);
+                assert(storage->read_page(page_number, page.get()));
+                assert(static_cast<unsigned char*>(page.get())[Block::BLOCK_SIZE - 1] == j);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+static void test_background_writer()
+{
+    std::cout << "[i] Testing background writer functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(16, storage));
+
+    // dirty blocks, the first one stays fixed
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 8; i++)
+    {
+        block_ids.push_back(buffer->create_new_block());
+        buffer->fix_block(block_ids.back())->add_record({(int) i, (std::string) "Writer", (bool) true});
+
+        if (i > 0)
+            buffer->unfix_block(block_ids.back());
+    }
+
+    // 7 blocks and the meta block are above the ratio of 16 frames, the rest is written once it is old enough
+    buffer->start_writer(0.25, std::chrono::milliseconds(20));
+
+    for (int i = 0; i < 500 && buffer->get_written_block_count() < 8; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    buffer->stop_writer();
+    assert(buffer->get_written_block_count() == 8);
+
+    // check that the pages contain the records and that the fixed block is not written
+    for (int i = 1; i < 8; i++)
+    {
+        Block block(storage, block_ids.at(i));
+        assert(block.get_record_count() == 1);
+        assert(block.get_record(Block::create_record_id(block_ids.at(i), 0))->get_integer_attribute(1) == i);
+
+        assert(!buffer->fix_block(block_ids.at(i))->is_dirty());
+        buffer->unfix_block(block_ids.at(i));
+    }
+
+    assert(!storage->page_exists(block_ids.at(0)));
+    assert(buffer->fix_block(block_ids.at(0))->is_dirty());
+    buffer->unfix_block(block_ids.at(0));
+    buffer->unfix_block(block_ids.at(0));
+
+    // check that consecutive pages are written together
+    std::vector<std::shared_ptr<void>> pages;
+    std::vector<void const*> buffers;
+
+    for (int i = 1; i < 4; i++)
+    {
+        pages.push_back(storage->allocate_page());
+        assert(storage->read_page(block_ids.at(i), pages.back().get()));
+        buffers.push_back(pages.back().get());
+    }
+
+    assert(storage->write_pages(1000, buffers));
+
+    for (int i = 0; i < 3; i++)
+    {
+        std::shared_ptr<void> page = storage->allocate_page();
+        assert(storage->read_page(1000 + i, page.get()));
+        assert(std::memcmp(page.get(), buffers.at(i), Block::BLOCK_SIZE) == 0);
+    }
+}
+
+static void test_scan_rings()
+{
+    std::cout << "[i] Testing scan ring functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    // a ring gets a quarter of the frames
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(20));
+    assert(buffer->get_frame_count() == 20);
+
+    // a table that is bigger than the cache
+    std::vector<PageId> table_block_ids;
+
+    for (int i = 0; i < 100; i++)
+    {
+        std::shared_ptr<Block> block = buffer->fix_block(buffer->create_new_block());
+        table_block_ids.push_back(block->get_block_id());
+        block->add_record({(int) i, (std::string) "Scan", (bool) true});
+        buffer->unfix_block(block->get_block_id());
+    }
+
+    // hot blocks, e.g. index nodes
+    std::vector<PageId> hot_block_ids;
+
+    for (int i = 0; i < 10; i++)
+    {
+        hot_block_ids.push_back(buffer->create_new_block());
+        buffer->fix_block(hot_block_ids.back())->add_record({(int) i, (std::string) "Hot", (bool) false});
+        buffer->unfix_block(hot_block_ids.back());
+    }
+
+    // check that a table scan only replaces the blocks of its ring
+    int n_cached_table_blocks = 0;
+
+    for (PageId block_id : table_block_ids)
+        n_cached_table_blocks += buffer->is_cached(block_id);
+
+    std::shared_ptr<Table> table = std::make_shared<Table>(Table(buffer, table_block_ids));
+    assert(table->open());
+
+    for (int i = 0; i < 100; i++)
+        assert(table->next()->get_integer_attribute(1) == i);
+
+    assert(table->next() == nullptr);
+    assert(table->close());
+
+    for (PageId block_id : hot_block_ids)
+        assert(buffer->is_cached(block_id));
+
+    for (PageId block_id : table_block_ids)
+        n_cached_table_blocks -= buffer->is_cached(block_id);
+
+    assert(n_cached_table_blocks >= -5);
+
+    // check that a block that is used without the ring is kept
+    std::shared_ptr<BufferManager::Ring> ring = std::make_shared<BufferManager::Ring>(2);
+    buffer->fix_block(table_block_ids.at(0), ring);
+    buffer->unfix_block(table_block_ids.at(0));
+    buffer->fix_block(table_block_ids.at(0));
+    buffer->unfix_block(table_block_ids.at(0));
+
+    for (int i = 1; i < 4; i++)
+    {
+        buffer->fix_block(table_block_ids.at(i), ring);
+        buffer->unfix_block(table_block_ids.at(i));
+    }
+
+    assert(buffer->is_cached(table_block_ids.at(0)));
+    assert(!buffer->is_cached(table_block_ids.at(1)));
+    assert(buffer->is_cached(table_block_ids.at(2)));
+    assert(buffer->is_cached(table_block_ids.at(3)));
+
+    // check that a fixed block of the ring is not replaced
+    buffer->fix_block(table_block_ids.at(2));
+
+    for (int i = 4; i < 6; i++)
+    {
+        buffer->fix_block(table_block_ids.at(i), ring);
+        buffer->unfix_block(table_block_ids.at(i));
+    }
+
+    assert(buffer->is_cached(table_block_ids.at(2)));
+    buffer->unfix_block(table_block_ids.at(2));
+
+    // check that scans without a ring replace the other blocks
+    for (PageId block_id : table_block_ids)
+    {
+        buffer->fix_block(block_id);
+        buffer->unfix_block(block_id);
+    }
+
+    for (PageId block_id : hot_block_ids)
+        assert(!buffer->is_cached(block_id));
+
+    try
+    {
+        BufferManager::Ring ring(0);
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+}
+
+static void test_page_guard()
+{
+    std::cout << "[i] Testing page guard functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(10));
+    PageId block_id = buffer->create_new_block();
+
+    // check that the block is unfixed when the guard is destroyed
+    {
+        PageGuard guard(buffer, block_id);
+        assert(guard);
+        assert(guard->add_record({(int) 1, (std::string) "Guard", (bool) true}) != nullptr);
+
+        // check that a moved guard keeps the fix
+        PageGuard moved = std::move(guard);
+        assert(!guard);
+        assert(moved.get_block()->get_block_id() == block_id);
+    }
+
+    try
+    {
+        buffer->unfix_block(block_id);
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    // check that reset and assignment release the fix
+    PageGuard guard(buffer, block_id);
+    guard.reset();
+    assert(!guard);
+
+    guard = PageGuard(buffer, block_id);
+    guard = PageGuard(buffer, block_id);
+    guard = PageGuard();
+
+    try
+    {
+        buffer->unfix_block(block_id);
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+
+    // blocks with holes and forwarded records
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 4; i++)
+    {
+        PageGuard block(buffer, buffer->create_new_block());
+        block_ids.push_back(block->get_block_id());
+
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+            block->add_record({(int) (i * RECORDS_PER_BLOCK + k), (std::string) "Scan", (bool) (k % 2 == 0)});
+
+        for (int k = 1; k < RECORDS_PER_BLOCK; k += 2)
+            assert(block->delete_record(Block::create_record_id(block_ids.back(), k)));
+    }
+
+    // an empty block
+    block_ids.push_back(buffer->create_new_block());
+
+    // check that a scan fixes every block once and skips the empty slots
+    std::shared_ptr<Table> table = std::make_shared<Table>(Table(buffer, block_ids));
+    buffer->start_trace();
+    assert(table->open());
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int k = 0; k < RECORDS_PER_BLOCK; k += 2)
+        {
+            std::shared_ptr<Record> record = table->next();
+            assert(record->get_integer_attribute(1) == i * RECORDS_PER_BLOCK + k);
+            assert(record->get_boolean_attribute(3));
+        }
+    }
+
+    assert(table->next() == nullptr);
+    assert(table->close());
+
+    std::vector<ReplacementPolicy::TraceEntry> trace = buffer->stop_trace();
+    int n_fixes = 0;
+
+    for (ReplacementPolicy::TraceEntry const& entry : trace)
+        n_fixes += entry.access == ReplacementPolicy::TraceEntry::Access::FIX;
+
+    assert(n_fixes == (int) block_ids.size());
+    assert(trace.size() == 2 * block_ids.size());
+
+    // check that closing a scan in the middle of a block unfixes it
+    assert(table->open());
+    assert(table->next() != nullptr);
+    assert(table->close());
+
+    try
+    {
+        buffer->unfix_block(block_ids.at(0));
+        assert(false);
+    } catch (std::invalid_argument const& e) {}
+}
+
+static void test_buffer_statistics()
+{
+    std::cout << "[i] Testing buffer statistics functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(4));
+    std::vector<PageId> block_ids;
+
+    for (int i = 0; i < 6; i++)
+        block_ids.push_back(buffer->create_new_block());
+
+    buffer->set_page_type(block_ids.at(1), BufferManager::PageType::INDEX);
+    buffer->set_page_type(block_ids.at(2), BufferManager::PageType::TEMP);
+    buffer->reset_statistics();
+
+    // check that misses and hits are counted per page type
+    for (int i = 0; i < 3; i++)
+    {
+        buffer->fix_block(block_ids.at(i))->add_record({(int) i, (std::string) "Statistics", (bool) true});
+        buffer->fix_block(block_ids.at(i));
+    }
+
+    BufferManager::Statistics statistics = buffer->get_statistics();
+
+    for (BufferManager::PageType type : {BufferManager::PageType::TABLE, BufferManager::PageType::INDEX,
+                                         BufferManager::PageType::TEMP})
+    {
+        assert(statistics.get_counters(type).hits == 1);
+        assert(statistics.get_counters(type).misses == 1);
+    }
+
+    assert(statistics.get_hit_ratio() == 0.5);
+    assert(statistics.n_reads == 3);
+    assert(statistics.n_pinned_frames == 3);
+
+    // the meta block is cached as well
+    assert(statistics.n_cached_frames == 4);
+
+    for (int i = 0; i < 3; i++)
+    {
+        buffer->unfix_block(block_ids.at(i));
+        buffer->unfix_block(block_ids.at(i));
+    }
+
+    // check that evictions write the dirty blocks back, attributed to the fixes of this thread
+    BufferManager::Statistics scope_statistics = BufferManager::Statistics();
+
+    {
+        BufferManager::StatisticsScope scope(scope_statistics);
+
+        for (int i = 3; i < 6; i++)
+        {
+            buffer->fix_block(block_ids.at(i));
+            buffer->unfix_block(block_ids.at(i));
+        }
+    }
+
+    // fixes of other threads and after the scope are not attributed
+    std::thread([&buffer, &block_ids] {
+        buffer->fix_block(block_ids.at(5));
+        buffer->unfix_block(block_ids.at(5));
+    }).join();
+
+    buffer->fix_block(block_ids.at(5));
+    buffer->unfix_block(block_ids.at(5));
+
+    statistics = buffer->get_statistics();
+    assert(statistics.get_total().misses == 6);
+    assert(statistics.get_total().hits == 5);
+    assert(statistics.get_total().evictions == 3);
+    assert(statistics.get_total().dirty_writes == 3);
+    assert(statistics.get_counters(BufferManager::PageType::INDEX).dirty_writes == 1);
+    assert(statistics.n_writes == 3);
+    assert(statistics.n_pinned_frames == 0);
+
+    assert(scope_statistics.get_total().misses == 3);
+    assert(scope_statistics.get_total().hits == 0);
+    assert(scope_statistics.get_total().evictions == 3);
+    assert(scope_statistics.get_total().dirty_writes == 3);
+    assert(scope_statistics.n_reads == 3);
+
+    // check that flushes count their writes
+    buffer->fix_block(block_ids.at(5))->add_record({(int) 5, (std::string) "Statistics", (bool) true});
+    buffer->unfix_block(block_ids.at(5));
+    assert(buffer->flush());
+    assert(buffer->get_statistics().get_total().dirty_writes >= 4);
+
+    // check that the statistics can be reset
+    buffer->reset_statistics();
+    statistics = buffer->get_statistics();
+    assert(statistics.get_total().hits == 0);
+    assert(statistics.get_total().misses == 0);
+    assert(statistics.get_total().dirty_writes == 0);
+    assert(statistics.n_reads == 0 && statistics.n_writes == 0);
+    assert(statistics.get_hit_ratio() == 0);
+    assert(statistics.n_cached_frames == 4);
+
+    // check that erased blocks lose their type
+    assert(buffer->erase_block(block_ids.at(1)));
+    buffer->fix_block(block_ids.at(1));
+    buffer->unfix_block(block_ids.at(1));
+    assert(buffer->get_statistics().get_counters(BufferManager::PageType::TABLE).misses == 1);
 }
 
-static void test_block()
+static void test_block_reuse()
 {
-    std::cout << "[i] Testing block functionality." << std::endl;
+    std::cout << "[i] Testing block id reuse functionality." << std::endl;
 
     // delete existing block path if present
     if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
         std::filesystem::remove_all(Block::BLOCK_DIR);
 
-    // create block
-    std::string block_id = "00000";
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<LogManager> log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(10, storage, log);
 
-    std::shared_ptr<Block> block = std::make_shared<Block>(Block(block_id));
-    std::vector<std::string> record_ids;
+    // check that ids of a reserved batch are handed out without changing the meta block
+    std::vector<PageId> block_ids = {buffer->create_new_block()};
+    std::shared_ptr<Block> meta_block = buffer->fix_block(0);
+    uint64_t meta_lsn = meta_block->get_page_lsn();
 
-    // check that we can only insert MAX_RECORDS many records
-    for (int i = 0; i < Block::MAX_RECORDS; i++)
+    for (int i = 1; i < 20; i++)
     {
-        record_ids.push_back(block->add_record({(int) i, (std::string) "Test", (bool) true})->get_record_id());
+        block_ids.push_back(buffer->create_new_block());
+        assert(block_ids.at(i) == block_ids.at(i - 1) + 1);
     }
-    assert(block->is_dirty());
-    assert(block->add_record({-1}) == nullptr);
 
-    // check that we can correctly retrieve, update and delete all records
-    for (int i = 0; i < Block::MAX_RECORDS; i++)
-    {
-        std::string record_id = record_ids.at(i);
-        std::shared_ptr<Record> record = block->get_record(record_id);
-        // check that we found the record
-        assert(record != nullptr);
+    assert(meta_block->get_page_lsn() == meta_lsn);
+    buffer->unfix_block(0);
 
-        // check that data is correctly contained
-        assert(record->get_record_id() == record_id);
-        assert(record->get_integer_attribute(1) == i);
-        assert(record->get_string_attribute(2) == "Test");
-        assert(record->get_boolean_attribute(3) == true);
+    // check that erased ids are handed out again
+    for (PageId block_id : block_ids)
+    {
+        buffer->fix_block(block_id)->add_record({(int) 1, (std::string) "Reuse"});
+        buffer->unfix_block(block_id);
+    }
 
-        // check that the data can be changed
-        std::shared_ptr<Record> updated_record = std::make_shared<Record>(Record(record_id, {(int) i, (std::string) "test", (bool) false}));
-        block->update_record(updated_record);
-        record = block->get_record(record_id);
+    assert(buffer->erase_block(block_ids.at(3)));
+    assert(buffer->get_free_block_count() == 1);
+    assert(buffer->create_new_block() == block_ids.at(3));
+    assert(buffer->get_free_block_count() == 0);
+    assert(buffer->fix_block(block_ids.at(3))->get_record_count() == 0);
+    buffer->unfix_block(block_ids.at(3));
+
+    // check that the free list and the next id survive a restart
+    for (int i = 5; i < 10; i++)
+        assert(buffer->erase_block(block_ids.at(i)));
+
+    assert(buffer->flush());
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(10, storage, log);
+    assert(buffer->get_free_block_count() == 5);
+
+    std::vector<PageId> reused_ids;
+    for (int i = 0; i < 5; i++)
+        reused_ids.push_back(buffer->create_new_block());
+
+    std::sort(reused_ids.begin(), reused_ids.end());
+    assert(reused_ids == std::vector<PageId>(block_ids.begin() + 5, block_ids.begin() + 10));
+    assert(buffer->create_new_block() == block_ids.back() + 1);
+
+    // check that ids in the saved free list are not handed out twice after a crash
+    assert(buffer->erase_block(block_ids.at(0)));
+    assert(buffer->commit());
+    assert(buffer->create_new_block() == block_ids.at(0));
+    buffer->fix_block(block_ids.at(0))->add_record({(int) 2, (std::string) "Reused"});
+    buffer->unfix_block(block_ids.at(0));
+    assert(buffer->commit());
+
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(10, storage, log);
+    assert(buffer->create_new_block() != block_ids.at(0));
+
+    // check that a free list longer than the meta block continues in further blocks, also after it shrank
+    std::vector<PageId> erased_ids;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        erased_ids.push_back(buffer->create_new_block());
+        buffer->fix_block(erased_ids.back())->add_record({(int) i, (std::string) "Erased"});
+        buffer->unfix_block(erased_ids.back());
+    }
 
-        // check that data is correctly contained
-        assert(record->get_record_id() == record_id);
-        assert(record->get_integer_attribute(1) == i);
-        assert(record->get_string_attribute(2) == "test");
-        assert(record->get_boolean_attribute(3) == false);
+    for (PageId block_id : erased_ids)
+        assert(buffer->erase_block(block_id));
 
-        // check that the record can be deleted
-        assert(block->delete_record(record_id));
-        assert(block->get_record(record_id) == nullptr);
-    }
+    assert(buffer->flush());
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(10, storage, log);
+    assert(buffer->get_free_block_count() == (int) erased_ids.size());
+
+    reused_ids.clear();
+    for (size_t i = 0; i < erased_ids.size(); i++)
+        reused_ids.push_back(buffer->create_new_block());
+
+    std::sort(reused_ids.begin(), reused_ids.end());
+    assert(reused_ids == erased_ids);
+
+    assert(buffer->flush());
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(10, storage, log);
+    assert(buffer->get_free_block_count() == 0);
+    assert(std::find(erased_ids.begin(), erased_ids.end(), buffer->create_new_block()) == erased_ids.end());
+
+    // check that the free list of a checkpoint survives a crash without a commit
+    for (int i = 10; i < 15; i++)
+        assert(buffer->erase_block(block_ids.at(i)));
+
+    buffer->checkpoint();
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(10, storage, log);
+    assert(buffer->get_free_block_count() == 5);
 }
 
-static void test_block_read_write()
+static void test_record_relocation()
 {
-    std::cout << "[i] Testing block read/write functionality." << std::endl;
+    std::cout << "[i] Testing record relocation functionality." << std::endl;
 
     // delete existing block path if present
     if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
         std::filesystem::remove_all(Block::BLOCK_DIR);
 
-    // check that block does not exist yet
-    std::string block_id = "00001";
+    int n_cached_blocks = 10;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
+    std::shared_ptr<BPTree> bptree = std::make_shared<BPTree>(buffer, buffer->create_new_block());
 
-    // delete existing block path if present
-    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
-        std::filesystem::remove_all(Block::BLOCK_DIR);
+    // fill a block and index its records
+    PageId block_id = buffer->create_new_block();
+    std::shared_ptr<Block> block = buffer->fix_block(block_id);
+    std::vector<RecordId> record_ids;
+    std::shared_ptr<Record> added_record = block->add_record({(int) 0, (std::string) "Test"});
 
-    std::shared_ptr<Block> block = std::make_shared<Block>(Block(block_id));
-    std::vector<std::string> record_ids;
+    while (added_record != nullptr)
+    {
+        assert(bptree->insert_record(record_ids.size(), added_record->get_record_id()));
+        record_ids.push_back(added_record->get_record_id());
+        added_record = block->add_record({(int) record_ids.size(), (std::string) "Test"});
+    }
 
-    // add dummy records
-    for (int i = 0; i < Block::MAX_RECORDS; i++)
-        record_ids.push_back(block->add_record({(int) i, (std::string) "Test", (bool) true})->get_record_id());
+    buffer->unfix_block(block_id);
 
-    // write block
-    assert(block->is_dirty());
-    block->write_data();
-    assert(!block->is_dirty());
+    // grow a record beyond the space of its block
+    RecordId record_id = record_ids.at(5);
+    std::string long_string(Block::BLOCK_SIZE / 2, 'x');
+    assert(buffer->update_record(std::make_shared<Record>(Record(record_id, {(int) 5, long_string}))));
 
-    // check that block can be read
-    std::ifstream file(Block::BLOCK_DIR);
-    file = std::ifstream(Block::BLOCK_DIR);
-    assert(file.good());
+    // check that the index still finds the record with its old record id
+    assert(bptree->search_record(5) == record_id);
+    std::shared_ptr<Record> record = buffer->get_record(record_id);
+    assert(record->get_record_id() == record_id);
+    assert(record->get_string_attribute(2) == long_string);
 
-    // reload block and check its contents
-    block = std::make_shared<Block>(Block(block_id));
+    // grow the record again, so that it has to move once more
+    std::string longer_string(Block::BLOCK_SIZE * 3 / 4, 'y');
+    assert(buffer->update_record(std::make_shared<Record>(Record(record_id, {(int) 5, longer_string}))));
+    assert(buffer->get_record(record_id)->get_string_attribute(2) == longer_string);
 
-    for (int i = 0; i < Block::MAX_RECORDS; i++)
-    {
-        std::string record_id = record_ids.at(i);
-        std::shared_ptr<Record> record = block->get_record(record_id);
+    // check that a table scan returns every record once
+    std::shared_ptr<Table> table = std::make_shared<Table>(Table(buffer, {block_id}));
+    int n_records = 0;
 
-        // check that data is correctly contained
-        assert(record->get_record_id() == record_id);
-        assert(record->get_integer_attribute(1) == i);
-        assert(record->get_string_attribute(2) == "Test");
-        assert(record->get_boolean_attribute(3) == true);
+    assert(table->open());
+    for (record = table->next(); record != nullptr; record = table->next())
+    {
+        assert(record->get_record_id() == record_ids.at(n_records));
+        assert(record->get_integer_attribute(1) == n_records);
+        assert(record->get_string_attribute(2) == (n_records == 5 ? longer_string : "Test"));
+        n_records++;
     }
+    assert(n_records == (int) record_ids.size());
+    assert(table->close());
 
-    // delete the block
-    assert(std::remove((Block::BLOCK_DIR + block_id).c_str()) == 0);
+    // check that the moved record can be deleted
+    assert(buffer->delete_record(record_id));
+    assert(buffer->get_record(record_id) == nullptr);
+    assert(bptree->erase());
 }
 
-static void test_buffer_manager()
+static void test_write_ahead_log()
 {
-    std::cout << "[i] Testing buffer manager functionality." << std::endl;
+    std::cout << "[i] Testing write-ahead log functionality." << std::endl;
 
     // delete existing block path if present
     if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
         std::filesystem::remove_all(Block::BLOCK_DIR);
 
-    // create 100 filled blocks
-    int n_blocks = 100;
-    std::vector<std::string> block_ids;
-
-    for (int i = 0; i < n_blocks; i++)
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<LogManager> log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(2, storage, log);
+
+    // check that every change is logged and stamped into its page
+    PageId block_id = buffer->create_new_block();
+    std::shared_ptr<Block> block = buffer->fix_block(block_id);
+    uint64_t start_lsn = log->get_end_lsn();
+
+    std::shared_ptr<Record> record = block->add_record({(int) 1, (std::string) "Test"});
+    uint64_t insert_lsn = block->get_page_lsn();
+    assert(insert_lsn == start_lsn);
+
+    assert(block->update_record(std::make_shared<Record>(Record(record->get_record_id(), {(int) 2, (std::string) "Log"}))));
+    uint64_t update_lsn = block->get_page_lsn();
+    assert(update_lsn > insert_lsn);
+
+    assert(block->delete_record(record->get_record_id()));
+    assert(block->get_page_lsn() > update_lsn);
+    buffer->unfix_block(block_id);
+
+    // commit only forces the log, the changed block stays dirty in the cache
+    assert(log->get_flushed_lsn() <= insert_lsn);
+    assert(buffer->commit());
+    assert(log->get_flushed_lsn() == log->get_end_lsn());
+    assert(!storage->page_exists(block_id));
+
+    std::vector<LogManager::LogRecord> records = log->read_records(start_lsn);
+    assert(records.size() == 4);
+    assert(records.at(0).type == LogManager::Type::INSERT && records.at(0).page_id == block_id && records.at(0).slot == 0);
+    assert(records.at(1).type == LogManager::Type::UPDATE && records.at(1).lsn == update_lsn);
+    assert(RecordView(records.at(1).data.data()).get_string_attribute(2) == "Log");
+    assert(records.at(2).type == LogManager::Type::DELETE && records.at(2).data.empty());
+    assert(records.at(3).type == LogManager::Type::COMMIT);
+
+    // check that an evicted block is only written after its log records
+    block = buffer->fix_block(block_id);
+    block->add_record({(int) 3, (std::string) "Evicted"});
+    uint64_t page_lsn = block->get_page_lsn();
+    buffer->unfix_block(block_id);
+    assert(log->get_flushed_lsn() <= page_lsn);
+
+    for (int i = 0; i < 2; i++)
     {
-        std::string block_id = Block::create_block_id(i+2);
-        std::string block_path = Block::BLOCK_DIR + block_id;
-
-        // delete block file if present
-        std::ifstream file(block_path);
-        if (file.good())
-            assert(std::remove(block_path.c_str()) == 0);
-
-        // create block
-        std::shared_ptr<Block> block = std::make_shared<Block>(Block(block_id));
-        block_ids.push_back(block->get_block_id());
-
-        // fill block with dummy data
-        for (int k = 0; k < Block::MAX_RECORDS; k++)
-            block->add_record({(int) k, (std::string) "Test", (bool) true});
-
-        // write block
-        block->write_data();
+        PageId other_block_id = buffer->create_new_block();
+        buffer->fix_block(other_block_id);
+        buffer->unfix_block(other_block_id);
     }
 
-    int n_cached_blocks = 10;
-    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
+    assert(log->get_flushed_lsn() > page_lsn);
+    assert(storage->sync());
+    assert(storage->page_exists(block_id));
 
-    // test fixing blocks
-    for (int i = 0; i < n_cached_blocks; i++)
-    {
-        std::string block_id = block_ids.at(i);
-        std::shared_ptr<Block> block = buffer->fix_block(block_id);
-        assert(block->get_block_id() == block_id);
-    }
+    // check that concurrent commits share syncs
+    uint64_t n_syncs = log->get_sync_count();
+    int n_threads = 8;
+    int n_commits = 50;
+    std::vector<std::thread> threads;
 
-    // test that we cannot fix any more blocks
-    try
-    {
-        std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(n_cached_blocks));
-        assert(false);
-    } catch (std::exception const& e)
+    for (int i = 0; i < n_threads; i++)
     {
-        assert(true);
+        threads.emplace_back([&log, n_commits, i]() {
+            for (int j = 0; j < n_commits; j++)
+            {
+                RecordId target_id = Block::create_record_id(i, j);
+                log->append(LogManager::Type::FORWARD, i, j, &target_id, sizeof(RecordId));
+                assert(log->commit() < log->get_flushed_lsn());
+            }
+        });
     }
 
-    // test fixing blocks multiple times
-    for (int i = 0; i < n_cached_blocks; i++)
-    {
-        std::string block_id = block_ids.at(i);
-        std::shared_ptr<Block> block = buffer->fix_block(block_id);
-        assert(block->get_block_id() == block_id);
-    }
+    for (std::thread& thread : threads)
+        thread.join();
 
-    // test that we need two unfixes to remove a block
-    for (int i = 0; i < n_cached_blocks; i++)
-    {
-        std::string block_id = block_ids.at(i);
-        assert(buffer->unfix_block(block_id));
+    assert(log->get_sync_count() - n_syncs < (uint64_t) (n_threads * n_commits));
+    assert(log->read_records(0).back().lsn < log->get_flushed_lsn());
 
-        // check that we cannot fix a new block yet
-        try
-        {
-            std::shared_ptr<Block> block = buffer->fix_block(block_ids.at(n_cached_blocks + i));
-            assert(false);
-        } catch (std::exception const& e)
-        {
-            assert(true);
-        }
+    // check that a reopened log continues after its last record, a torn record is dropped
+    uint64_t end_lsn = log->get_end_lsn();
+    records = log->read_records(0);
+    buffer = nullptr;
+    log = nullptr;
 
-        assert(buffer->unfix_block(block_id));
+    int fd = open((Block::BLOCK_DIR + LogManager::LOG_FILE).c_str(), O_WRONLY | O_APPEND);
+    assert(fd >= 0);
+    assert(write(fd, "torn", 4) == 4);
+    close(fd);
 
-        // test that we cannot unfix a third time
-        try {
-            buffer->unfix_block(block_id);
-            assert(false);
-        } catch (std::exception const& e)
-        {
-            assert(true);
-        }
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    assert(log->get_end_lsn() == end_lsn);
+    assert(log->read_records(0).size() == records.size());
+    assert(log->append(LogManager::Type::COMMIT, INVALID_PAGE_ID, 0, nullptr, 0) == end_lsn);
+}
 
-        // fix a new block
-        block_id = block_ids.at(n_cached_blocks + i);
-        std::shared_ptr<Block> block = buffer->fix_block(block_id);
-        assert(block->get_block_id() == block_id);
-    }
+static void test_recovery()
+{
+    std::cout << "[i] Testing recovery functionality." << std::endl;
 
-    // unfix blocks
-    for (int i = 0; i < n_cached_blocks; i++)
-    {
-        std::string block_id = block_ids.at(n_cached_blocks + i);
-        assert(buffer->unfix_block(block_id));
-    }
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
 
-    // delete blocks
-    for (std::string const& block_id : block_ids)
-        assert(buffer->erase_block(block_id));
+    std::shared_ptr<StorageManager> storage = std::make_shared<StorageManager>(Block::BLOCK_DIR, Block::BLOCK_SIZE);
+    std::shared_ptr<LogManager> log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_recovered_records() == 0);
+
+    // commit two records, then change them without a commit
+    PageId block_id = buffer->create_new_block();
+    std::shared_ptr<Block> block = buffer->fix_block(block_id);
+    RecordId record_id1 = block->add_record({(int) 1, (std::string) "Committed"})->get_record_id();
+    RecordId record_id2 = block->add_record({(int) 2, (std::string) "Committed"})->get_record_id();
+    buffer->unfix_block(block_id);
+    assert(buffer->commit());
+
+    block = buffer->fix_block(block_id);
+    assert(block->update_record(std::make_shared<Record>(Record(record_id1, {(int) 1, (std::string) "Uncommitted and longer"}))));
+    assert(block->delete_record(record_id2));
+    RecordId record_id3 = block->add_record({(int) 3, (std::string) "Uncommitted"})->get_record_id();
+    buffer->unfix_block(block_id);
+
+    // crash: the dirty blocks are lost, but the log is written
+    buffer = nullptr;
+    log = nullptr;
+    storage = nullptr;
+
+    // check that committed changes are redone and uncommitted changes are undone
+    storage = std::make_shared<StorageManager>(Block::BLOCK_DIR);
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_recovered_records() > 0);
+
+    assert(buffer->get_record(record_id1)->get_string_attribute(2) == "Committed");
+    assert(buffer->get_record(record_id2)->get_integer_attribute(1) == 2);
+    assert(record_id3 == record_id2 || buffer->get_record(record_id3) == nullptr);
+    assert(buffer->block_exists(block_id));
+
+    // check that a crash right after recovery (before the blocks are written) recovers the same state
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_record(record_id1)->get_string_attribute(2) == "Committed");
+    assert(buffer->get_record(record_id2)->get_integer_attribute(1) == 2);
+
+    // check that recovery starts at the checkpoint once all pages are written
+    PageId other_block_id = buffer->create_new_block();
+    block = buffer->fix_block(other_block_id);
+    for (int i = 0; i < 40; i++)
+        assert(block->add_record({(int) i, (std::string) "Written"}) != nullptr);
+    buffer->unfix_block(other_block_id);
+    assert(buffer->commit());
+    assert(buffer->flush());
+    buffer->checkpoint();
+
+    block = buffer->fix_block(other_block_id);
+    std::vector<RecordId> record_ids;
+    for (int i = 0; i < 5; i++)
+        record_ids.push_back(block->add_record({(int) i, (std::string) "Logged"})->get_record_id());
+    buffer->unfix_block(other_block_id);
+    assert(buffer->commit());
+
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_recovered_records() == 5);
+    assert(buffer->get_record(record_ids.back())->get_string_attribute(2) == "Logged");
+
+    // check that a fuzzy checkpoint keeps the older changes of dirty blocks
+    assert(buffer->flush());
+    block = buffer->fix_block(other_block_id);
+    for (int i = 0; i < 10; i++)
+        record_ids.push_back(block->add_record({(int) i, (std::string) "Dirty"})->get_record_id());
+    buffer->unfix_block(other_block_id);
+    assert(buffer->commit());
+    buffer->checkpoint();
+    assert(block->is_dirty());
+
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_recovered_records() == 10);
+    assert(buffer->get_record(record_ids.back())->get_string_attribute(2) == "Dirty");
+
+    // check that a change between the dirty page table scan and the checkpoint record is redone: the scan
+    // finds no dirty page, the change is logged before the record
+    assert(buffer->flush());
+    uint64_t begin_lsn = log->get_end_lsn();
+    block = buffer->fix_block(other_block_id);
+    record_ids.push_back(block->add_record({(int) 0, (std::string) "Racing"})->get_record_id());
+    buffer->unfix_block(other_block_id);
+    assert(buffer->commit());
+    log->checkpoint(&begin_lsn, sizeof(uint64_t));
+
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    assert(buffer->get_recovered_records() == 1);
+    assert(buffer->get_record(record_ids.back())->get_string_attribute(2) == "Racing");
+
+    // check that committed changes of PAX pages, which are not logged, survive a crash
+    PageId pax_block_id = buffer->create_new_block();
+    block = buffer->fix_block(pax_block_id);
+    std::shared_ptr<PaxBlock> pax_block = PaxBlock::create(block, {"int", "string", "bool"});
+    RecordId pax_record_id = pax_block->add_record({(int) 7, (std::string) "Columnar", (bool) true});
+    buffer->unfix_block(pax_block_id);
+    assert(buffer->commit());
+    assert(!block->is_dirty());
+
+    buffer = nullptr;
+    log = std::make_shared<LogManager>(Block::BLOCK_DIR);
+    buffer = std::make_shared<BufferManager>(4, storage, log);
+    pax_block = std::make_shared<PaxBlock>(buffer->fix_block(pax_block_id));
+    assert(pax_block->get_record_count() == 1);
+    assert(pax_block->get_string_attribute(Block::get_block_dictionary_offset(pax_record_id), 2) == "Columnar");
+    buffer->unfix_block(pax_block_id);
 }
 
 static void test_bptree_node()
@@ -259,11 +2125,10 @@ static void test_bptree_node()
     std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
 
     // create node information
-    std::string node_id = buffer->create_new_block();
-    std::string parent_id = buffer->create_new_block();
+    PageId node_id = buffer->create_new_block();
+    PageId parent_id = buffer->create_new_block();
     bool leaf = false;
 
-    std::string block_path = Block::BLOCK_DIR + node_id;
     std::shared_ptr<BPTreeNode> node = BPTreeNode::create_node(buffer, node_id, parent_id, leaf);
 
     // test new attributes
@@ -275,29 +2140,29 @@ static void test_bptree_node()
     // change values
     std::vector<int> values = node->get_values();
 
-    for (int i = 0; i < BPTreeNode::MAX_VALUES; i++)
+    for (int i = 0; i < node->get_max_values(); i++)
         values.push_back(i);
 
     node->change_values(values);
     values = node->get_values();
 
-    assert(values.size() == BPTreeNode::MAX_VALUES);
+    assert((int) values.size() == node->get_max_values());
 
-    for (int i = 0; i < BPTreeNode::MAX_VALUES; i++)
+    for (int i = 0; i < node->get_max_values(); i++)
         assert(values.at(i) == i);
 
     // change children ids
-    std::vector<std::string> children_ids = node->get_children_ids();
+    std::vector<uint64_t> children_ids = node->get_children_ids();
 
-    for (int i = 0; i < BPTreeNode::MAX_CHILDREN; i++)
+    for (int i = 0; i < node->get_max_children(); i++)
         children_ids.push_back(Block::create_record_id(node_id, i));
 
     node->change_children_ids(children_ids);
     children_ids = node->get_children_ids();
 
-    assert(children_ids.size() == BPTreeNode::MAX_CHILDREN);
+    assert((int) children_ids.size() == node->get_max_children());
 
-    for (int i = 0; i < BPTreeNode::MAX_CHILDREN; i++)
+    for (int i = 0; i < node->get_max_children(); i++)
         assert(children_ids.at(i) == Block::create_record_id(node_id, i));
 
     // change parent_id
@@ -318,7 +2183,7 @@ static void test_bptree()
     std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
 
     // create node information
-    std::string root_node_id = buffer->create_new_block();
+    PageId root_node_id = buffer->create_new_block();
 
     // test BP tree insert
     std::shared_ptr<BPTree> bptree = std::make_shared<BPTree>(buffer, root_node_id);
@@ -338,7 +2203,7 @@ static void test_bptree()
 
     for (int i : numbers)
     {
-        std::string record_id = Block::create_record_id("-----", i);
+        RecordId record_id = Block::create_record_id(INVALID_PAGE_ID, i);
         assert(bptree->insert_record(i, record_id));
     }
 
@@ -348,12 +2213,12 @@ static void test_bptree()
 
     // test BP tree search
     for (int i : numbers)
-        assert(bptree->search_record(i) == Block::create_record_id("-----", i));
+        assert(bptree->search_record(i) == Block::create_record_id(INVALID_PAGE_ID, i));
 
     // check that duplicates are not allowed
     try
     {
-        std::string record_id = Block::create_record_id("-----", 0);
+        RecordId record_id = Block::create_record_id(INVALID_PAGE_ID, 0);
         bptree->insert_record(0, record_id);
         assert(false);
     } catch (std::exception const& e)
@@ -364,6 +2229,122 @@ static void test_bptree()
     assert(bptree->erase());
 }
 
+static void test_pax_block()
+{
+    std::cout << "[i] Testing PAX block functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    int n_cached_blocks = 4;
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(n_cached_blocks));
+    std::vector<std::string> attribute_types = {"int", "string", "bool"};
+
+    // fill a PAX block
+    PageId pax_block_id = buffer->create_new_block();
+    std::shared_ptr<Block> block = buffer->fix_block(pax_block_id);
+    std::shared_ptr<PaxBlock> pax_block = PaxBlock::create(block, attribute_types);
+
+    assert(PaxBlock::is_pax_block(block));
+    assert(pax_block->get_attribute_types() == attribute_types);
+
+    int n_records = 0;
+
+    while (pax_block->add_record({(int) n_records, "Test " + std::to_string(n_records % 3), (bool) (n_records % 2 == 0)}) != INVALID_RECORD_ID)
+        n_records++;
+
+    assert(n_records > RECORDS_PER_BLOCK && n_records <= pax_block->get_capacity());
+    assert(pax_block->get_record_count() == n_records);
+
+    // read attributes from their minipages and as records
+    assert(pax_block->get_integer_attribute(7, 1) == 7);
+    assert(pax_block->get_string_attribute(7, 2) == "Test 1");
+    assert(pax_block->get_boolean_attribute(7, 3) == false);
+
+    RecordId record_id = Block::create_record_id(pax_block_id, 8);
+    std::shared_ptr<Record> record = pax_block->get_record(record_id);
+    assert(record->get_record_id() == record_id);
+    assert(record->get_integer_attribute(1) == 8);
+    assert(record->get_string_attribute(2) == "Test 2");
+    assert(record->get_boolean_attribute(3) == true);
+
+    // delete a tuple
+    assert(pax_block->delete_record(record_id));
+    assert(!pax_block->is_used(8) && pax_block->get_record(record_id) == nullptr);
+    assert(!pax_block->delete_record(record_id));
+
+    // slotted page functions do not work on PAX blocks
+    assert(block->add_record({(int) 0}) == nullptr);
+    assert(block->get_record(record_id) == nullptr);
+
+    // attributes must match the types of the block
+    try
+    {
+        pax_block->add_record({(std::string) "Test", (int) 0, (bool) true});
+        assert(false);
+    } catch (std::invalid_argument const& e)
+    {
+        assert(true);
+    }
+
+    buffer->unfix_block(pax_block_id);
+
+    // mix PAX and slotted blocks in one table, more blocks than cached ones
+    std::vector<PageId> block_ids = {pax_block_id};
+
+    for (int i = 0; i < 2 * n_cached_blocks; i++)
+    {
+        block = buffer->fix_block(buffer->create_new_block());
+        block_ids.push_back(block->get_block_id());
+
+        if (i % 2 == 0)
+        {
+            pax_block = PaxBlock::create(block, attribute_types);
+
+            for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+                pax_block->add_record({(int) k, "Test " + std::to_string(k % 3), (bool) (k % 2 == 0)});
+        } else
+        {
+            for (int k = 0; k < RECORDS_PER_BLOCK; k++)
+                block->add_record({(int) k, "Test " + std::to_string(k % 3), (bool) (k % 2 == 0)});
+        }
+
+        buffer->unfix_block(block->get_block_id());
+    }
+
+    // scan the table, evicted PAX blocks are read again
+    std::shared_ptr<Table> table = std::make_shared<Table>(Table(buffer, block_ids));
+    int n_scanned = 0;
+
+    assert(table->open());
+
+    for (record = table->next(); record != nullptr; record = table->next())
+        n_scanned++;
+
+    assert(table->close());
+    assert(n_scanned == n_records - 1 + 2 * n_cached_blocks * RECORDS_PER_BLOCK);
+
+    // selections are pushed into the table and evaluated on the minipages
+    std::shared_ptr<Selection> selection = std::make_shared<Selection>(Selection(buffer, table, 2, "string", (std::string) "Test 1", "=="));
+    std::shared_ptr<Selection> selection2 = std::make_shared<Selection>(Selection(buffer, selection, 1, "int", (int) 10, "<"));
+    int n_selected = 0;
+
+    assert(selection2->open());
+
+    for (record = selection2->next(); record != nullptr; record = selection2->next())
+    {
+        assert(record->get_string_attribute(2) == "Test 1");
+        assert(record->get_integer_attribute(1) < 10);
+        n_selected++;
+    }
+
+    assert(selection2->close());
+
+    // 1, 4 and 7 in every block
+    assert(n_selected == 3 * (1 + 2 * n_cached_blocks));
+}
+
 static void test_query_execution()
 {
     std::cout << "[i] Testing query execution functionality." << std::endl;
@@ -377,7 +2358,7 @@ static void test_query_execution()
 
     // create 100 filled table blocks
     int n_blocks = 100;
-    std::vector<std::string> block_ids;
+    std::vector<PageId> block_ids;
 
     for (int i = 0; i < n_blocks; i++)
     {
@@ -386,7 +2367,7 @@ static void test_query_execution()
         block_ids.push_back(block->get_block_id());
 
         // fill block with dummy data
-        for (int k = 0; k < Block::MAX_RECORDS; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
             block->add_record({(int) k, (std::string) "Test", (bool) (k % 2 == 0)});
 
         buffer->unfix_block(block->get_block_id());
@@ -398,7 +2379,7 @@ static void test_query_execution()
     assert(table->open());
     for (int i = 0; i < n_blocks; i++)
     {
-        for (int k = 0; k < Block::MAX_RECORDS; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = table->next();
@@ -413,6 +2394,25 @@ static void test_query_execution()
     assert(table->next() == nullptr);
     assert(table->close());
 
+    // check that a scan reads the following blocks ahead, at most as many as frames
+    int n_prefetched = buffer->get_prefetched_block_count();
+    assert(table->open());
+    assert(table->next() != nullptr);
+    assert(buffer->get_prefetched_block_count() > n_prefetched);
+    assert(buffer->get_prefetched_block_count() <= n_cached_blocks);
+
+    // check that closing the scan early drops the blocks it read ahead
+    assert(table->close());
+    assert(buffer->get_prefetched_block_count() == n_prefetched);
+
+    assert(table->open());
+
+    for (int i = 0; i < n_blocks * RECORDS_PER_BLOCK; i++)
+        assert(table->next() != nullptr);
+
+    assert(table->next() == nullptr);
+    assert(table->close());
+
     table = std::make_shared<Table>(Table(buffer, block_ids));
     std::shared_ptr<Projection> projection = std::make_shared<Projection>(Projection(buffer, table, {2,3}, {"string", "bool"}));
 
@@ -420,7 +2420,7 @@ static void test_query_execution()
     assert(projection->open());
     for (int i = 0; i < n_blocks; i++)
     {
-        for (int k = 0; k < Block::MAX_RECORDS; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = projection->next();
@@ -509,7 +2509,7 @@ static void test_query_execution()
     assert(selection->open());
     for (int i = 0; i < n_blocks; i++)
     {
-        for (int k = 21; k < Block::MAX_RECORDS; k++)
+        for (int k = 21; k < RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = selection->next();
@@ -529,7 +2529,7 @@ static void test_query_execution()
     // check that the selection (>= 25) is correct
     for (int i = 0; i < n_blocks; i++)
     {
-        for (int k = 25; k < Block::MAX_RECORDS; k++)
+        for (int k = 25; k < RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = selection->next();
@@ -544,7 +2544,7 @@ static void test_query_execution()
 
     // check that distinct is correct
     assert(distinct->open());
-    for (int k = 0; k < Block::MAX_RECORDS; k++)
+    for (int k = 0; k < RECORDS_PER_BLOCK; k++)
     {
         // check record values
         std::shared_ptr<Record> record = distinct->next();
@@ -571,6 +2571,37 @@ static void test_query_execution()
     // check that distinct is terminated
     assert(distinct->next() == nullptr);
     assert(distinct->close());
+
+    // the returned records and their index are kept in blocks, also when they take more blocks than there are frames
+    int n_values = 4000;
+    std::vector<std::vector<Record::Attribute>> tuples;
+
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < n_values; i++)
+            tuples.push_back({(int) (i * 7919 % n_values), (std::string) "Distinct"});
+    }
+
+    TableAppender appender(buffer);
+    appender.append(tuples);
+    appender.close();
+
+    distinct = std::make_shared<Distinct>(Distinct(buffer, std::make_shared<Table>(Table(buffer, appender.get_block_ids()))));
+
+    // the state of a run is dropped by close
+    for (int run = 0; run < 2; run++)
+    {
+        assert(distinct->open());
+
+        for (int i = 0; i < n_values; i++)
+        {
+            std::shared_ptr<Record> record = distinct->next();
+            assert(record != nullptr && record->get_integer_attribute(1) == i * 7919 % n_values);
+        }
+
+        assert(distinct->next() == nullptr);
+        assert(distinct->close());
+    }
 }
 
 static void test_join() {
@@ -586,7 +2617,7 @@ static void test_join() {
     // create 3 filled blocks for table 1
     int n_blocks = 3;
     int pk1 = 0;
-    std::vector<std::string> block_ids1;
+    std::vector<PageId> block_ids1;
 
     for (int i = 0; i < n_blocks; i++) {
         // create block
@@ -594,7 +2625,7 @@ static void test_join() {
         block_ids1.push_back(block->get_block_id());
 
         // fill block with dummy data
-        for (int k = 0; k < Block::MAX_RECORDS; k++) {
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++) {
             block->add_record({(int) pk1, (std::string) "Test", (bool) (k % 2 == 0)});
             pk1++;
         }
@@ -603,7 +2634,7 @@ static void test_join() {
     }
 
     // create 3 filled blocks for table 2
-    std::vector<std::string> block_ids2;
+    std::vector<PageId> block_ids2;
     int pk2 = 0;
 
     for (int i = 0; i < n_blocks; i++) {
@@ -612,7 +2643,7 @@ static void test_join() {
         block_ids2.push_back(block->get_block_id());
 
         // fill block with dummy data
-        for (int k = 0; k < Block::MAX_RECORDS; k++) {
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++) {
             block->add_record({(int) pk2, (std::string) "Test", (bool) (k % 2 == 1)});
             pk2++;
         }
@@ -632,7 +2663,7 @@ static void test_join() {
     assert(join->open());
     for (int i = 0; i < n_blocks; i++)
     {
-        for (int k = 0; k < Block::MAX_RECORDS; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -660,7 +2691,7 @@ static void test_join() {
     assert(join->open());
     for (int i = 0; i < n_blocks*n_blocks; i++)
     {
-        for (int k = 0; k < Block::MAX_RECORDS*Block::MAX_RECORDS; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK*RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -687,7 +2718,7 @@ static void test_join() {
     assert(join->open());
     for (int i = 0; i < n_blocks*n_blocks; i++)
     {
-        for (int k = 0; k < Block::MAX_RECORDS*Block::MAX_RECORDS/2; k++)
+        for (int k = 0; k < RECORDS_PER_BLOCK*RECORDS_PER_BLOCK/2; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -713,9 +2744,9 @@ static void test_join() {
 
     // check that not equi-join with integers is correct
     assert(join->open());
-    for (int i = 0; i < n_blocks*Block::MAX_RECORDS; i++)
+    for (int i = 0; i < n_blocks*RECORDS_PER_BLOCK; i++)
     {
-        for (int k = 0; k < n_blocks*Block::MAX_RECORDS-1; k++)
+        for (int k = 0; k < n_blocks*RECORDS_PER_BLOCK-1; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -738,9 +2769,9 @@ static void test_join() {
 
     // check that lesser-join with integers is correct
     assert(join->open());
-    for (int i = 0; i < n_blocks*Block::MAX_RECORDS; i++)
+    for (int i = 0; i < n_blocks*RECORDS_PER_BLOCK; i++)
     {
-        for (int k = i+1; k < n_blocks*Block::MAX_RECORDS; k++)
+        for (int k = i+1; k < n_blocks*RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -763,7 +2794,7 @@ static void test_join() {
 
     // check that greater-join with integers is correct
     assert(join->open());
-    for (int i = 0; i < n_blocks*Block::MAX_RECORDS; i++)
+    for (int i = 0; i < n_blocks*RECORDS_PER_BLOCK; i++)
     {
         for (int k = 0; k < i; k++)
         {
@@ -788,9 +2819,9 @@ static void test_join() {
 
     // check that lesser-equal-join with integers is correct
     assert(join->open());
-    for (int i = 0; i < n_blocks*Block::MAX_RECORDS; i++)
+    for (int i = 0; i < n_blocks*RECORDS_PER_BLOCK; i++)
     {
-        for (int k = i; k < n_blocks*Block::MAX_RECORDS; k++)
+        for (int k = i; k < n_blocks*RECORDS_PER_BLOCK; k++)
         {
             // check record values
             std::shared_ptr<Record> record = join->next();
@@ -813,7 +2844,7 @@ static void test_join() {
 
     // check that greater-equal-join with integers is correct
     assert(join->open());
-    for (int i = 0; i < n_blocks*Block::MAX_RECORDS; i++)
+    for (int i = 0; i < n_blocks*RECORDS_PER_BLOCK; i++)
     {
         for (int k = 0; k < i+1; k++)
         {
@@ -827,18 +2858,172 @@ static void test_join() {
     // check that join is terminated
     assert(join->next() == nullptr);
     assert(join->close());
+
+    // check that a join can be closed before its result is read
+    assert(join->open());
+    assert(join->next() != nullptr);
+    assert(join->close());
 }
 
 
+static void test_catalog()
+{
+    std::cout << "[i] Testing catalog functionality." << std::endl;
+
+    // delete existing block path if present
+    if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
+        std::filesystem::remove_all(Block::BLOCK_DIR);
+
+    std::shared_ptr<BufferManager> buffer = std::make_shared<BufferManager>(BufferManager(16));
+    std::shared_ptr<Catalog> catalog = std::make_shared<Catalog>(buffer, Block::BLOCK_DIR);
+    assert(catalog->get_table_names().empty());
+
+    catalog->create_table("users", {"id", "name", "active"}, {"int", "string", "bool"});
+    catalog->create_table("orders", {"order_id", "user_id"}, {"int", "int"});
+    catalog->create_index("users", "users_id", "id");
+    assert(catalog->has_table("users"));
+    assert(catalog->get_column_position("users", "name") == 2);
+    assert(catalog->get_column_type("users", "active") == Schema::Type::BOOLEAN);
+
+    // invalid tables and columns are rejected
+    bool thrown = false;
+    try { catalog->create_table("users", {"id"}, {"int"}); } catch (std::invalid_argument const&) { thrown = true; }
+    assert(thrown);
+    thrown = false;
+    try { catalog->create_table("bad table", {"id"}, {"int"}); } catch (std::invalid_argument const&) { thrown = true; }
+    assert(thrown);
+    thrown = false;
+    try { catalog->get_column_position("users", "email"); } catch (std::invalid_argument const&) { thrown = true; }
+    assert(thrown);
+
+    // the second append continues in the last block of the first one
+    int n_users = 1000;
+    std::vector<std::vector<Record::Attribute>> users;
+
+    for (int i = 0; i < n_users; i++)
+        users.push_back({i, (std::string) "User " + std::to_string(i), i % 2 == 0});
+
+    std::vector<RecordId> record_ids = catalog->append("users", std::vector<std::vector<Record::Attribute>>(users.begin(), users.begin() + 333));
+    std::vector<RecordId> record_ids2 = catalog->append("users", std::vector<std::vector<Record::Attribute>>(users.begin() + 333, users.end()));
+    record_ids.insert(record_ids.end(), record_ids2.begin(), record_ids2.end());
+    assert(Block::get_block_id(record_ids2.front()) == Block::get_block_id(record_ids.at(332)));
+
+    std::vector<PageId> block_ids = catalog->get_block_ids("users");
+    assert(block_ids.size() > 1);
+
+    // keys of the index are unique, nothing is appended for a duplicate
+    thrown = false;
+    try { catalog->append("users", {{(int) 42, (std::string) "Duplicate", true}}); } catch (std::invalid_argument const&) { thrown = true; }
+    assert(thrown);
+    assert(catalog->get_block_ids("users") == block_ids);
+    assert(catalog->get_index("users", "users_id")->search_record(42) == record_ids.at(42));
+    assert(catalog->get_index("users", "missing") == nullptr);
+
+    std::vector<std::vector<Record::Attribute>> orders;
+
+    for (int i = 0; i < 20; i++)
+        orders.push_back({i, i * 7});
+
+    catalog->append("orders", orders);
+
+    // plans are bound to the column types of the catalog
+    std::shared_ptr<Schema> schema = catalog->get_schema("users");
+    std::shared_ptr<Selection> selection = std::make_shared<Selection>(buffer, catalog->scan("users"),
+        catalog->get_column_position("users", "id"), catalog->get_column_type("users", "id"), (int) 10, QueryOperator::Comparator::LESS);
+    std::shared_ptr<Projection> projection = std::make_shared<Projection>(buffer, selection,
+        std::vector<int>{catalog->get_column_position("users", "name")}, *schema);
+
+    assert(projection->open());
+    int n_records = 0;
+
+    for (std::shared_ptr<Record> record = projection->next(); record != nullptr; record = projection->next())
+    {
+        assert(record->get_string_attribute(1) == "User " + std::to_string(n_records));
+        n_records++;
+    }
+
+    assert(n_records == 10);
+    assert(projection->close());
+
+    std::shared_ptr<Join> join = std::make_shared<Join>(buffer, catalog->scan("orders"), catalog->scan("users"),
+        catalog->get_column_position("orders", "user_id"), catalog->get_column_position("users", "id"),
+        *catalog->get_schema("orders"), *schema, QueryOperator::Comparator::EQUAL);
+
+    assert(join->open());
+    n_records = 0;
+
+    for (std::shared_ptr<Record> record = join->next(); record != nullptr; record = join->next())
+    {
+        assert(record->get_integer_attribute(2) == record->get_integer_attribute(3));
+        assert(record->get_string_attribute(4) == "User " + std::to_string(record->get_integer_attribute(3)));
+        n_records++;
+    }
+
+    assert(n_records == 20);
+    assert(join->close());
+
+    // the tables and indexes are restored when the database is opened again
+    PageId root_node_id = catalog->get_index("users", "users_id")->get_root_node_id();
+    assert(buffer->flush());
+    catalog = nullptr;
+    buffer = nullptr;
+
+    buffer = std::make_shared<BufferManager>(BufferManager(16));
+    catalog = std::make_shared<Catalog>(buffer, Block::BLOCK_DIR);
+    assert(catalog->get_table_names() == std::vector<std::string>({"orders", "users"}));
+    assert(catalog->get_block_ids("users") == block_ids);
+    assert(catalog->get_column_names("users") == std::vector<std::string>({"id", "name", "active"}));
+    assert(catalog->get_index("users", "users_id")->get_root_node_id() == root_node_id);
+    assert(catalog->get_index("users", "users_id")->search_record(999) == record_ids.at(999));
+
+    std::shared_ptr<Table> table = catalog->scan("users");
+    table->push_filter(catalog->get_column_position("users", "active"), Schema::Type::BOOLEAN, true, QueryOperator::Comparator::EQUAL);
+    assert(table->open());
+    n_records = 0;
+
+    while (table->next() != nullptr)
+        n_records++;
+
+    assert(n_records == n_users / 2);
+    assert(table->close());
+
+    // dropped tables give back their blocks
+    int n_free_blocks = buffer->get_free_block_count();
+    assert(catalog->drop_table("orders"));
+    assert(!catalog->drop_table("orders"));
+    assert(!catalog->has_table("orders"));
+    assert(buffer->get_free_block_count() > n_free_blocks);
+}
+
 int main() {
     test_record();
+    test_record_hash();
+    test_schema();
     test_block();
+    test_block_compaction();
+    test_bulk_insert();
     test_block_read_write();
+    test_page_geometry();
+    test_direct_io();
+    test_async_io();
+    test_mapped_database();
     test_buffer_manager();
+    test_replacement_policies();
+    test_concurrent_buffer_manager();
+    test_background_writer();
+    test_scan_rings();
+    test_page_guard();
+    test_buffer_statistics();
+    test_block_reuse();
+    test_record_relocation();
+    test_write_ahead_log();
+    test_recovery();
     test_bptree_node();
     test_bptree();
+    test_pax_block();
     test_query_execution();
     test_join();
+    test_catalog();
 
     // delete existing block path
     if (std::filesystem::exists(Block::BLOCK_DIR) && std::filesystem::is_directory(Block::BLOCK_DIR))
@@ -0,0 +1,64 @@
+#include <memory>
+#include <utility>
+
+#include "header/identifiers.h"
+#include "header/block.h"
+#include "header/buffer_manager.h"
+#include "header/page_guard.h"
+
+PageGuard::PageGuard() : buffer_manager(nullptr), block(nullptr) {}
+
+PageGuard::PageGuard(std::shared_ptr<BufferManager> const& buffer_manager, PageId block_id)
+    : PageGuard(buffer_manager, block_id, nullptr) {}
+
+PageGuard::PageGuard(std::shared_ptr<BufferManager> const& buffer_manager, PageId block_id,
+                     std::shared_ptr<BufferManager::Ring> const& ring)
+    : buffer_manager(buffer_manager), block(buffer_manager->fix_block(block_id, ring)) {}
+
+PageGuard::PageGuard(PageGuard&& other) noexcept
+    : buffer_manager(std::move(other.buffer_manager)), block(std::move(other.block))
+{
+    other.block = nullptr;
+}
+
+PageGuard& PageGuard::operator=(PageGuard&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        buffer_manager = std::move(other.buffer_manager);
+        block = std::move(other.block);
+        other.block = nullptr;
+    }
+
+    return *this;
+}
+
+PageGuard::~PageGuard()
+{
+    reset();
+}
+
+std::shared_ptr<Block> const& PageGuard::get_block() const
+{
+    return block;
+}
+
+Block* PageGuard::operator->() const
+{
+    return block.get();
+}
+
+PageGuard::operator bool() const
+{
+    return block != nullptr;
+}
+
+void PageGuard::reset()
+{
+    // a block that could not be loaded was never fixed
+    if (block != nullptr)
+        buffer_manager->unfix_block(block->get_block_id());
+
+    block = nullptr;
+}
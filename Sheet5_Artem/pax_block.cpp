@@ -0,0 +1,305 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <variant>
+#include <stdexcept>
+#include <algorithm>
+
+#include "header/identifiers.h"
+#include "header/record.h"
+#include "header/block.h"
+#include "header/pax_block.h"
+
+// minipages start at cache line friendly offsets
+static uint32_t align(uint32_t offset, uint32_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+PaxBlock::PaxBlock(std::shared_ptr<Block> const& block)
+    : block(block), data(static_cast<char*>(block->get_data().get()))
+{
+    if (!is_pax_block(block))
+        throw std::invalid_argument("Block is not a PAX block: " + std::to_string(block->get_block_id()));
+}
+
+std::shared_ptr<PaxBlock> PaxBlock::create(std::shared_ptr<Block> const& block, std::vector<std::string> const& attribute_types)
+{
+    if (block->get_record_count() > 0 || block->is_read_only())
+        throw std::invalid_argument("Cannot turn block into PAX block: " + std::to_string(block->get_block_id()));
+
+    std::vector<AttributeType> types;
+    int tuple_width = 0;
+
+    for (std::string const& attribute_type : attribute_types)
+    {
+        types.push_back(parse_type(attribute_type));
+        tuple_width += get_width(types.back()) + (types.back() == STRING ? STRING_RESERVE : 0);
+    }
+
+    // choose the number of tuples, so that the minipages and the expected strings fill the page
+    int block_size = block->get_block_size();
+    int n_strings = std::count(types.begin(), types.end(), STRING);
+    uint32_t capacity = std::min(block_size / std::max(tuple_width, 1), 1 << Block::SLOT_BITS);
+
+    while (capacity > 0 && get_layout_size(types, capacity) + capacity * n_strings * STRING_RESERVE > (uint32_t) block_size)
+        capacity--;
+
+    if (capacity == 0 || types.empty())
+        throw std::invalid_argument("Cannot store tuples in PAX block: " + std::to_string(block->get_block_id()));
+
+    // write header
+    PageId block_id = block->get_block_id();
+    char* data = static_cast<char*>(block->get_data().get());
+    std::memset(data, 0, get_layout_size(types, capacity));
+
+    Header* header = reinterpret_cast<Header*>(data);
+    header->magic = PAX_MAGIC;
+    header->n_records = 0;
+    header->block_id = block_id;
+    header->lsn = 0;
+    header->n_slots = 0;
+    header->capacity = capacity;
+    header->n_attributes = types.size();
+    header->minipages_end = get_layout_size(types, capacity);
+    header->heap_start = block_size;
+
+    // write attribute types and minipage offsets
+    uint32_t offset = sizeof(Header);
+    std::memcpy(data + offset, types.data(), types.size());
+    offset = align(offset + types.size(), sizeof(uint32_t));
+
+    uint32_t* minipages = reinterpret_cast<uint32_t*>(data + offset);
+    offset = align(offset + types.size() * sizeof(uint32_t), sizeof(uint64_t));
+    offset = align(offset + (capacity + 7) / 8, sizeof(uint64_t));
+
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        minipages[i] = offset;
+        offset = align(offset + capacity * get_width(types.at(i)), sizeof(uint64_t));
+    }
+
+    block->set_dirty();
+    return std::make_shared<PaxBlock>(block);
+}
+
+bool PaxBlock::is_pax_block(std::shared_ptr<Block> const& block)
+{
+    return static_cast<Header*>(block->get_data().get())->magic == PAX_MAGIC;
+}
+
+RecordId PaxBlock::add_record(std::vector<Record::Attribute> const& attributes)
+{
+    Header* header = get_header();
+
+    if (attributes.size() != header->n_attributes)
+        throw std::invalid_argument("Cannot add record with " + std::to_string(attributes.size()) + " attributes to PAX block: " + std::to_string(header->block_id));
+
+    // check types and that all strings fit into the heap
+    uint32_t string_length = 0;
+
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        AttributeType type = get_type(i);
+        Record::Attribute const& attribute = attributes.at(i);
+
+        if ((type == INTEGER && !std::holds_alternative<int>(attribute)) ||
+            (type == STRING && !std::holds_alternative<std::string>(attribute)) ||
+            (type == BOOLEAN && !std::holds_alternative<bool>(attribute)))
+            throw std::invalid_argument("Cannot add record with wrong attribute types to PAX block: " + std::to_string(header->block_id));
+
+        if (type == STRING)
+            string_length += std::get<std::string>(attribute).size();
+    }
+
+    if (header->n_slots >= header->capacity || header->minipages_end + string_length > header->heap_start || block->is_read_only())
+        return INVALID_RECORD_ID;
+
+    // write every attribute into its minipage
+    int slot = header->n_slots;
+
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        char* minipage = get_minipage(i);
+        Record::Attribute const& attribute = attributes.at(i);
+
+        if (get_type(i) == INTEGER)
+        {
+            int value = std::get<int>(attribute);
+            std::memcpy(minipage + slot * sizeof(int), &value, sizeof(int));
+        } else if (get_type(i) == BOOLEAN)
+        {
+            minipage[slot] = std::get<bool>(attribute);
+        } else
+        {
+            std::string const& value = std::get<std::string>(attribute);
+            header->heap_start -= value.size();
+            std::memcpy(data + header->heap_start, value.data(), value.size());
+
+            StringEntry entry = {header->heap_start, (uint32_t) value.size()};
+            std::memcpy(minipage + slot * sizeof(StringEntry), &entry, sizeof(StringEntry));
+        }
+    }
+
+    get_bitmap()[slot / 8] |= (1 << (slot % 8));
+    header->n_slots++;
+    header->n_records++;
+    block->set_dirty();
+
+    return Block::create_record_id(header->block_id, slot);
+}
+
+bool PaxBlock::delete_record(RecordId record_id)
+{
+    int slot = Block::get_block_dictionary_offset(record_id);
+
+    if (Block::get_block_id(record_id) != get_header()->block_id || !is_used(slot) || block->is_read_only())
+        return false;
+
+    // string space is not reused, tuples are only appended
+    get_bitmap()[slot / 8] &= ~(1 << (slot % 8));
+    get_header()->n_records--;
+    block->set_dirty();
+
+    return true;
+}
+
+std::shared_ptr<Record> PaxBlock::get_record(RecordId record_id)
+{
+    int slot = Block::get_block_dictionary_offset(record_id);
+
+    if (Block::get_block_id(record_id) != get_header()->block_id || !is_used(slot))
+        return nullptr;
+
+    std::vector<Record::Attribute> attributes;
+
+    for (uint32_t i = 0; i < get_header()->n_attributes; i++)
+    {
+        if (get_type(i) == INTEGER)
+            attributes.push_back(get_integer_attribute(slot, i + 1));
+        else if (get_type(i) == BOOLEAN)
+            attributes.push_back(get_boolean_attribute(slot, i + 1));
+        else
+            attributes.push_back(std::string(get_string_attribute(slot, i + 1)));
+    }
+
+    return std::make_shared<Record>(Record(record_id, attributes));
+}
+
+int PaxBlock::get_integer_attribute(int slot, int position)
+{
+    int value;
+    std::memcpy(&value, get_minipage(position - 1) + slot * sizeof(int), sizeof(int));
+    return value;
+}
+
+std::string_view PaxBlock::get_string_attribute(int slot, int position)
+{
+    StringEntry entry;
+    std::memcpy(&entry, get_minipage(position - 1) + slot * sizeof(StringEntry), sizeof(StringEntry));
+    return std::string_view(data + entry.offset, entry.length);
+}
+
+bool PaxBlock::get_boolean_attribute(int slot, int position)
+{
+    return get_minipage(position - 1)[slot] != 0;
+}
+
+bool PaxBlock::is_used(int slot)
+{
+    if (slot < 0 || slot >= (int) get_header()->n_slots)
+        return false;
+
+    return (get_bitmap()[slot / 8] >> (slot % 8)) & 1;
+}
+
+int PaxBlock::get_slot_count()
+{
+    return get_header()->n_slots;
+}
+
+int PaxBlock::get_record_count()
+{
+    return get_header()->n_records;
+}
+
+int PaxBlock::get_capacity()
+{
+    return get_header()->capacity;
+}
+
+std::vector<std::string> PaxBlock::get_attribute_types()
+{
+    std::vector<std::string> attribute_types;
+
+    for (uint32_t i = 0; i < get_header()->n_attributes; i++)
+    {
+        if (get_type(i) == INTEGER)
+            attribute_types.push_back("int");
+        else if (get_type(i) == STRING)
+            attribute_types.push_back("string");
+        else
+            attribute_types.push_back("bool");
+    }
+
+    return attribute_types;
+}
+
+PaxBlock::AttributeType PaxBlock::parse_type(std::string const& attribute_type)
+{
+    if (attribute_type == "int")
+        return INTEGER;
+    else if (attribute_type == "string")
+        return STRING;
+    else if (attribute_type == "bool")
+        return BOOLEAN;
+
+    throw std::invalid_argument("Unknown attribute type: " + attribute_type);
+}
+
+int PaxBlock::get_width(AttributeType type)
+{
+    if (type == INTEGER)
+        return sizeof(int);
+    else if (type == STRING)
+        return sizeof(StringEntry);
+
+    return sizeof(bool);
+}
+
+uint32_t PaxBlock::get_layout_size(std::vector<AttributeType> const& types, uint32_t capacity)
+{
+    uint32_t offset = align(sizeof(Header) + types.size(), sizeof(uint32_t));
+    offset = align(offset + types.size() * sizeof(uint32_t), sizeof(uint64_t));
+    offset = align(offset + (capacity + 7) / 8, sizeof(uint64_t));
+
+    for (AttributeType type : types)
+        offset = align(offset + capacity * get_width(type), sizeof(uint64_t));
+
+    return offset;
+}
+
+PaxBlock::Header* PaxBlock::get_header()
+{
+    return reinterpret_cast<Header*>(data);
+}
+
+PaxBlock::AttributeType PaxBlock::get_type(int attribute_index)
+{
+    return static_cast<AttributeType>(data[sizeof(Header) + attribute_index]);
+}
+
+char* PaxBlock::get_minipage(int attribute_index)
+{
+    uint32_t const* minipages = reinterpret_cast<uint32_t const*>(data + align(sizeof(Header) + get_header()->n_attributes, sizeof(uint32_t)));
+    return data + minipages[attribute_index];
+}
+
+uint8_t* PaxBlock::get_bitmap()
+{
+    uint32_t n_attributes = get_header()->n_attributes;
+    uint32_t offset = align(sizeof(Header) + n_attributes, sizeof(uint32_t));
+    return reinterpret_cast<uint8_t*>(data + align(offset + n_attributes * sizeof(uint32_t), sizeof(uint64_t)));
+}
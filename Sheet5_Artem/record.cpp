@@ -2,20 +2,26 @@
 #include <string>
 #include <iostream>
 #include <cstring>
-#include <functional>
 #include <vector>
 
 #include "header/record.h"
 
 Record::Record(std::shared_ptr<void> const& data) : data(data) {}
 
-Record::Record(std::string const& record_id, std::vector<Attribute> const& attributes)
+Record::Record(RecordId record_id, std::vector<Attribute> const& attributes)
 {
-    // Check record_id shape
-    if (record_id.size() != Record::RECORD_ID_SIZE) {
-        throw std::invalid_argument("record_id must be exactly 10 bytes long.");
-    }
+    int size = get_encoded_size(attributes);
 
+    // Allocate memory block
+    char* buffer = new char[size];
+    encode(buffer, record_id, attributes);
+
+    // Create shared_ptr
+    data = std::shared_ptr<void>(buffer, [](void* ptr) { delete[] static_cast<char*>(ptr); });
+}
+
+int Record::get_encoded_size(std::vector<Attribute> const& attributes)
+{
     // Calculate total size needed
     // = record size field size + dictionary size + record_id + attribute sizes
     int dictionary_size = (attributes.size() + 2) * sizeof(int);
@@ -30,22 +36,26 @@ Record::Record(std::string const& record_id, std::vector<Attribute> const& attri
             size += std::get<std::string>(attr).size();
         } else if (std::holds_alternative<bool>(attr)) {
             size += sizeof(bool);
+        } else if (std::holds_alternative<uint64_t>(attr)) {
+            size += sizeof(uint64_t);
         }
     }
 
-    // Allocate memory block
-    char* buffer = new char[size];
+    return size;
+}
+
+void Record::encode(void* destination, RecordId record_id, std::vector<Attribute> const& attributes)
+{
+    char* buffer = static_cast<char*>(destination);
+    int dictionary_size = (attributes.size() + 2) * sizeof(int);
 
     // Offset for copying data
     int dictionary_offset = sizeof(int);
     int offset = sizeof(int) + dictionary_size;
 
-    // Copy size of record
-    std::memcpy(buffer, &size, sizeof(int));
-
     // Copy record ID as first attribute
     std::memcpy(buffer + dictionary_offset, &offset, sizeof(int));
-    std::memcpy(buffer + offset, record_id.c_str(), Record::RECORD_ID_SIZE);
+    std::memcpy(buffer + offset, &record_id, Record::RECORD_ID_SIZE);
 
     dictionary_offset += sizeof(int);
     offset += Record::RECORD_ID_SIZE;
@@ -67,79 +77,140 @@ Record::Record(std::string const& record_id, std::vector<Attribute> const& attri
             bool val = std::get<bool>(attr);
             std::memcpy(buffer + offset, &val, sizeof(bool));
             offset += sizeof(bool);
+        } else if (std::holds_alternative<uint64_t>(attr)) {
+            uint64_t val = std::get<uint64_t>(attr);
+            std::memcpy(buffer + offset, &val, sizeof(uint64_t));
+            offset += sizeof(uint64_t);
         }
     }
 
-    // Store end offset in dictionary
+    // Store end offset in dictionary, it is the size of the record
     std::memcpy(buffer + dictionary_offset, &offset, sizeof(int));
-
-    // Create shared_ptr
-    data = std::shared_ptr<void>(buffer, [](void* ptr) { delete[] static_cast<char*>(ptr); });
+    std::memcpy(buffer, &offset, sizeof(int));
 }
 
-std::string Record::get_record_id()
+RecordId Record::get_record_id()
 {
-    return get_string_attribute(0);
+    return get_id_attribute(0);
 }
 
 std::string Record::get_string_attribute(int attribute_index)
 {
     if (data)
-    {
-        // get attribute start position
-        int position = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + sizeof(int) + attribute_index * sizeof(int));
-
-        // get (next) attribute start position
-        int next_position = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + sizeof(int) + (attribute_index+1) * sizeof(int));
-
-        // retrieve the data
-        char *ptr = static_cast<char *>(data.get()) + position;
-        return std::string(ptr, ptr + next_position - position);
-    }
+        return std::string(get_view().get_string_attribute(attribute_index));
     return "";
 }
 
 int Record::get_integer_attribute(int attribute_index)
 {
     if (data)
-    {
-        // get attribute start position
-        int position = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + sizeof(int) + attribute_index * sizeof(int));
-        // retrieve the data
-        return *reinterpret_cast<int*>(static_cast<char*>(data.get()) + position);
-    }
+        return get_view().get_integer_attribute(attribute_index);
     return 0;
 }
 
 bool Record::get_boolean_attribute(int attribute_index)
 {
     if (data)
-    {
-        // get attribute start position
-        int position = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + sizeof(int) + attribute_index * sizeof(int));
-        // retrieve the data
-        return *reinterpret_cast<bool*>(static_cast<char*>(data.get()) + position);;
-    }
+        return get_view().get_boolean_attribute(attribute_index);
     return false;
 }
 
+uint64_t Record::get_id_attribute(int attribute_index)
+{
+    if (data)
+        return get_view().get_id_attribute(attribute_index);
+    return 0;
+}
+
 std::shared_ptr<void> Record::get_data()
 {
     return data;
 }
 
+RecordView Record::get_view()
+{
+    return RecordView(data.get());
+}
+
 int Record::get_size()
 {
     return *reinterpret_cast<int*>(static_cast<char*>(data.get()));
 }
 
-int Record::get_hash()
+RecordView::RecordView(void const* data) : data(static_cast<char const*>(data)) {}
+
+RecordId RecordView::get_record_id() const
 {
-    int start_pos = *reinterpret_cast<int*>(static_cast<char*>(data.get()) + 2 * sizeof(int)); // ignore directory + record id
-    int end_pos = get_size();
+    return get_id_attribute(0);
+}
 
-    char *ptr = static_cast<char *>(data.get()) + start_pos;
-    std::string record = std::string(ptr, ptr + end_pos - start_pos);
+std::string_view RecordView::get_string_attribute(int attribute_index) const
+{
+    // get attribute start position
+    int position = get_attribute_position(attribute_index);
+
+    // get (next) attribute start position
+    int next_position = get_attribute_position(attribute_index + 1);
 
-    return std::hash<std::string>{}(record);
+    // point to the data
+    return std::string_view(data + position, next_position - position);
+}
+
+int RecordView::get_integer_attribute(int attribute_index) const
+{
+    // retrieve the data
+    return *reinterpret_cast<int const*>(data + get_attribute_position(attribute_index));
+}
+
+bool RecordView::get_boolean_attribute(int attribute_index) const
+{
+    // retrieve the data
+    return *reinterpret_cast<bool const*>(data + get_attribute_position(attribute_index));
+}
+
+uint64_t RecordView::get_id_attribute(int attribute_index) const
+{
+    // retrieve the data
+    uint64_t value;
+    std::memcpy(&value, data + get_attribute_position(attribute_index), sizeof(uint64_t));
+    return value;
+}
+
+std::string_view RecordView::get_attribute_bytes(int attribute_index) const
+{
+    int position = get_attribute_position(attribute_index);
+    return std::string_view(data + position, get_attribute_position(attribute_index + 1) - position);
+}
+
+int RecordView::get_attribute_count() const
+{
+    // the dictionary ends where the record id starts, it has an entry for the record id and the end
+    return (get_attribute_position(0) - sizeof(int)) / sizeof(int) - 2;
+}
+
+void const* RecordView::get_data() const
+{
+    return data;
+}
+
+int RecordView::get_size() const
+{
+    return *reinterpret_cast<int const*>(data);
+}
+
+std::shared_ptr<Record> RecordView::materialize() const
+{
+    int size = get_size();
+
+    char* buffer = new char[size];
+    std::memcpy(buffer, data, size);
+
+    std::shared_ptr<void> record_data = std::shared_ptr<void>(buffer, [](void* ptr) { delete[] static_cast<char*>(ptr); });
+    return std::make_shared<Record>(record_data);
+}
+
+int RecordView::get_attribute_position(int attribute_index) const
+{
+    // skip record size, the dictionary contains the attribute start positions
+    return *reinterpret_cast<int const*>(data + sizeof(int) + attribute_index * sizeof(int));
 }
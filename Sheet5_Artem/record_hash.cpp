@@ -0,0 +1,88 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <variant>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include "header/record.h"
+#include "header/record_hash.h"
+
+uint64_t RecordHash::hash(void const* data, size_t size, uint64_t seed)
+{
+    return finalize(update(seed, data, size));
+}
+
+uint64_t RecordHash::hash_attribute(Record::Attribute const& attribute)
+{
+    return finalize(update(SEED, attribute));
+}
+
+uint64_t RecordHash::hash_attributes(std::vector<Record::Attribute> const& attributes, std::vector<int> const& positions)
+{
+    uint64_t state = SEED;
+
+    for (int position : positions)
+        state = update(state, attributes.at(position - 1));
+
+    return finalize(state);
+}
+
+uint64_t RecordHash::hash_record(std::vector<Record::Attribute> const& attributes)
+{
+    uint64_t state = SEED;
+
+    for (Record::Attribute const& attribute : attributes)
+        state = update(state, attribute);
+
+    return finalize(state);
+}
+
+void RecordHash::hash_batch(std::vector<std::shared_ptr<Record>> const& records, std::vector<int> const& positions,
+                            std::vector<uint64_t>& hashes)
+{
+    hashes.resize(records.size());
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        RecordView view = records[i]->get_view();
+        hashes[i] = positions.empty() ? hash_record(view) : hash_attributes(view, positions);
+    }
+}
+
+void RecordHash::hash_batch(std::vector<std::vector<Record::Attribute>> const& tuples, std::vector<int> const& positions,
+                            std::vector<uint64_t>& hashes)
+{
+    hashes.resize(tuples.size());
+
+    for (size_t i = 0; i < tuples.size(); i++)
+        hashes[i] = positions.empty() ? hash_record(tuples[i]) : hash_attributes(tuples[i], positions);
+}
+
+uint64_t RecordHash::combine(uint64_t hash, uint64_t value)
+{
+    // the values are hashes already, the shifts make the result depend on their order
+    return hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 12) + (hash >> 4));
+}
+
+uint64_t RecordHash::update(uint64_t state, Record::Attribute const& attribute)
+{
+    // the same bytes as in records
+    if (std::holds_alternative<int>(attribute))
+    {
+        int value = std::get<int>(attribute);
+        return update(state, &value, sizeof(int));
+    } else if (std::holds_alternative<std::string>(attribute))
+    {
+        std::string const& value = std::get<std::string>(attribute);
+        return update(state, value.data(), value.size());
+    } else if (std::holds_alternative<bool>(attribute))
+    {
+        bool value = std::get<bool>(attribute);
+        return update(state, &value, sizeof(bool));
+    }
+
+    uint64_t value = std::get<uint64_t>(attribute);
+    return update(state, &value, sizeof(uint64_t));
+}
@@ -0,0 +1,599 @@
+#include <memory>
+#include <string>
+#include <list>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "header/identifiers.h"
+#include "header/replacement_policy.h"
+
+double ReplacementPolicy::SimulationResult::get_hit_ratio() const
+{
+    return hits + misses == 0 ? 0.0 : (double) hits / (hits + misses);
+}
+
+std::shared_ptr<ReplacementPolicy> ReplacementPolicy::create(Type type, int n_frames)
+{
+    if (type == Type::CLOCK)
+        return std::make_shared<ClockPolicy>(n_frames);
+    else if (type == Type::TWO_QUEUE)
+        return std::make_shared<TwoQueuePolicy>(n_frames);
+    else if (type == Type::LRU_K)
+        return std::make_shared<LruKPolicy>(n_frames);
+    else if (type == Type::ARC)
+        return std::make_shared<ArcPolicy>(n_frames);
+
+    return std::make_shared<LruPolicy>();
+}
+
+std::string ReplacementPolicy::get_name(Type type)
+{
+    if (type == Type::CLOCK)
+        return "CLOCK";
+    else if (type == Type::TWO_QUEUE)
+        return "2Q";
+    else if (type == Type::LRU_K)
+        return "LRU-" + std::to_string(LruKPolicy::K);
+    else if (type == Type::ARC)
+        return "ARC";
+
+    return "LRU";
+}
+
+ReplacementPolicy::SimulationResult ReplacementPolicy::simulate(Type type, int n_frames, std::vector<TraceEntry> const& trace)
+{
+    std::shared_ptr<ReplacementPolicy> policy = create(type, n_frames);
+    SimulationResult result = {0, 0};
+
+    // reference counts of the cached blocks
+    std::unordered_map<PageId, int> cache;
+
+    for (TraceEntry const& entry : trace)
+    {
+        auto it = cache.find(entry.block_id);
+
+        if (entry.access == TraceEntry::Access::FIX)
+        {
+            if (it != cache.end())
+            {
+                result.hits++;
+
+                // like the buffer manager, the policy only learns about the first fix of an unfixed block
+                if (it->second++ == 0)
+                    policy->on_fix(entry.block_id);
+
+                continue;
+            }
+
+            result.misses++;
+
+            if (cache.size() >= (size_t) n_frames)
+            {
+                PageId victim = policy->evict(entry.block_id);
+
+                if (victim == INVALID_PAGE_ID)
+                    throw std::runtime_error("Cannot replay fix, all frames are fixed: " + std::to_string(entry.block_id));
+
+                cache.erase(victim);
+            }
+
+            cache[entry.block_id] = 1;
+            policy->on_load(entry.block_id);
+        } else if (entry.access == TraceEntry::Access::UNFIX)
+        {
+            if (it != cache.end() && it->second > 0 && --it->second == 0)
+                policy->on_unfix(entry.block_id);
+        } else if (it != cache.end())
+        {
+            cache.erase(it);
+            policy->on_erase(entry.block_id);
+        }
+    }
+
+    return result;
+}
+
+bool ReplacementPolicy::PageList::contains(PageId block_id) const
+{
+    return positions.find(block_id) != positions.end();
+}
+
+void ReplacementPolicy::PageList::push_back(PageId block_id)
+{
+    positions[block_id] = blocks.insert(blocks.end(), block_id);
+}
+
+void ReplacementPolicy::PageList::push_front(PageId block_id)
+{
+    positions[block_id] = blocks.insert(blocks.begin(), block_id);
+}
+
+bool ReplacementPolicy::PageList::remove(PageId block_id)
+{
+    auto it = positions.find(block_id);
+
+    if (it == positions.end())
+        return false;
+
+    blocks.erase(it->second);
+    positions.erase(it);
+    return true;
+}
+
+bool ReplacementPolicy::PageList::move_to_back(PageId block_id)
+{
+    auto it = positions.find(block_id);
+
+    if (it == positions.end())
+        return false;
+
+    blocks.splice(blocks.end(), blocks, it->second);
+    return true;
+}
+
+PageId ReplacementPolicy::PageList::pop_front()
+{
+    if (blocks.empty())
+        return INVALID_PAGE_ID;
+
+    PageId block_id = blocks.front();
+    positions.erase(block_id);
+    blocks.pop_front();
+    return block_id;
+}
+
+PageId ReplacementPolicy::PageList::front() const
+{
+    return blocks.empty() ? INVALID_PAGE_ID : blocks.front();
+}
+
+size_t ReplacementPolicy::PageList::size() const
+{
+    return blocks.size();
+}
+
+void LruPolicy::on_load(PageId) {}
+
+void LruPolicy::on_fix(PageId block_id)
+{
+    // fixed blocks cannot be evicted, the next unfix appends the block again
+    unfixed_blocks.remove(block_id);
+}
+
+void LruPolicy::on_unfix(PageId block_id)
+{
+    unfixed_blocks.push_back(block_id);
+}
+
+void LruPolicy::on_erase(PageId block_id)
+{
+    unfixed_blocks.remove(block_id);
+}
+
+PageId LruPolicy::evict(PageId)
+{
+    return unfixed_blocks.pop_front();
+}
+
+void LruPolicy::on_eviction_cancelled(PageId block_id)
+{
+    unfixed_blocks.push_front(block_id);
+}
+
+ClockPolicy::ClockPolicy(int n_frames) : hand(0)
+{
+    frames.reserve(n_frames);
+}
+
+void ClockPolicy::on_load(PageId block_id)
+{
+    size_t position = frames.size();
+
+    if (free_frames.empty())
+        frames.push_back({block_id, true, true});
+    else
+    {
+        position = free_frames.back();
+        free_frames.pop_back();
+        frames[position] = {block_id, true, true};
+    }
+
+    positions[block_id] = position;
+}
+
+void ClockPolicy::on_fix(PageId block_id)
+{
+    Frame& frame = frames[positions.at(block_id)];
+    frame.referenced = true;
+    frame.fixed = true;
+}
+
+void ClockPolicy::on_unfix(PageId block_id)
+{
+    frames[positions.at(block_id)].fixed = false;
+}
+
+void ClockPolicy::on_erase(PageId block_id)
+{
+    auto it = positions.find(block_id);
+
+    if (it == positions.end())
+        return;
+
+    frames[it->second] = {INVALID_PAGE_ID, false, false};
+    free_frames.push_back(it->second);
+    positions.erase(it);
+}
+
+PageId ClockPolicy::evict(PageId)
+{
+    if (frames.empty())
+        return INVALID_PAGE_ID;
+
+    // two rounds: the first may only clear reference bits
+    for (size_t i = 0; i < 2 * frames.size(); i++)
+    {
+        Frame& frame = frames[hand];
+        size_t position = hand;
+        hand = (hand + 1) % frames.size();
+
+        if (frame.block_id == INVALID_PAGE_ID || frame.fixed)
+            continue;
+
+        // second chance
+        if (frame.referenced)
+        {
+            frame.referenced = false;
+            continue;
+        }
+
+        PageId victim = frame.block_id;
+        frame = {INVALID_PAGE_ID, false, false};
+        free_frames.push_back(position);
+        positions.erase(victim);
+        return victim;
+    }
+
+    return INVALID_PAGE_ID;
+}
+
+void ClockPolicy::on_eviction_cancelled(PageId block_id)
+{
+    // the frame that was freed last is the one of the block, unless another eviction came in between
+    size_t position = frames.size();
+
+    if (free_frames.empty())
+        frames.push_back({block_id, false, false});
+    else
+    {
+        position = free_frames.back();
+        free_frames.pop_back();
+        frames[position] = {block_id, false, false};
+    }
+
+    // the hand passed the block when it chose it
+    positions[block_id] = position;
+    hand = position;
+}
+
+TwoQueuePolicy::TwoQueuePolicy(int n_frames)
+    : max_a1in(std::max(1, n_frames / 4)), max_a1out(std::max(1, n_frames / 2)) {}
+
+void TwoQueuePolicy::on_load(PageId block_id)
+{
+    // blocks that are used again after their eviction are hot, they join am with their unfix
+    if (!a1out.remove(block_id))
+        a1in.push_back(block_id);
+
+    fixed.insert(block_id);
+
+    // evictions may still be cancelled, so the oldest remembered ones are forgotten here
+    while (a1out.size() > max_a1out)
+        a1out.pop_front();
+}
+
+void TwoQueuePolicy::on_fix(PageId block_id)
+{
+    // uses in a1in are correlated, e.g. the records of a block. Fixed hot blocks cannot be evicted.
+    am.remove(block_id);
+    fixed.insert(block_id);
+}
+
+void TwoQueuePolicy::on_unfix(PageId block_id)
+{
+    if (fixed.erase(block_id) == 0)
+        return;
+
+    // the block was older than all blocks in a1in
+    if (a1in_fixed.remove(block_id))
+        a1in.push_front(block_id);
+    else if (!a1in.contains(block_id))
+        am.push_back(block_id);
+}
+
+void TwoQueuePolicy::on_erase(PageId block_id)
+{
+    a1in.remove(block_id);
+    a1in_fixed.remove(block_id);
+    am.remove(block_id);
+    fixed.erase(block_id);
+}
+
+PageId TwoQueuePolicy::evict(PageId)
+{
+    // each fixed block at the front is only moved aside once
+    while (fixed.find(a1in.front()) != fixed.end())
+        a1in_fixed.push_back(a1in.pop_front());
+
+    PageId victim = a1in.front();
+
+    // a1in may take its share of the frames, otherwise the least recently used hot block goes
+    if (victim == INVALID_PAGE_ID || a1in.size() + a1in_fixed.size() <= max_a1in)
+    {
+        PageId hot_victim = am.pop_front();
+
+        if (hot_victim != INVALID_PAGE_ID)
+            return hot_victim;
+    }
+
+    if (victim == INVALID_PAGE_ID)
+        return INVALID_PAGE_ID;
+
+    a1in.pop_front();
+    a1out.push_back(victim);
+    return victim;
+}
+
+void TwoQueuePolicy::on_eviction_cancelled(PageId block_id)
+{
+    // only blocks from a1in are remembered
+    if (a1out.remove(block_id))
+        a1in.push_front(block_id);
+    else
+        am.push_front(block_id);
+}
+
+LruKPolicy::LruKPolicy(int n_frames) : n_frames(n_frames), time(0), last_block_id(INVALID_PAGE_ID) {}
+
+void LruKPolicy::on_load(PageId block_id)
+{
+    History history = {{0}, false};
+    auto it = evicted_histories.find(block_id);
+
+    // remembered uses from before the eviction
+    if (it != evicted_histories.end())
+    {
+        history = it->second;
+        evicted_histories.erase(it);
+        evicted_blocks.remove(block_id);
+    }
+
+    history.evictable = false;
+    use(block_id, history);
+    histories[block_id] = history;
+
+    // remember the uses of evicted blocks for as many blocks as there are frames, evictions may still be cancelled
+    while (evicted_blocks.size() > n_frames)
+        evicted_histories.erase(evicted_blocks.pop_front());
+}
+
+void LruKPolicy::on_fix(PageId block_id)
+{
+    History& history = histories.at(block_id);
+
+    if (history.evictable)
+    {
+        evictable_blocks.erase(get_key(block_id, history));
+        history.evictable = false;
+    }
+
+    use(block_id, history);
+}
+
+void LruKPolicy::on_unfix(PageId block_id)
+{
+    History& history = histories.at(block_id);
+    history.evictable = true;
+    evictable_blocks.insert(get_key(block_id, history));
+}
+
+void LruKPolicy::on_erase(PageId block_id)
+{
+    auto it = histories.find(block_id);
+
+    if (it == histories.end())
+        return;
+
+    if (it->second.evictable)
+        evictable_blocks.erase(get_key(block_id, it->second));
+
+    histories.erase(it);
+}
+
+PageId LruKPolicy::evict(PageId)
+{
+    if (evictable_blocks.empty())
+        return INVALID_PAGE_ID;
+
+    PageId victim = std::get<2>(*evictable_blocks.begin());
+    evictable_blocks.erase(evictable_blocks.begin());
+
+    // remember the uses of the block
+    evicted_histories[victim] = histories.at(victim);
+    evicted_blocks.push_back(victim);
+    histories.erase(victim);
+
+    return victim;
+}
+
+void LruKPolicy::on_eviction_cancelled(PageId block_id)
+{
+    // the uses are forgotten if many blocks were evicted in the meantime
+    History history = {{0}, true};
+    auto it = evicted_histories.find(block_id);
+
+    if (it != evicted_histories.end())
+    {
+        history = it->second;
+        evicted_histories.erase(it);
+        evicted_blocks.remove(block_id);
+    }
+
+    history.evictable = true;
+    histories[block_id] = history;
+    evictable_blocks.insert(get_key(block_id, history));
+}
+
+void LruKPolicy::use(PageId block_id, History& history)
+{
+    time++;
+
+    // correlated use, only the last use moves
+    if (block_id == last_block_id && history.uses[0] != 0)
+    {
+        history.uses[0] = time;
+        return;
+    }
+
+    for (int i = K - 1; i > 0; i--)
+        history.uses[i] = history.uses[i - 1];
+
+    history.uses[0] = time;
+    last_block_id = block_id;
+}
+
+std::tuple<uint64_t, uint64_t, PageId> LruKPolicy::get_key(PageId block_id, History const& history)
+{
+    return {history.uses[K - 1], history.uses[0], block_id};
+}
+
+ArcPolicy::ArcPolicy(int n_frames) : n_fixed_t1(0), n_frames(n_frames), target(0), last_block_id(INVALID_PAGE_ID) {}
+
+void ArcPolicy::on_load(PageId block_id)
+{
+    // a remembered block would have stayed with a larger t1 (b1) or t2 (b2)
+    bool in_t2 = true;
+
+    if (b1.remove(block_id))
+        target = std::min(n_frames, target + std::max<size_t>(1, b2.size() / std::max<size_t>(1, b1.size())));
+    else if (b2.remove(block_id))
+    {
+        size_t step = std::max<size_t>(1, b1.size() / std::max<size_t>(1, b2.size()));
+        target = target > step ? target - step : 0;
+    } else
+        in_t2 = false;
+
+    fixed[block_id] = in_t2;
+
+    if (!in_t2)
+        n_fixed_t1++;
+
+    // at most n_frames blocks in t1 and b1, and 2 * n_frames in all lists
+    if (get_t1_size() + b1.size() > n_frames)
+        b1.pop_front();
+
+    if (get_t1_size() + get_t2_size() + b1.size() + b2.size() > 2 * n_frames)
+        b2.pop_front();
+
+    last_block_id = block_id;
+}
+
+void ArcPolicy::on_fix(PageId block_id)
+{
+    // fixed blocks cannot be evicted, the next unfix appends the block again. A second use that is not
+    // correlated moves the block to t2.
+    if (t1.remove(block_id))
+    {
+        bool in_t2 = block_id != last_block_id;
+        fixed[block_id] = in_t2;
+
+        if (!in_t2)
+            n_fixed_t1++;
+    } else if (t2.remove(block_id))
+        fixed[block_id] = true;
+
+    last_block_id = block_id;
+}
+
+void ArcPolicy::on_unfix(PageId block_id)
+{
+    auto it = fixed.find(block_id);
+
+    if (it == fixed.end())
+        return;
+
+    if (it->second)
+        t2.push_back(block_id);
+    else
+    {
+        t1.push_back(block_id);
+        n_fixed_t1--;
+    }
+
+    fixed.erase(it);
+}
+
+void ArcPolicy::on_erase(PageId block_id)
+{
+    t1.remove(block_id);
+    t2.remove(block_id);
+
+    auto it = fixed.find(block_id);
+
+    if (it == fixed.end())
+        return;
+
+    if (!it->second)
+        n_fixed_t1--;
+
+    fixed.erase(it);
+}
+
+PageId ArcPolicy::evict(PageId block_id)
+{
+    // t1 gives up a block if it is larger than its target
+    size_t t1_size = get_t1_size();
+    bool from_t1 = t1.size() > 0 &&
+                   (t2.size() == 0 || t1_size > target || (b2.contains(block_id) && t1_size == target));
+
+    if (from_t1)
+    {
+        PageId victim = t1.pop_front();
+        b1.push_back(victim);
+        return victim;
+    }
+
+    PageId victim = t2.pop_front();
+
+    if (victim != INVALID_PAGE_ID)
+        b2.push_back(victim);
+
+    return victim;
+}
+
+void ArcPolicy::on_eviction_cancelled(PageId block_id)
+{
+    // the target only changes when a remembered block is loaded. Loads in the meantime may have forgotten the block.
+    if (b2.remove(block_id))
+        t2.push_front(block_id);
+    else
+    {
+        b1.remove(block_id);
+        t1.push_front(block_id);
+    }
+}
+
+size_t ArcPolicy::get_t1_size()
+{
+    return t1.size() + n_fixed_t1;
+}
+
+size_t ArcPolicy::get_t2_size()
+{
+    return t2.size() + fixed.size() - n_fixed_t1;
+}
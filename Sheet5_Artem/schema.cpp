@@ -0,0 +1,257 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <variant>
+#include <stdexcept>
+
+#include "header/identifiers.h"
+#include "header/record.h"
+#include "header/schema.h"
+
+Schema::Schema(std::vector<std::string> const& attribute_types)
+    : attribute_types(attribute_types), fixed_size(0)
+{
+    if (attribute_types.empty())
+        throw std::invalid_argument("Cannot create schema without attributes.");
+
+    // lay out the fixed-width part in attribute order
+    for (std::string const& attribute_type : attribute_types)
+    {
+        types.push_back(parse_type(attribute_type));
+        offsets.push_back(fixed_size);
+        fixed_size += get_width(types.back());
+    }
+}
+
+int Schema::get_attribute_count() const
+{
+    return types.size();
+}
+
+std::vector<std::string> const& Schema::get_attribute_types() const
+{
+    return attribute_types;
+}
+
+std::vector<Schema::Type> const& Schema::get_types() const
+{
+    return types;
+}
+
+Schema::Type Schema::get_type(int position) const
+{
+    return types.at(position - 1);
+}
+
+int Schema::get_fixed_size() const
+{
+    return fixed_size;
+}
+
+int Schema::get_encoded_size(std::vector<Record::Attribute> const& attributes) const
+{
+    if (attributes.size() != types.size())
+        throw std::invalid_argument("Cannot encode tuple with " + std::to_string(attributes.size()) + " attributes for schema with " + std::to_string(types.size()));
+
+    int size = fixed_size;
+
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        Record::Attribute const& attribute = attributes.at(i);
+
+        if ((types.at(i) == Type::INTEGER && !std::holds_alternative<int>(attribute)) ||
+            (types.at(i) == Type::STRING && !std::holds_alternative<std::string>(attribute)) ||
+            (types.at(i) == Type::BOOLEAN && !std::holds_alternative<bool>(attribute)) ||
+            (types.at(i) == Type::ID && !std::holds_alternative<uint64_t>(attribute)))
+            throw std::invalid_argument("Cannot encode tuple with wrong type of attribute " + std::to_string(i + 1));
+
+        if (types.at(i) == Type::STRING)
+            size += std::get<std::string>(attribute).size();
+    }
+
+    // string offsets are stored with 16 bits
+    if (size > UINT16_MAX)
+        throw std::invalid_argument("Cannot encode tuple of " + std::to_string(size) + " bytes");
+
+    return size;
+}
+
+void Schema::encode(void* destination, std::vector<Record::Attribute> const& attributes) const
+{
+    char* buffer = static_cast<char*>(destination);
+    int string_offset = fixed_size;
+
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        char* field = buffer + offsets.at(i);
+
+        if (types.at(i) == Type::INTEGER)
+        {
+            int value = std::get<int>(attributes.at(i));
+            std::memcpy(field, &value, sizeof(int));
+        } else if (types.at(i) == Type::BOOLEAN)
+        {
+            *field = std::get<bool>(attributes.at(i));
+        } else if (types.at(i) == Type::ID)
+        {
+            uint64_t value = std::get<uint64_t>(attributes.at(i));
+            std::memcpy(field, &value, sizeof(uint64_t));
+        } else
+        {
+            // strings follow the fixed-width part
+            std::string const& value = std::get<std::string>(attributes.at(i));
+            StringEntry entry = {(uint16_t) string_offset, (uint16_t) value.size()};
+            std::memcpy(field, &entry, sizeof(StringEntry));
+            std::memcpy(buffer + string_offset, value.data(), value.size());
+            string_offset += value.size();
+        }
+    }
+}
+
+std::vector<Record::Attribute> Schema::decode(void const* data) const
+{
+    std::vector<Record::Attribute> attributes;
+
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        if (types.at(i) == Type::INTEGER)
+            attributes.push_back(get_integer_attribute(data, i + 1));
+        else if (types.at(i) == Type::BOOLEAN)
+            attributes.push_back(get_boolean_attribute(data, i + 1));
+        else if (types.at(i) == Type::ID)
+            attributes.push_back(get_id_attribute(data, i + 1));
+        else
+            attributes.push_back(std::string(get_string_attribute(data, i + 1)));
+    }
+
+    return attributes;
+}
+
+int Schema::get_integer_attribute(void const* data, int position) const
+{
+    int value;
+    std::memcpy(&value, static_cast<char const*>(data) + offsets.at(position - 1), sizeof(int));
+    return value;
+}
+
+std::string_view Schema::get_string_attribute(void const* data, int position) const
+{
+    StringEntry entry;
+    std::memcpy(&entry, static_cast<char const*>(data) + offsets.at(position - 1), sizeof(StringEntry));
+    return std::string_view(static_cast<char const*>(data) + entry.offset, entry.length);
+}
+
+bool Schema::get_boolean_attribute(void const* data, int position) const
+{
+    return static_cast<char const*>(data)[offsets.at(position - 1)] != 0;
+}
+
+uint64_t Schema::get_id_attribute(void const* data, int position) const
+{
+    uint64_t value;
+    std::memcpy(&value, static_cast<char const*>(data) + offsets.at(position - 1), sizeof(uint64_t));
+    return value;
+}
+
+std::string_view Schema::get_attribute_bytes(void const* data, int position) const
+{
+    if (types.at(position - 1) == Type::STRING)
+        return get_string_attribute(data, position);
+
+    return std::string_view(static_cast<char const*>(data) + offsets.at(position - 1), get_width(types.at(position - 1)));
+}
+
+Schema::Type Schema::parse_type(std::string const& attribute_type)
+{
+    if (attribute_type == "int")
+        return Type::INTEGER;
+    else if (attribute_type == "string")
+        return Type::STRING;
+    else if (attribute_type == "bool")
+        return Type::BOOLEAN;
+    else if (attribute_type == "id")
+        return Type::ID;
+
+    throw std::invalid_argument("Unknown attribute type: " + attribute_type);
+}
+
+std::vector<Schema::Type> Schema::parse_types(std::vector<std::string> const& attribute_types)
+{
+    std::vector<Type> types;
+
+    for (std::string const& attribute_type : attribute_types)
+        types.push_back(parse_type(attribute_type));
+
+    return types;
+}
+
+int Schema::get_width(Type type)
+{
+    if (type == Type::INTEGER)
+        return sizeof(int);
+    else if (type == Type::STRING)
+        return sizeof(StringEntry);
+    else if (type == Type::ID)
+        return sizeof(uint64_t);
+
+    return sizeof(bool);
+}
+
+TupleView::TupleView(Schema const& schema, void const* data, int size, RecordId record_id)
+    : schema(&schema), data(static_cast<char const*>(data)), size(size), record_id(record_id) {}
+
+RecordId TupleView::get_record_id() const
+{
+    return record_id;
+}
+
+std::string_view TupleView::get_string_attribute(int attribute_index) const
+{
+    return schema->get_string_attribute(data, attribute_index);
+}
+
+int TupleView::get_integer_attribute(int attribute_index) const
+{
+    return schema->get_integer_attribute(data, attribute_index);
+}
+
+bool TupleView::get_boolean_attribute(int attribute_index) const
+{
+    return schema->get_boolean_attribute(data, attribute_index);
+}
+
+uint64_t TupleView::get_id_attribute(int attribute_index) const
+{
+    // the record id is not stored in the tuple
+    if (attribute_index == 0)
+        return record_id;
+
+    return schema->get_id_attribute(data, attribute_index);
+}
+
+std::string_view TupleView::get_attribute_bytes(int attribute_index) const
+{
+    return schema->get_attribute_bytes(data, attribute_index);
+}
+
+int TupleView::get_attribute_count() const
+{
+    return schema->get_attribute_count();
+}
+
+void const* TupleView::get_data() const
+{
+    return data;
+}
+
+int TupleView::get_size() const
+{
+    return size;
+}
+
+std::shared_ptr<Record> TupleView::materialize() const
+{
+    return std::make_shared<Record>(Record(record_id, schema->decode(data)));
+}
@@ -0,0 +1,559 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <new>
+#include <cstdlib>
+#include <cerrno>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "header/filesystem.h"
+#include "header/storage_manager.h"
+
+std::string const StorageManager::SEGMENT_PREFIX = "segment_";
+std::string const StorageManager::GEOMETRY_FILE = "geometry";
+
+StorageManager::StorageManager(std::string const& directory, int page_size)
+    : StorageManager(directory, page_size, Mode::BUFFERED) {}
+
+StorageManager::StorageManager(std::string const& directory, int page_size, Mode mode)
+    : directory(directory), page_size(page_size), mode(mode)
+{
+    // page sizes are powers of two, slot offsets and lengths of larger pages would not fit their fields
+    if (page_size < MIN_PAGE_SIZE || page_size > MAX_PAGE_SIZE || (page_size & (page_size - 1)) != 0)
+        throw std::invalid_argument("Invalid page size: " + std::to_string(page_size));
+
+    // the geometry of an existing database cannot be changed
+    int stored_page_size = read_page_size(directory);
+
+    if (stored_page_size != 0 && stored_page_size != page_size)
+        throw std::invalid_argument("Database in " + directory + " uses page size " + std::to_string(stored_page_size));
+
+    // read-only databases are never created
+    if (mode == Mode::MAPPED)
+    {
+        if (stored_page_size == 0)
+            throw std::invalid_argument("Cannot map missing database in " + directory);
+
+        return;
+    }
+
+    // Create storage directory (if needed)
+    if (!std::filesystem::exists(directory)) {
+        if (!std::filesystem::create_directories(directory)) {
+            std::cerr << "Failed to create storage directory." << std::endl;
+        }
+    }
+
+    // remember the page size of a new database
+    if (stored_page_size == 0)
+    {
+        std::ofstream file(directory + GEOMETRY_FILE);
+        file << page_size << std::endl;
+
+        if (!file)
+            std::cerr << "Failed to store the page size." << std::endl;
+    }
+}
+
+StorageManager::StorageManager(std::string const& directory)
+    : StorageManager(directory, Mode::BUFFERED) {}
+
+StorageManager::StorageManager(std::string const& directory, Mode mode)
+    : StorageManager(directory, read_page_size(directory) != 0 ? read_page_size(directory) : DEFAULT_PAGE_SIZE, mode) {}
+
+StorageManager::~StorageManager()
+{
+    // running requests use the segment files
+    wait_all_pages();
+
+    for (Mapping const& mapping : mappings)
+    {
+        if (mapping.address != nullptr)
+            munmap(mapping.address, mapping.size);
+    }
+
+    for (int fd : segments)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool StorageManager::read_page(uint64_t page_number, void* buffer)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finish_page(page_number);
+    }
+
+    if (mode == Mode::MAPPED)
+    {
+        void const* page = get_mapped_page(page_number);
+
+        if (page == nullptr)
+            return false;
+
+        std::memcpy(buffer, page, page_size);
+        return true;
+    }
+
+    int fd = get_segment(page_number, false);
+
+    if (fd < 0)
+        return false;
+
+    off_t offset = (off_t) (page_number % SEGMENT_PAGES) * page_size;
+
+    // direct I/O needs aligned memory, read unaligned pages through an aligned copy
+    if (mode == Mode::DIRECT && !is_aligned(buffer))
+    {
+        std::shared_ptr<void> aligned = allocate_page();
+
+        if (!read_page(page_number, aligned.get()))
+            return false;
+
+        std::memcpy(buffer, aligned.get(), page_size);
+        return true;
+    }
+
+    ssize_t n_read = pread(fd, buffer, page_size, offset);
+
+    // Pages behind the end of the segment file were never written
+    if (n_read == 0)
+        return false;
+
+    // a failed or partial read must not look like a missing page, the page would be overwritten with an empty one
+    if (n_read != page_size)
+        throw std::runtime_error("Cannot read page: " + std::to_string(page_number));
+
+    // Pages that were erased (or skipped) are zero-filled holes
+    return static_cast<char*>(buffer)[0] != 0;
+}
+
+bool StorageManager::write_page(uint64_t page_number, void const* buffer)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finish_page(page_number);
+    }
+
+    if (mode == Mode::MAPPED)
+        return false;
+
+    int fd = get_segment(page_number, true);
+
+    if (fd < 0)
+        return false;
+
+    off_t offset = (off_t) (page_number % SEGMENT_PAGES) * page_size;
+
+    // direct I/O needs aligned memory, write unaligned pages through an aligned copy
+    if (mode == Mode::DIRECT && !is_aligned(buffer))
+    {
+        std::shared_ptr<void> aligned = allocate_page();
+        std::memcpy(aligned.get(), buffer, page_size);
+        return pwrite(fd, aligned.get(), page_size, offset) == page_size;
+    }
+
+    return pwrite(fd, buffer, page_size, offset) == page_size;
+}
+
+bool StorageManager::write_pages(uint64_t page_number, std::vector<void const*> const& buffers)
+{
+    if (mode == Mode::MAPPED)
+        return false;
+
+    size_t first = 0;
+
+    while (first < buffers.size())
+    {
+        // a run ends at the end of its segment
+        uint64_t first_page = page_number + first;
+        size_t n_pages = std::min({buffers.size() - first, (size_t) (SEGMENT_PAGES - first_page % SEGMENT_PAGES),
+                                   (size_t) MAX_WRITE_PAGES});
+
+        std::vector<iovec> vectors(n_pages);
+        bool aligned = true;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (size_t i = 0; i < n_pages; i++)
+            {
+                finish_page(first_page + i);
+                vectors[i] = {const_cast<void*>(buffers[first + i]), (size_t) page_size};
+                aligned = aligned && is_aligned(buffers[first + i]);
+            }
+        }
+
+        // direct I/O writes unaligned pages one by one through an aligned copy
+        if (mode == Mode::DIRECT && !aligned)
+        {
+            for (size_t i = 0; i < n_pages; i++)
+            {
+                if (!write_page(first_page + i, buffers[first + i]))
+                    return false;
+            }
+        } else
+        {
+            int fd = get_segment(first_page, true);
+
+            if (fd < 0)
+                return false;
+
+            off_t offset = (off_t) (first_page % SEGMENT_PAGES) * page_size;
+
+            if (pwritev(fd, vectors.data(), n_pages, offset) != (ssize_t) (n_pages * page_size))
+                return false;
+        }
+
+        first += n_pages;
+    }
+
+    return true;
+}
+
+bool StorageManager::page_exists(uint64_t page_number)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finish_page(page_number);
+    }
+
+    if (mode == Mode::MAPPED)
+        return get_mapped_page(page_number) != nullptr;
+
+    int fd = get_segment(page_number, false);
+
+    if (fd < 0)
+        return false;
+
+    off_t offset = (off_t) (page_number % SEGMENT_PAGES) * page_size;
+
+    // direct I/O can only read whole aligned pages
+    if (mode == Mode::DIRECT)
+    {
+        std::shared_ptr<void> page = allocate_page();
+        return pread(fd, page.get(), page_size, offset) == page_size && static_cast<char*>(page.get())[0] != 0;
+    }
+
+    // Valid pages never start with a zero byte
+    char first_byte = 0;
+
+    return pread(fd, &first_byte, 1, offset) == 1 && first_byte != 0;
+}
+
+bool StorageManager::erase_page(uint64_t page_number)
+{
+    if (!page_exists(page_number))
+        return false;
+
+    // overwrite the page with zeros, which marks it as non-existing
+    std::shared_ptr<void> zeros = allocate_page();
+    std::memset(zeros.get(), 0, page_size);
+    return write_page(page_number, zeros.get());
+}
+
+bool StorageManager::read_page_async(uint64_t page_number, std::shared_ptr<void> const& buffer)
+{
+    return queue_page(page_number, buffer, false);
+}
+
+bool StorageManager::write_page_async(uint64_t page_number, std::shared_ptr<void> const& buffer)
+{
+    return queue_page(page_number, buffer, true);
+}
+
+void StorageManager::submit_pages()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (async_io)
+        async_io->submit();
+}
+
+bool StorageManager::wait_page(uint64_t page_number)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return take_result(page_number);
+}
+
+void StorageManager::cancel_page(uint64_t page_number)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    finish_page(page_number);
+    results.erase(page_number);
+}
+
+bool StorageManager::take_result(uint64_t page_number)
+{
+    finish_page(page_number);
+
+    // pages without a result were written successfully (or not requested at all)
+    auto it = results.find(page_number);
+
+    if (it == results.end())
+        return true;
+
+    Result result = it->second;
+    results.erase(it);
+
+    // same as read_page
+    if (result == Result::READ_FAILED)
+        throw std::runtime_error("Cannot read page: " + std::to_string(page_number));
+
+    return result == Result::EXISTS;
+}
+
+bool StorageManager::is_async_io()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!async_io)
+        async_io = std::make_unique<AsyncIo>(ASYNC_QUEUE_DEPTH);
+
+    return async_io->is_available();
+}
+
+bool StorageManager::sync()
+{
+    std::vector<int> fds;
+
+    // only finished writes are made durable
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wait_all_pages();
+        fds = segments;
+    }
+
+    bool success = true;
+
+    for (int fd : fds)
+    {
+        if (fd >= 0 && fsync(fd) != 0)
+            success = false;
+    }
+
+    return success;
+}
+
+int StorageManager::get_page_size()
+{
+    return page_size;
+}
+
+StorageManager::Mode StorageManager::get_mode()
+{
+    return mode;
+}
+
+bool StorageManager::is_direct_io()
+{
+    return mode == Mode::DIRECT;
+}
+
+bool StorageManager::is_read_only()
+{
+    return mode == Mode::MAPPED;
+}
+
+void const* StorageManager::get_mapped_page(uint64_t page_number)
+{
+    if (mode != Mode::MAPPED)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t segment = page_number / SEGMENT_PAGES;
+
+    // map the whole segment file on first use
+    if (segment >= mappings.size() || mappings.at(segment).address == nullptr)
+    {
+        int fd = open_segment(page_number, false);
+        struct stat file_stat;
+
+        if (fd < 0 || fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+            return nullptr;
+
+        void* address = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (address == MAP_FAILED)
+            return nullptr;
+
+        if (segment >= mappings.size())
+            mappings.resize(segment + 1, {nullptr, 0});
+
+        mappings.at(segment) = {static_cast<char*>(address), (size_t) file_stat.st_size};
+    }
+
+    Mapping const& mapping = mappings.at(segment);
+    size_t offset = (page_number % SEGMENT_PAGES) * page_size;
+
+    // pages behind the end of the file or erased pages do not exist
+    if (offset + page_size > mapping.size || mapping.address[offset] == 0)
+        return nullptr;
+
+    return mapping.address + offset;
+}
+
+std::shared_ptr<void> StorageManager::allocate_page()
+{
+    void* buffer = nullptr;
+
+    if (posix_memalign(&buffer, PAGE_ALIGNMENT, page_size) != 0)
+        throw std::bad_alloc();
+
+    return std::shared_ptr<void>(buffer, std::free);
+}
+
+bool StorageManager::is_aligned(void const* buffer)
+{
+    return reinterpret_cast<uintptr_t>(buffer) % PAGE_ALIGNMENT == 0;
+}
+
+bool StorageManager::queue_page(uint64_t page_number, std::shared_ptr<void> const& buffer, bool write)
+{
+    // mapped pages are copied right away
+    if (mode == Mode::MAPPED)
+    {
+        if (write)
+            return false;
+
+        bool exists = read_page(page_number, buffer.get());
+        std::lock_guard<std::mutex> lock(mutex);
+        results[page_number] = exists ? Result::EXISTS : Result::MISSING;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // requests of the same page are executed in order
+    finish_page(page_number);
+    results.erase(page_number);
+
+    int fd = open_segment(page_number, write);
+
+    if (fd < 0)
+    {
+        // reading a page of a missing segment finishes immediately
+        if (!write)
+            results[page_number] = Result::MISSING;
+
+        return !write;
+    }
+
+    // direct I/O needs aligned memory
+    if (mode == Mode::DIRECT && !is_aligned(buffer.get()))
+        return false;
+
+    if (!async_io)
+        async_io = std::make_unique<AsyncIo>(ASYNC_QUEUE_DEPTH);
+
+    uint64_t offset = (page_number % SEGMENT_PAGES) * page_size;
+    bool queued = write ? async_io->queue_write(fd, buffer.get(), page_size, offset, page_number)
+                        : async_io->queue_read(fd, buffer.get(), page_size, offset, page_number);
+
+    if (!queued)
+        return false;
+
+    requests[page_number] = {buffer, write};
+    return true;
+}
+
+void StorageManager::finish_request(AsyncIo::Completion const& completion)
+{
+    auto it = requests.find(completion.tag);
+
+    if (it == requests.end())
+        return;
+
+    bool success = completion.result == page_size;
+
+    // same as read_page, pages behind the end of the file were never written and erased pages are zero.
+    // Failed writes are reported to the next wait for the page.
+    if (!it->second.write && completion.result == 0)
+        results[completion.tag] = Result::MISSING;
+    else if (!it->second.write && success)
+        results[completion.tag] = static_cast<char*>(it->second.buffer.get())[0] != 0 ? Result::EXISTS : Result::MISSING;
+    else if (!success)
+        results[completion.tag] = it->second.write ? Result::WRITE_FAILED : Result::READ_FAILED;
+
+    requests.erase(it);
+}
+
+void StorageManager::finish_page(uint64_t page_number)
+{
+    while (requests.find(page_number) != requests.end())
+    {
+        for (AsyncIo::Completion const& completion : async_io->wait(1))
+            finish_request(completion);
+    }
+}
+
+void StorageManager::wait_all_pages()
+{
+    while (!requests.empty())
+    {
+        for (AsyncIo::Completion const& completion : async_io->wait(1))
+            finish_request(completion);
+    }
+}
+
+int StorageManager::read_page_size(std::string const& directory)
+{
+    std::ifstream file(directory + GEOMETRY_FILE);
+    int page_size = 0;
+
+    if (!(file >> page_size))
+        return 0;
+
+    return page_size;
+}
+
+int StorageManager::get_segment(uint64_t page_number, bool create)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return open_segment(page_number, create);
+}
+
+int StorageManager::open_segment(uint64_t page_number, bool create)
+{
+    uint64_t segment = page_number / SEGMENT_PAGES;
+
+    if (segment < segments.size() && segments.at(segment) >= 0)
+        return segments.at(segment);
+
+    std::string path = directory + SEGMENT_PREFIX + std::to_string(segment);
+
+    // only create segment files when writing
+    int flags = create ? O_RDWR | O_CREAT : O_RDWR;
+
+    if (mode == Mode::DIRECT)
+        flags |= O_DIRECT;
+    else if (mode == Mode::MAPPED)
+        flags = O_RDONLY;
+
+    int fd = open(path.c_str(), flags, 0644);
+
+    // some file systems (e.g. tmpfs) do not support direct I/O
+    if (fd < 0 && mode == Mode::DIRECT && errno == EINVAL)
+        throw std::runtime_error("Direct I/O is not supported for " + path);
+
+    if (fd < 0)
+        return -1;
+
+    if (segment >= segments.size())
+        segments.resize(segment + 1, -1);
+
+    segments.at(segment) = fd;
+    return fd;
+}